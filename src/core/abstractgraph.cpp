@@ -14,19 +14,100 @@
  * limitations under the License.
  */
 
+#include <QDataStream>
+#include <algorithm>
+#include <unordered_set>
+
 #include "abstractgraph.h"
 #include "constants.h"
 #include "edge_p.h"
 #include "node_p.h"
+#include "topology_p.h"
 #include "trial.h"
 #include "utils.h"
 
 namespace evoplex {
 
+namespace {
+
+void writeValues(QDataStream& out, const Values& values)
+{
+    out << static_cast<quint32>(values.size());
+    for (const Value& v : values) {
+        out << v;
+    }
+}
+
+Values readValues(QDataStream& in)
+{
+    quint32 size;
+    in >> size;
+    Values values;
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        Value v;
+        in >> v;
+        values.emplace_back(v);
+    }
+    return values;
+}
+
+void writeNames(QDataStream& out, const std::vector<QString>& names)
+{
+    out << static_cast<quint32>(names.size());
+    for (const QString& name : names) {
+        out << name;
+    }
+}
+
+// builds a container with the names and the default values of a schema
+Attributes readSchema(QDataStream& in)
+{
+    quint32 size;
+    in >> size;
+    Attributes attrs;
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        in >> name;
+        attrs.push_back(name, Value());
+    }
+    return attrs;
+}
+
+// fills a copy of 'sample' with the values read from the stream
+Attributes readAttrs(QDataStream& in, const Attributes& sample)
+{
+    const Values values = readValues(in);
+    if (values.size() != static_cast<size_t>(sample.size())) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return Attributes();
+    }
+    Attributes attrs(sample.schema());
+    for (int i = 0; i < sample.size(); ++i) {
+        attrs.setValue(i, values[static_cast<size_t>(i)]);
+    }
+    return attrs;
+}
+
+} // namespace
+
 AbstractGraph::AbstractGraph()
     : m_lastNodeId(-1),
-      m_lastEdgeId(-1)
+      m_lastEdgeId(-1),
+      m_nodeAttrs(std::make_shared<AttributesTable>()),
+      m_edgeArena(new EdgeArena()),
+      m_adjDirty(true),
+      m_revision(0),
+      m_outAdj(std::make_shared<Adjacency>()),
+      m_inAdj(m_outAdj),
+      m_pairsIndexed(false),
+      m_edgesPending(false)
+{
+}
+
+AbstractGraph::~AbstractGraph()
 {
+    // the nodes may outlive the graph, but the edges' records may not
+    removeAllEdges();
 }
 
 bool AbstractGraph::setup(Trial& trial, AttrsGeneratorPtr edgeGen,
@@ -35,12 +116,181 @@ bool AbstractGraph::setup(Trial& trial, AttrsGeneratorPtr edgeGen,
     Q_ASSERT_X(nodes.size() < EVOPLEX_MAX_NODES, "setup", "too many nodes!");
     Q_ASSERT_X(!nodes.empty(), "setup", "set of nodes cannot be empty!");
     m_nodes = nodes;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, numNodes()-1);
-    m_lastNodeId = static_cast<int>(m_nodes.size());
+    m_lastNodeId = -1;
+    for (auto const& np : m_nodes) {
+        m_lastNodeId = std::max(m_lastNodeId, np.first);
+    }
+
+    // nodes cloned from a cached population are already stored in a
+    // copy-on-write table of their own, which is taken as it is
+    std::shared_ptr<AttributesTable> table = m_nodes.cbegin()->second.m_ptr->m_table;
+    if (table && table->size() == m_nodes.size() &&
+            std::all_of(m_nodes.cbegin(), m_nodes.cend(),
+                        [&table](const std::pair<const int, Node>& np) {
+                            return np.second.m_ptr->m_table == table; })) {
+        m_nodeAttrs = table;
+    } else {
+        // move the nodes' attributes into columns
+        m_nodeAttrs = std::make_shared<AttributesTable>(m_nodes.cbegin()->second.attrs());
+        m_nodeAttrs->reserve(static_cast<size_t>(m_lastNodeId + 1));
+        for (auto const& np : m_nodes) {
+            bindNodeAttrs(np.second);
+        }
+    }
     m_edgeAttrsGen = std::move(edgeGen);
+    invalidateAdjacency();
     return AbstractPlugin::setup(trial, attrs);
 }
 
+void AbstractGraph::bindNodeAttrs(const Node& node)
+{
+    BaseNode* n = node.m_ptr.get();
+    n->unbind(); // no-op for standalone nodes
+    if (m_nodeAttrs->numColumns() == 0 && m_nodeAttrs->size() == 0) {
+        // no schema yet; takes it from the first node
+        m_nodeAttrs = std::make_shared<AttributesTable>(n->m_attrs);
+    }
+    // nodes with a different set of attributes keep their own
+    if (m_nodeAttrs->matches(n->m_attrs)) {
+        n->bindTo(m_nodeAttrs);
+    }
+}
+
+void AbstractGraph::updateAdjacency() const
+{
+    if (!m_adjDirty) {
+        return; // e.g., the snapshots of an adopted topology
+    }
+    ensureEdges(); // the snapshots are built from the nodes' edges
+    QMutexLocker locker(&m_adjMutex);
+    if (!m_adjDirty) {
+        return; // another thread has just rebuilt it
+    }
+    // never modify the current snapshots in place; they may be shared
+    auto outAdj = std::make_shared<Adjacency>();
+    outAdj->build(m_nodes, true);
+    m_outAdj = outAdj;
+    if (isDirected()) {
+        auto inAdj = std::make_shared<Adjacency>();
+        inAdj->build(m_nodes, false);
+        m_inAdj = inAdj;
+    } else {
+        m_inAdj = m_outAdj;
+    }
+    m_adjDirty = false;
+}
+
+TopologyPtr AbstractGraph::shareTopology() const
+{
+    if (m_lattice) {
+        return nullptr; // it is cheaper to build the lattice again
+    }
+    if (m_edgesPending) {
+        return m_topology; // it has not changed since it was adopted
+    }
+    outAdjacency(); // makes sure the snapshots are up to date
+
+    // sorted by id, so the other graphs create the edges in the same order
+    std::vector<const BaseEdge*> records;
+    records.reserve(m_edges.size());
+    for (auto const& p : m_edges) {
+        records.emplace_back(p.second.m_ptr);
+    }
+    std::sort(records.begin(), records.end(),
+              [](const BaseEdge* a, const BaseEdge* b) { return a->id() < b->id(); });
+
+    std::vector<Topology::EdgeEntry> entries;
+    std::vector<Attributes> attrs;
+    entries.reserve(records.size());
+    attrs.reserve(records.size());
+    for (const BaseEdge* e : records) {
+        entries.push_back({e->id(), e->origin().id(), e->neighbour().id()});
+        attrs.emplace_back(e->m_attrs);
+    }
+
+    QMutexLocker locker(&m_adjMutex);
+    return std::make_shared<const Topology>(std::move(entries), std::move(attrs),
+            m_outAdj, m_inAdj, numNodes(), m_lastEdgeId);
+}
+
+bool AbstractGraph::adoptTopology(TopologyPtr topology)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!topology || !m_edges.empty() || numNodes() != topology->numNodes() ||
+            m_lastNodeId + 1 != topology->outAdjacency()->numSlots()) {
+        return false;
+    }
+
+    m_lastEdgeId = topology->lastEdgeId();
+    {
+        QMutexLocker adjLocker(&m_adjMutex);
+        m_outAdj = topology->outAdjacency();
+        m_inAdj = topology->inAdjacency();
+        m_adjDirty = false;
+    }
+
+    // the nodes will ask for their edges when they need them
+    for (auto const& np : m_nodes) {
+        np.second.m_ptr->m_lazyGraph = this;
+    }
+    m_topology = std::move(topology);
+    m_edgesPending = true;
+    return true;
+}
+
+void AbstractGraph::createPendingEdges()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_edgesPending) {
+        return; // another thread has just created them
+    }
+
+    if (m_topology) {
+        const auto& entries = m_topology->edges();
+        const auto& attrs = m_topology->edgeAttrs();
+        m_edgeArena->reserve(entries.size());
+        m_edges.reserve(static_cast<size_t>(m_lastEdgeId + 1));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Topology::EdgeEntry& e = entries[i];
+            insertEdge(e.id, m_nodes.at(e.originId), m_nodes.at(e.neighbourId),
+                       attrs.empty() ? Attributes() : attrs[i]);
+        }
+    } else {
+        const int numEdges = m_lattice->numEdges();
+        m_edgeArena->reserve(static_cast<size_t>(numEdges));
+        m_edges.reserve(static_cast<size_t>(m_lastEdgeId + 1 + numEdges));
+        m_lattice->forEachEdge([this](int originId, int neighbourId) {
+            ++m_lastEdgeId;
+            insertEdge(m_lastEdgeId, m_nodes.at(originId), m_nodes.at(neighbourId), Attributes());
+        });
+    }
+
+    for (auto const& np : m_nodes) {
+        np.second.m_ptr->m_lazyGraph = nullptr;
+    }
+    // the CSR snapshots (or the lattice) are still valid; they are kept
+    // until the next change in the topology
+    m_topology.reset();
+    m_edgesPending = false;
+}
+
+bool AbstractGraph::setLattice(const Lattice& lattice)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_edges.empty() || m_edgesPending || numNodes() != lattice.numNodes() ||
+            m_lastNodeId + 1 != lattice.numNodes() || isDirected() != lattice.isDirected()) {
+        return false;
+    }
+
+    // the nodes will ask for their edges when they need them
+    for (auto const& np : m_nodes) {
+        np.second.m_ptr->m_lazyGraph = this;
+    }
+    m_lattice.reset(new Lattice(lattice));
+    m_edgesPending = true;
+    return true;
+}
+
 const QString& AbstractGraph::id() const
 {
     return m_trial->graphId();
@@ -56,11 +306,63 @@ Node AbstractGraph::randNode() const
     if (m_nodes.empty()) {
         return Node();
     }
-    return std::next(m_nodes.cbegin(), prg()->uniform(m_numNodesDist))->second;
+    // the trial keeps the tombstones below one half, i.e., two draws on average
+    return m_nodes.randElement([this](size_t n) { return prg()->uniform(static_cast<int>(n)); }).second;
+}
+
+// the control block allocated along with the object by std::make_shared
+static constexpr size_t kSharedPtrOverhead = 2 * sizeof(void*);
+
+size_t AbstractGraph::nodesMemoryUsage() const
+{
+    const size_t nodeSize = kSharedPtrOverhead + (isDirected() ? sizeof(DNode) : sizeof(UNode));
+    size_t bytes = m_nodes.numSlots() * sizeof(std::pair<const int, Node>);
+    for (auto const& p : m_nodes) {
+        const BaseNode* node = p.second.m_ptr.get();
+        // the unbound attributes may hold their own schema
+        bytes += nodeSize + node->m_attrs.memoryUsage() - sizeof(Attributes);
+        if (!node->m_table && node->m_attrs.schema() != m_nodeAttrs->schema()) {
+            bytes += node->m_attrs.schema() ? node->m_attrs.schema()->memoryUsage() : 0;
+        }
+    }
+    return bytes + m_nodeAttrs->memoryUsage();
+}
+
+size_t AbstractGraph::edgesMemoryUsage() const
+{
+    if (m_edgesPending) {
+        return m_topology ? m_topology->memoryUsage() : sizeof(Lattice);
+    }
+
+    const size_t slotSize = sizeof(std::pair<const int, Edge>);
+    size_t bytes = m_edges.numSlots() * slotSize;
+    bytes += m_edgeArena->capacity() * sizeof(BaseEdge);
+    AttributesSchemaPtr lastSchema;
+    for (auto const& p : m_edges) {
+        const Attributes& attrs = p.second.m_ptr->m_attrs;
+        bytes += attrs.memoryUsage() - sizeof(Attributes); // stored in the record
+        // the edges of a graph usually share a single schema
+        if (attrs.schema() && attrs.schema() != lastSchema) {
+            lastSchema = attrs.schema();
+            bytes += lastSchema->memoryUsage();
+        }
+    }
+    // each entry of the pairs' index is a node of a linked list
+    bytes += m_pairs.bucket_count() * sizeof(void*);
+    bytes += m_pairs.size() * (sizeof(std::pair<const quint64, int>) + 2 * sizeof(void*));
+    for (auto const& p : m_nodes) {
+        const Node& node = p.second;
+        bytes += node.outEdges().numSlots() * slotSize;
+        if (isDirected()) {
+            bytes += node.inEdges().numSlots() * slotSize;
+        }
+    }
+    return bytes;
 }
 
 Node AbstractGraph::addNode(Attributes attr, float x, float y)
 {
+    ensureEdges(); // the new node does not fit in a lattice
     QMutexLocker locker(&m_mutex);
     ++m_lastNodeId;
     Node node;
@@ -71,93 +373,428 @@ Node AbstractGraph::addNode(Attributes attr, float x, float y)
         node.m_ptr = std::make_shared<UNode>(k, m_lastNodeId, attr, x, y);
     }
     m_nodes.insert({m_lastNodeId, node});
-    m_numNodesDist = std::uniform_int_distribution<int>(0, numNodes()-1);
+    bindNodeAttrs(node);
+    invalidateAdjacency();
     return node;
 }
 
 Edge AbstractGraph::addEdge(const Node& origin, const Node& neighbour, Attributes* attrs)
 {
+    if (!attrs) {
+        return addEdge(origin, neighbour, Attributes());
+    }
+    Attributes a = std::move(*attrs);
+    delete attrs;
+    return addEdge(origin, neighbour, std::move(a));
+}
+
+Edge AbstractGraph::addEdge(const Node& origin, const Node& neighbour, Attributes attrs)
+{
+    ensureEdges();
     QMutexLocker locker(&m_mutex);
     ++m_lastEdgeId;
-    Edge edgeOut, edgeIn;
-    BaseEdge::constructor_key k;
-    edgeOut.m_ptr = std::make_shared<BaseEdge>(k, m_lastEdgeId, origin, neighbour, attrs, true);
-    edgeIn.m_ptr = std::make_shared<BaseEdge>(k, m_lastEdgeId, neighbour, origin, attrs, false);
+    Edge edgeOut = insertEdge(m_lastEdgeId, origin, neighbour, std::move(attrs));
+    invalidateAdjacency();
+    return edgeOut;
+}
+
+bool AbstractGraph::commitEdges(std::vector<EdgeBuffer>& buffers)
+{
+    ensureEdges();
+    QMutexLocker locker(&m_mutex);
+
+    // counts the new edges of each node, so that all containers
+    // are grown only once
+    std::vector<size_t> numIn(static_cast<size_t>(m_lastNodeId + 1), 0);
+    std::vector<size_t> numOut(numIn.size(), 0);
+    size_t numEdges = 0;
+    for (const EdgeBuffer& b : buffers) {
+        for (const EdgeBuffer::Entry& e : b.m_entries) {
+            if (!m_nodes.count(e.originId) || !m_nodes.count(e.neighbourId)) {
+                return false;
+            }
+            ++numOut[static_cast<size_t>(e.originId)];
+            ++numIn[static_cast<size_t>(e.neighbourId)];
+        }
+        numEdges += b.m_entries.size();
+    }
+
+    m_edgeArena->reserve(m_edgeArena->size() + numEdges);
+    m_edges.reserve(static_cast<size_t>(m_lastEdgeId + 1) + numEdges);
+    for (auto const& np : m_nodes) {
+        const size_t id = static_cast<size_t>(np.first);
+        if (numIn[id] || numOut[id]) {
+            np.second.m_ptr->reserveEdges(numIn[id], numOut[id]);
+        }
+    }
+
+    for (EdgeBuffer& b : buffers) {
+        for (EdgeBuffer::Entry& e : b.m_entries) {
+            ++m_lastEdgeId;
+            insertEdge(m_lastEdgeId, m_nodes.at(e.originId),
+                       m_nodes.at(e.neighbourId), std::move(e.attrs));
+        }
+        std::vector<EdgeBuffer::Entry>().swap(b.m_entries);
+    }
+
+    if (numEdges > 0) {
+        invalidateAdjacency();
+    }
+    return true;
+}
+
+Edge AbstractGraph::insertEdge(int edgeId, const Node& origin, const Node& neighbour, Attributes attrs)
+{
+    BaseEdge* e = m_edgeArena->create(edgeId, origin, neighbour, std::move(attrs));
+    Edge edgeOut(e);
     origin.m_ptr->addOutEdge(edgeOut);
-    neighbour.m_ptr->addInEdge(edgeIn); // neighbour must be aware of the in-connection
-    m_edges.insert({m_lastEdgeId, edgeOut}); // store only the original direction
+    neighbour.m_ptr->addInEdge(Edge(e, true)); // neighbour must be aware of the in-connection
+    m_edges.insert({edgeId, edgeOut}); // store only the original direction
+    if (m_pairsIndexed) {
+        QMutexLocker locker(&m_adjMutex);
+        m_pairs.insert({pairKey(origin.id(), neighbour.id()), edgeId});
+    }
     return edgeOut;
 }
 
+const Edge& AbstractGraph::edge(int originId, int neighbourId) const
+{
+    ensureEdges();
+    if (!m_pairsIndexed) {
+        indexPairs();
+    }
+    QMutexLocker locker(&m_adjMutex);
+    auto it = m_pairs.find(pairKey(originId, neighbourId));
+    if (it == m_pairs.end()) {
+        throw std::out_of_range("the nodes are not connected");
+    }
+    const int edgeId = it->second;
+    locker.unlock();
+    // the handle held by the origin is oriented from the origin outwards
+    return m_nodes.at(originId).outEdges().at(edgeId);
+}
+
+void AbstractGraph::indexPairs() const
+{
+    QMutexLocker locker(&m_adjMutex);
+    if (m_pairsIndexed) {
+        return; // another thread has just built it
+    }
+    m_pairs.clear();
+    m_pairs.reserve(m_edges.size());
+    for (auto const& p : m_edges) {
+        const BaseEdge* e = p.second.m_ptr;
+        m_pairs.insert({pairKey(e->origin().id(), e->neighbour().id()), p.first});
+    }
+    m_pairsIndexed = true;
+}
+
+void AbstractGraph::unindexPair(const BaseEdge* e)
+{
+    if (!m_pairsIndexed) {
+        return;
+    }
+    QMutexLocker locker(&m_adjMutex);
+    auto range = m_pairs.equal_range(pairKey(e->origin().id(), e->neighbour().id()));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == e->id()) {
+            m_pairs.erase(it);
+            return;
+        }
+    }
+}
+
+int AbstractGraph::numEdges() const
+{
+    if (m_edgesPending) {
+        return m_topology ? m_topology->numEdges() : m_lattice->numEdges();
+    }
+    return static_cast<int>(m_edges.size());
+}
+
+void AbstractGraph::reserveEdges(int numEdges)
+{
+    ensureEdges();
+    QMutexLocker locker(&m_mutex);
+    m_edgeArena->reserve(static_cast<size_t>(std::max(0, numEdges)));
+    m_edges.reserve(static_cast<size_t>(m_lastEdgeId + 1 + std::max(0, numEdges)));
+}
+
+void AbstractGraph::destroyEdge(int edgeId)
+{
+    auto it = m_edges.find(edgeId);
+    if (it != m_edges.end()) {
+        BaseEdge* e = it->second.m_ptr;
+        unindexPair(e);
+        m_edges.erase(it);
+        m_edgeArena->destroy(e);
+    }
+}
+
 void AbstractGraph::removeAllEdges()
 {
     QMutexLocker locker(&m_mutex);
+    if (m_edgesPending) {
+        // just drops the shared topology; no Edge objects were created
+        for (auto const& p : m_nodes) {
+            p.second.m_ptr->m_lazyGraph = nullptr;
+        }
+        m_topology.reset();
+        m_edgesPending = false;
+    }
     for (auto const& p : m_nodes) {
         p.second.m_ptr->clearInEdges();
         p.second.m_ptr->clearOutEdges();
     }
+    for (auto const& p : m_edges) {
+        m_edgeArena->destroy(p.second.m_ptr);
+    }
     m_edges.clear();
+    {
+        QMutexLocker adjLocker(&m_adjMutex);
+        m_pairs.clear();
+    }
+    m_edgeArena->release();
+    invalidateAdjacency();
 }
 
 void AbstractGraph::removeAllEdges(const Node& node)
 {
+    ensureEdges();
     QMutexLocker locker(&m_mutex);
     if (isUndirected()) {
         for (auto const& p : node.outEdges()) {
             p.second.neighbour().m_ptr->removeInEdge(p.first);
-            m_edges.erase(p.first);
+            destroyEdge(p.first);
         }
         node.m_ptr->clearOutEdges();
     } else if (isDirected()) {
         for (auto const& p : node.outEdges()) {
             p.second.neighbour().m_ptr->removeInEdge(p.first);
-            m_edges.erase(p.first);
+            destroyEdge(p.first);
         }
         for (auto const& p : node.inEdges()) {
             p.second.neighbour().m_ptr->removeOutEdge(p.first);
-            m_edges.erase(p.first);
+            destroyEdge(p.first);
         }
         node.m_ptr->clearInEdges();
         node.m_ptr->clearOutEdges();
     } else {
         qFatal("invalid type!");
     }
+    invalidateAdjacency();
 }
 
 void AbstractGraph::removeNode(const Node& node)
 {
     removeAllEdges(node);
     QMutexLocker locker(&m_mutex);
+    node.m_ptr->unbind();
     m_nodes.erase(node.id());
-    int sz = m_nodes.empty() ? 0 : numNodes()-1;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, sz);
+    invalidateAdjacency();
 }
 
 Nodes::iterator AbstractGraph::removeNode(Nodes::iterator it)
 {
     removeAllEdges(it->second);
     QMutexLocker locker(&m_mutex);
+    it->second.m_ptr->unbind();
     it = m_nodes.erase(it);
-    int sz = m_nodes.empty() ? 0 : numNodes()-1;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, sz);
+    invalidateAdjacency();
     return it;
 }
 
 void AbstractGraph::removeEdge(const Edge& edge)
 {
+    ensureEdges();
     QMutexLocker locker(&m_mutex);
-    edge.origin().m_ptr->removeOutEdge(edge.id());
-    edge.neighbour().m_ptr->removeInEdge(edge.id());
-    m_edges.erase(edge.id());
+    // 'edge' may be a reference to the handle we are about to erase
+    const BaseEdge* e = edge.m_ptr;
+    const int edgeId = e->id();
+    e->origin().m_ptr->removeOutEdge(edgeId);
+    e->neighbour().m_ptr->removeInEdge(edgeId);
+    destroyEdge(edgeId);
+    invalidateAdjacency();
+}
+
+double AbstractGraph::fragmentation() const
+{
+    auto ratio = [](size_t size, size_t numSlots) {
+        return numSlots ? static_cast<double>(numSlots - size) / numSlots : 0.0;
+    };
+    return std::max(ratio(m_nodes.size(), m_nodes.numSlots()),
+                    ratio(m_edges.size(), m_edges.numSlots()));
+}
+
+void AbstractGraph::squeeze()
+{
+    QMutexLocker locker(&m_mutex);
+    m_nodes.squeeze();
+    m_edges.squeeze();
+    m_nodeAttrs->squeeze();
+    // the pending edges have not been created yet; there is nothing to drop
+    if (!m_edgesPending) {
+        for (auto const& np : m_nodes) {
+            np.second.m_ptr->squeezeEdges();
+        }
+    }
 }
 
 Edges::iterator AbstractGraph::removeEdge(Edges::iterator it)
 {
     QMutexLocker locker(&m_mutex);
-    const Edge& edge = it->second;
-    edge.origin().m_ptr->removeOutEdge(edge.id());
-    edge.neighbour().m_ptr->removeInEdge(edge.id());
-    return m_edges.erase(it);
+    BaseEdge* e = it->second.m_ptr;
+    e->origin().m_ptr->removeOutEdge(e->id());
+    e->neighbour().m_ptr->removeInEdge(e->id());
+    unindexPair(e);
+    it = m_edges.erase(it);
+    m_edgeArena->destroy(e);
+    invalidateAdjacency();
+    return it;
+}
+
+void AbstractGraph::saveState(QDataStream& out) const
+{
+    // the pending edges of a lattice take the next ids, as in createPendingEdges()
+    const bool pendingLattice = m_edgesPending && m_lattice;
+    const int lastEdgeId = pendingLattice ? m_lastEdgeId + m_lattice->numEdges() : m_lastEdgeId;
+    out << static_cast<qint32>(m_lastNodeId) << static_cast<qint32>(lastEdgeId);
+
+    out << static_cast<quint32>(m_nodes.size());
+    for (auto const& np : m_nodes) {
+        const BaseNode* n = np.second.m_ptr.get();
+        const bool bound = n->m_table != nullptr;
+        out << static_cast<qint32>(np.first) << n->x() << n->y() << bound;
+        if (!bound) { // it has a different set of attributes
+            writeNames(out, n->m_attrs.names());
+            writeValues(out, n->m_attrs.values());
+        }
+    }
+    out << *m_nodeAttrs;
+
+    // the schema is written only when it differs from the previous edge's
+    AttributesSchemaPtr schema;
+    auto writeEdge = [&out, &schema](int id, int originId, int neighbourId, const Attributes& attrs) {
+        const bool newSchema = attrs.schema() != schema;
+        out << static_cast<qint32>(id) << static_cast<qint32>(originId)
+            << static_cast<qint32>(neighbourId) << newSchema;
+        if (newSchema) {
+            schema = attrs.schema();
+            writeNames(out, attrs.names());
+        }
+        writeValues(out, attrs.values());
+    };
+
+    // the pending edges are written without creating them
+    out << static_cast<quint32>(numEdges());
+    if (pendingLattice) {
+        int edgeId = m_lastEdgeId;
+        m_lattice->forEachEdge([&writeEdge, &edgeId](int originId, int neighbourId) {
+            writeEdge(++edgeId, originId, neighbourId, Attributes());
+        });
+    } else if (m_edgesPending) {
+        const auto& entries = m_topology->edges();
+        const auto& attrs = m_topology->edgeAttrs();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Topology::EdgeEntry& e = entries[i];
+            writeEdge(e.id, e.originId, e.neighbourId, attrs.empty() ? Attributes() : attrs[i]);
+        }
+    } else {
+        for (auto const& ep : m_edges) {
+            const BaseEdge* e = ep.second.m_ptr;
+            writeEdge(ep.first, e->origin().id(), e->neighbour().id(), *e->attrs());
+        }
+    }
+}
+
+bool AbstractGraph::restoreState(QDataStream& in)
+{
+    struct NodeData { qint32 id; float x; float y; bool bound; Attributes attrs; };
+    struct EdgeData { qint32 id; qint32 originId; qint32 neighbourId; Attributes attrs; };
+
+    qint32 lastNodeId, lastEdgeId;
+    in >> lastNodeId >> lastEdgeId;
+
+    // reads everything before touching the graph
+    quint32 numNodes;
+    in >> numNodes;
+    std::vector<NodeData> nodes;
+    std::unordered_set<int> nodeIds;
+    for (quint32 i = 0; i < numNodes && in.status() == QDataStream::Ok; ++i) {
+        NodeData n;
+        in >> n.id >> n.x >> n.y >> n.bound;
+        if (!n.bound) {
+            n.attrs = readAttrs(in, readSchema(in));
+        }
+        if (n.id < 0 || n.id > lastNodeId || !nodeIds.insert(n.id).second) {
+            in.setStatus(QDataStream::ReadCorruptData);
+        }
+        nodes.emplace_back(std::move(n));
+    }
+
+    auto table = std::make_shared<AttributesTable>();
+    in >> *table;
+    for (const NodeData& n : nodes) {
+        if (n.bound && !table->isValidRow(static_cast<size_t>(n.id))) {
+            in.setStatus(QDataStream::ReadCorruptData);
+        }
+    }
+
+    quint32 numEdges;
+    in >> numEdges;
+    std::vector<EdgeData> edges;
+    std::unordered_set<int> edgeIds;
+    Attributes sample;
+    for (quint32 i = 0; i < numEdges && in.status() == QDataStream::Ok; ++i) {
+        EdgeData e;
+        bool newSchema;
+        in >> e.id >> e.originId >> e.neighbourId >> newSchema;
+        if (newSchema) {
+            sample = readSchema(in);
+        }
+        e.attrs = readAttrs(in, sample);
+        if (e.id < 0 || e.id > lastEdgeId || !edgeIds.insert(e.id).second ||
+                !nodeIds.count(e.originId) || !nodeIds.count(e.neighbourId)) {
+            in.setStatus(QDataStream::ReadCorruptData);
+        }
+        edges.emplace_back(std::move(e));
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    removeAllEdges();
+    QMutexLocker locker(&m_mutex);
+
+    // the current nodes are just dropped; the trial has not handed them out yet
+    m_nodeAttrs = table;
+    m_nodes = Nodes();
+    m_nodes.reserve(nodes.size());
+    BaseNode::constructor_key k;
+    for (NodeData& n : nodes) {
+        NodePtr node;
+        if (isDirected()) {
+            node = std::make_shared<DNode>(k, n.id, n.attrs, n.x, n.y);
+        } else {
+            node = std::make_shared<UNode>(k, n.id, n.attrs, n.x, n.y);
+        }
+        if (n.bound) {
+            node->m_table = m_nodeAttrs; // the row is already there
+        }
+        m_nodes.insert({n.id, Node(node)});
+    }
+    m_lastNodeId = lastNodeId;
+
+    m_edgeArena->reserve(edges.size());
+    m_edges.reserve(static_cast<size_t>(lastEdgeId + 1));
+    for (EdgeData& e : edges) {
+        insertEdge(e.id, m_nodes.at(e.originId), m_nodes.at(e.neighbourId), std::move(e.attrs));
+    }
+    m_lastEdgeId = lastEdgeId;
+
+    invalidateAdjacency();
+    return true;
 }
 
 } // evoplex
@@ -31,4 +31,7 @@ int AbstractModel::step() const
 int AbstractModel::lastStep() const
 { return m_trial->stopAt(); }
 
+void AbstractModel::parallelFor(const std::function<void(const Partition&)>& func) const
+{ m_trial->parallelFor(func); }
+
 } // evoplex
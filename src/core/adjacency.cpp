@@ -0,0 +1,70 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "adjacency.h"
+#include "edge.h"
+#include "node.h"
+
+namespace evoplex {
+
+void Adjacency::build(const Nodes& nodes, bool outward)
+{
+    int maxNodeId = -1;
+    for (auto const& np : nodes) {
+        maxNodeId = std::max(maxNodeId, np.first);
+    }
+    const size_t numSlots = static_cast<size_t>(maxNodeId + 1);
+
+    // 1. count the degree of each node
+    std::vector<int> offsets(numSlots + 1, 0);
+    for (auto const& np : nodes) {
+        const Edges& edges = outward ? np.second.outEdges() : np.second.inEdges();
+        offsets[static_cast<size_t>(np.first) + 1] = static_cast<int>(edges.size());
+    }
+
+    // 2. prefix sum
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i-1];
+    }
+
+    // 3. fill in the neighbours following the same order of the edges container
+    std::vector<int> neighbourIds(static_cast<size_t>(offsets.back()));
+    std::vector<int> edgeIds(neighbourIds.size());
+    for (auto const& np : nodes) {
+        const Edges& edges = outward ? np.second.outEdges() : np.second.inEdges();
+        size_t pos = static_cast<size_t>(offsets[static_cast<size_t>(np.first)]);
+        for (auto const& ep : edges) {
+            neighbourIds[pos] = ep.second.neighbour().id();
+            edgeIds[pos] = ep.first;
+            ++pos;
+        }
+    }
+
+    m_offsets.swap(offsets);
+    m_neighbourIds.swap(neighbourIds);
+    m_edgeIds.swap(edgeIds);
+}
+
+void Adjacency::clear()
+{
+    std::vector<int>().swap(m_offsets);
+    std::vector<int>().swap(m_neighbourIds);
+    std::vector<int>().swap(m_edgeIds);
+}
+
+} // evoplex
@@ -0,0 +1,110 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include "attributes.h"
+
+namespace evoplex {
+
+AttributesSchema::AttributesSchema(std::vector<QString> names,
+                                   std::vector<Value::Type> types)
+    : m_names(std::move(names)),
+      m_types(std::move(types))
+{
+    m_types.resize(m_names.size(), Value::INVALID);
+}
+
+AttributesSchemaPtr AttributesSchema::fromScope(const AttributesScope& attrsScope)
+{
+    auto schema = std::make_shared<AttributesSchema>();
+    schema->m_names.resize(static_cast<size_t>(attrsScope.size()));
+    schema->m_types.resize(schema->m_names.size(), Value::INVALID);
+    for (auto attrRange : attrsScope) {
+        const size_t id = static_cast<size_t>(attrRange->id());
+        schema->m_names.at(id) = attrRange->attrName();
+        switch (attrRange->type()) {
+        case AttributeRange::Bool:
+            schema->m_types.at(id) = Value::BOOL;
+            break;
+        case AttributeRange::Double_Range:
+        case AttributeRange::Double_Set:
+            schema->m_types.at(id) = Value::DOUBLE;
+            break;
+        case AttributeRange::Int_Range:
+        case AttributeRange::Int_Set:
+            schema->m_types.at(id) = Value::INT;
+            break;
+        case AttributeRange::String_Set:
+        case AttributeRange::String:
+        case AttributeRange::NonEmptyString:
+        case AttributeRange::DirPath:
+        case AttributeRange::FilePath:
+            schema->m_types.at(id) = Value::STRING;
+            break;
+        default:
+            break;
+        }
+    }
+    return schema;
+}
+
+size_t AttributesSchema::memoryUsage() const
+{
+    size_t bytes = sizeof(AttributesSchema);
+    bytes += m_names.capacity() * sizeof(QString);
+    bytes += m_types.capacity() * sizeof(Value::Type);
+    for (const QString& name : m_names) {
+        bytes += static_cast<size_t>(name.capacity()) * sizeof(QChar);
+    }
+    return bytes;
+}
+
+/*******************************************************/
+/*******************************************************/
+
+Attributes::Attributes(AttributesSchemaPtr schema)
+    : m_schema(std::move(schema)),
+      m_ownSchema(nullptr),
+      m_values(m_schema ? m_schema->m_names.size() : 0)
+{
+}
+
+AttributesSchema& Attributes::detach()
+{
+    // a moved-from container keeps the pointer, but not the schema
+    if (!m_ownSchema || m_ownSchema != m_schema.get() || m_schema.use_count() > 1) {
+        auto schema = m_schema ? std::make_shared<AttributesSchema>(*m_schema)
+                               : std::make_shared<AttributesSchema>();
+        m_ownSchema = schema.get();
+        m_schema = std::move(schema);
+    }
+    return *m_ownSchema;
+}
+
+size_t Attributes::memoryUsage() const
+{
+    size_t bytes = sizeof(Attributes);
+    bytes += m_values.capacity() * sizeof(Value);
+    for (const Value& v : m_values) {
+        if (v.type() == Value::STRING) {
+            bytes += std::strlen(v.toString()) + 1;
+        }
+    }
+    return bytes;
+}
+
+} // evoplex
@@ -0,0 +1,555 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QDataStream>
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+#include "attributestable.h"
+
+namespace evoplex {
+
+namespace {
+
+template <typename T>
+void writeArray(QDataStream& out, const std::vector<T>& v)
+{
+    out << static_cast<quint64>(v.size());
+    for (const T& x : v) {
+        out << x;
+    }
+}
+
+template <typename T>
+void readArray(QDataStream& in, std::vector<T>& v)
+{
+    quint64 size;
+    in >> size;
+    v.clear();
+    // the size of a corrupted stream cannot be trusted; no reserve()
+    for (quint64 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        T x;
+        in >> x;
+        v.emplace_back(x);
+    }
+}
+
+// the value held by the new rows of a column of this type
+Value defaultValue(Value::Type type)
+{
+    switch (type) {
+    case Value::BOOL: return Value(false);
+    case Value::CHAR: return Value(char(0));
+    case Value::DOUBLE: return Value(0.0);
+    case Value::INT: return Value(0);
+    case Value::STRING: return Value("");
+    case Value::INVALID: return Value();
+    }
+    return Value();
+}
+
+} // namespace
+
+AttributeColumn::AttributeColumn(Value::Type type)
+    : m_type(type),
+      m_size(0)
+{
+    if (m_type == Value::STRING) {
+        intern(Value("")); // default value
+    }
+}
+
+void AttributeColumn::resize(size_t numRows)
+{
+    if (m_type == Value::BOOL && numRows < m_size && (numRows & 63)) {
+        // the rows beyond the end must be false if they are added again
+        m_bits[numRows >> 6] &= (quint64(1) << (numRows & 63)) - 1;
+    }
+    switch (m_type) {
+    case Value::BOOL: m_bits.resize((numRows + 63) / 64, 0); break;
+    case Value::CHAR: m_chars.resize(numRows, 0); break;
+    case Value::DOUBLE: m_doubles.resize(numRows, 0.0); break;
+    case Value::INT: m_ints.resize(numRows, 0); break;
+    case Value::STRING: m_ints.resize(numRows, 0); break;
+    case Value::INVALID: m_generic.resize(numRows); break;
+    }
+    m_size = numRows;
+}
+
+void AttributeColumn::reserve(size_t numRows)
+{
+    switch (m_type) {
+    case Value::BOOL: m_bits.reserve((numRows + 63) / 64); break;
+    case Value::CHAR: m_chars.reserve(numRows); break;
+    case Value::DOUBLE: m_doubles.reserve(numRows); break;
+    case Value::INT: m_ints.reserve(numRows); break;
+    case Value::STRING: m_ints.reserve(numRows); break;
+    case Value::INVALID: m_generic.reserve(numRows); break;
+    }
+}
+
+Value AttributeColumn::value(size_t row) const
+{
+    switch (m_type) {
+    case Value::BOOL: return Value(boolAt(row));
+    case Value::CHAR: return Value(m_chars[row]);
+    case Value::DOUBLE: return Value(m_doubles[row]);
+    case Value::INT: return Value(m_ints[row]);
+    case Value::STRING: return stringAt(row);
+    case Value::INVALID: return m_generic[row];
+    }
+    return Value();
+}
+
+void AttributeColumn::setValue(size_t row, const Value& value)
+{
+    if (value.type() != m_type && !isGeneric()) {
+        toGeneric();
+    }
+
+    switch (m_type) {
+    case Value::BOOL: setBoolAt(row, value.toBool()); break;
+    case Value::CHAR: setCharAt(row, value.toChar()); break;
+    case Value::DOUBLE: setDoubleAt(row, value.toDouble()); break;
+    case Value::INT: setIntAt(row, value.toInt()); break;
+    case Value::STRING: m_ints[row] = intern(value); break;
+    case Value::INVALID: m_generic[row] = value; break;
+    }
+}
+
+qint32 AttributeColumn::intern(const Value& value)
+{
+    auto it = m_stringIds.find(value);
+    if (it != m_stringIds.end()) {
+        return it->second;
+    }
+    const qint32 id = static_cast<qint32>(m_strings.size());
+    m_strings.emplace_back(value);
+    m_stringIds.insert({value, id});
+    return id;
+}
+
+void AttributeColumn::toGeneric()
+{
+    std::vector<Value> generic;
+    generic.reserve(m_size);
+    for (size_t row = 0; row < m_size; ++row) {
+        generic.emplace_back(value(row));
+    }
+
+    m_type = Value::INVALID;
+    m_generic.swap(generic);
+    std::vector<quint64>().swap(m_bits);
+    std::vector<char>().swap(m_chars);
+    std::vector<double>().swap(m_doubles);
+    std::vector<qint32>().swap(m_ints);
+    std::vector<Value>().swap(m_strings);
+    m_stringIds.clear();
+}
+
+void AttributeColumn::swap(AttributeColumn& other)
+{
+    std::swap(m_type, other.m_type);
+    std::swap(m_size, other.m_size);
+    m_bits.swap(other.m_bits);
+    m_chars.swap(other.m_chars);
+    m_doubles.swap(other.m_doubles);
+    m_ints.swap(other.m_ints);
+    m_strings.swap(other.m_strings);
+    m_stringIds.swap(other.m_stringIds);
+    m_generic.swap(other.m_generic);
+}
+
+std::vector<int> AttributeColumn::count(const Values& header, const std::vector<bool>& rows) const
+{
+    std::vector<int> ret(header.size(), 0);
+    const bool allRows = rows.empty();
+
+    if (m_type == Value::BOOL && allRows) {
+        // count the set bits of each word
+        int numTrue = 0;
+        for (quint64 w : m_bits) {
+            for (; w; ++numTrue) { w &= w - 1; }
+        }
+        const int numFalse = static_cast<int>(m_size) - numTrue;
+        for (size_t h = 0; h < header.size(); ++h) {
+            if (header[h].type() == Value::BOOL) {
+                ret[h] = header[h].toBool() ? numTrue : numFalse;
+            }
+        }
+        return ret;
+    }
+
+    if (m_type == Value::INT) {
+        // the header is usually small, so a linear search beats hashing
+        for (size_t row = 0; row < m_size; ++row) {
+            if (!allRows && !rows[row]) continue;
+            for (size_t h = 0; h < header.size(); ++h) {
+                if (header[h].type() == Value::INT && header[h].toInt() == m_ints[row]) {
+                    ++ret[h];
+                    break;
+                }
+            }
+        }
+        return ret;
+    }
+
+    for (size_t row = 0; row < m_size; ++row) {
+        if (!allRows && !rows[row]) continue;
+        const size_t h = std::find(header.begin(), header.end(), value(row)) - header.begin();
+        if (h != header.size()) {
+            ++ret[h];
+        }
+    }
+    return ret;
+}
+
+size_t AttributeColumn::memoryUsage() const
+{
+    // strings are counted as pointers; their payload is usually small
+    size_t bytes = sizeof(AttributeColumn);
+    bytes += m_bits.capacity() * sizeof(quint64);
+    bytes += m_chars.capacity() * sizeof(char);
+    bytes += m_doubles.capacity() * sizeof(double);
+    bytes += m_ints.capacity() * sizeof(qint32);
+    bytes += m_strings.capacity() * sizeof(Value);
+    bytes += m_stringIds.size() * (sizeof(Value) + sizeof(qint32) + sizeof(void*));
+    bytes += m_generic.capacity() * sizeof(Value);
+    return bytes;
+}
+
+/*******************************************************/
+/*******************************************************/
+
+AttributesTable::AttributesTable(const Attributes& sample)
+    : m_schema(sample.schema()),
+      m_size(0)
+{
+    m_columns.reserve(sample.values().size());
+    for (int col = 0; col < sample.size(); ++col) {
+        // the schema may know the type of a value not set yet
+        Value::Type type = sample.value(col).type();
+        if (type == Value::INVALID) {
+            type = m_schema->type(col);
+        }
+        m_columns.emplace_back(std::make_shared<AttributeColumn>(type));
+    }
+    m_pinned.resize(m_columns.size(), false);
+    m_backColumns.resize(m_columns.size());
+}
+
+AttributesTable::AttributesTable(const AttributesTable& other)
+    : m_schema(other.m_schema),
+      m_columns(other.m_columns),
+      m_pinned(other.m_columns.size(), false),
+      m_backColumns(other.m_columns.size()),
+      m_valid(other.m_valid),
+      m_size(other.m_size)
+{
+    // the other table may write to its pinned columns without detaching them
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        if (other.m_pinned[col]) {
+            m_columns[col] = std::make_shared<AttributeColumn>(*other.m_columns[col]);
+        }
+    }
+}
+
+AttributesTable& AttributesTable::operator=(const AttributesTable& other)
+{
+    if (this != &other) {
+        AttributesTable copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+AttributeColumn& AttributesTable::detach(size_t col)
+{
+    std::shared_ptr<AttributeColumn>& c = m_columns.at(col);
+    if (c.use_count() > 1) {
+        c = std::make_shared<AttributeColumn>(*c);
+    } else {
+        // pairs with the release of the last reference held by another table
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *c;
+}
+
+void AttributesTable::detachAll()
+{
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        detach(col);
+    }
+}
+
+AttributeColumn& AttributesTable::backColumn(int col)
+{
+    std::unique_ptr<AttributeColumn>& back = m_backColumns.at(static_cast<size_t>(col));
+    if (!back) {
+        // the front is swapped in place, so it must not be shared
+        back.reset(new AttributeColumn(column(col)));
+    }
+    return *back;
+}
+
+void AttributesTable::swapBuffers()
+{
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        if (m_backColumns[col]) {
+            m_columns[col]->swap(*m_backColumns[col]);
+        }
+    }
+}
+
+bool AttributesTable::matches(const Attributes& attrs) const
+{
+    return attrs.schema() == m_schema || attrs.names() == names();
+}
+
+void AttributesTable::reserve(size_t numRows)
+{
+    m_valid.reserve(numRows);
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        detach(col).reserve(numRows);
+        if (m_backColumns[col]) {
+            m_backColumns[col]->reserve(numRows);
+        }
+    }
+}
+
+void AttributesTable::insertRow(size_t row, const Attributes& attrs)
+{
+    if (!matches(attrs)) {
+        throw std::invalid_argument("the attributes do not match the table");
+    }
+
+    if (row >= m_valid.size()) {
+        m_valid.resize(row + 1, false);
+        for (size_t col = 0; col < m_columns.size(); ++col) {
+            detach(col).resize(row + 1);
+            if (m_backColumns[col]) {
+                m_backColumns[col]->resize(row + 1);
+            }
+        }
+    }
+
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        detach(col).setValue(row, attrs.values()[col]);
+        if (m_backColumns[col]) {
+            m_backColumns[col]->setValue(row, attrs.values()[col]);
+        }
+    }
+
+    if (!m_valid[row]) {
+        m_valid[row] = true;
+        ++m_size;
+    }
+}
+
+void AttributesTable::removeRow(size_t row)
+{
+    if (isValidRow(row)) {
+        m_valid[row] = false;
+        --m_size;
+    }
+}
+
+void AttributesTable::squeeze()
+{
+    size_t numRows = m_valid.size();
+    while (numRows > 0 && !m_valid[numRows - 1]) {
+        --numRows;
+    }
+    if (numRows == m_valid.size()) {
+        return;
+    }
+    m_valid.resize(numRows);
+    m_valid.shrink_to_fit();
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        detach(col).resize(numRows);
+        if (m_backColumns[col]) {
+            m_backColumns[col]->resize(numRows);
+        }
+    }
+}
+
+size_t AttributesTable::memoryUsage() const
+{
+    size_t bytes = sizeof(AttributesTable) + m_valid.capacity() / 8;
+    for (auto const& col : m_columns) {
+        bytes += col->memoryUsage();
+    }
+    for (auto const& back : m_backColumns) {
+        bytes += back ? back->memoryUsage() : 0;
+    }
+    return m_schema ? bytes + m_schema->memoryUsage() : bytes;
+}
+
+Attributes AttributesTable::row(size_t row) const
+{
+    Attributes attrs(m_schema);
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        attrs.setValue(static_cast<int>(col), m_columns[col]->value(row));
+    }
+    return attrs;
+}
+
+QDataStream& operator<<(QDataStream& out, const AttributeColumn& col)
+{
+    out << static_cast<quint8>(col.m_type) << static_cast<quint64>(col.m_size);
+    switch (col.m_type) {
+    case Value::BOOL: writeArray(out, col.m_bits); break;
+    case Value::CHAR: out << QByteArray(col.m_chars.data(), static_cast<int>(col.m_chars.size())); break;
+    case Value::DOUBLE: writeArray(out, col.m_doubles); break;
+    case Value::INT: writeArray(out, col.m_ints); break;
+    case Value::STRING: writeArray(out, col.m_ints); writeArray(out, col.m_strings); break;
+    case Value::INVALID: writeArray(out, col.m_generic); break;
+    }
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, AttributeColumn& col)
+{
+    quint8 type;
+    quint64 size;
+    in >> type >> size;
+    if (type > Value::INVALID) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    AttributeColumn c(static_cast<Value::Type>(type));
+    size_t numItems = 0;
+    switch (c.m_type) {
+    case Value::BOOL:
+        readArray(in, c.m_bits);
+        numItems = c.m_bits.size() * 64;
+        break;
+    case Value::CHAR: {
+        QByteArray chars;
+        in >> chars;
+        c.m_chars.assign(chars.constBegin(), chars.constEnd());
+        numItems = c.m_chars.size();
+        break;
+    }
+    case Value::DOUBLE:
+        readArray(in, c.m_doubles);
+        numItems = c.m_doubles.size();
+        break;
+    case Value::INT:
+        readArray(in, c.m_ints);
+        numItems = c.m_ints.size();
+        break;
+    case Value::STRING:
+        readArray(in, c.m_ints);
+        readArray(in, c.m_strings);
+        c.m_stringIds.clear();
+        for (size_t i = 0; i < c.m_strings.size(); ++i) {
+            c.m_stringIds.insert({c.m_strings[i], static_cast<qint32>(i)});
+        }
+        numItems = std::all_of(c.m_ints.cbegin(), c.m_ints.cend(), [&c](qint32 id) {
+            return id >= 0 && static_cast<size_t>(id) < c.m_strings.size();
+        }) ? c.m_ints.size() : 0;
+        break;
+    case Value::INVALID:
+        readArray(in, c.m_generic);
+        numItems = c.m_generic.size();
+        break;
+    }
+
+    c.m_size = static_cast<size_t>(size);
+    if (in.status() == QDataStream::Ok && numItems >= c.m_size) {
+        col.swap(c);
+    } else {
+        in.setStatus(QDataStream::ReadCorruptData);
+    }
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const AttributesTable& table)
+{
+    out << static_cast<quint32>(table.m_columns.size());
+    for (const QString& name : table.names()) {
+        out << name;
+    }
+
+    out << static_cast<quint64>(table.m_valid.size());
+    for (bool valid : table.m_valid) {
+        out << valid;
+    }
+
+    for (size_t col = 0; col < table.m_columns.size(); ++col) {
+        out << *table.m_columns[col];
+        const bool hasBack = table.m_backColumns[col] != nullptr;
+        out << hasBack;
+        if (hasBack) {
+            out << *table.m_backColumns[col];
+        }
+    }
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, AttributesTable& table)
+{
+    quint32 numColumns;
+    in >> numColumns;
+    std::vector<QString> names;
+    for (quint32 col = 0; col < numColumns && in.status() == QDataStream::Ok; ++col) {
+        QString name;
+        in >> name;
+        names.emplace_back(name);
+    }
+
+    AttributesTable t;
+    quint64 numRows;
+    in >> numRows;
+    for (quint64 row = 0; row < numRows && in.status() == QDataStream::Ok; ++row) {
+        bool valid;
+        in >> valid;
+        t.m_valid.push_back(valid);
+        t.m_size += valid ? 1 : 0;
+    }
+
+    Attributes sample;
+    for (size_t col = 0; col < names.size() && in.status() == QDataStream::Ok; ++col) {
+        auto column = std::make_shared<AttributeColumn>();
+        in >> *column;
+        bool hasBack;
+        in >> hasBack;
+        std::unique_ptr<AttributeColumn> back;
+        if (hasBack) {
+            back.reset(new AttributeColumn());
+            in >> *back;
+        }
+        if (column->size() != t.m_valid.size() || (back && back->size() != t.m_valid.size())) {
+            in.setStatus(QDataStream::ReadCorruptData);
+        }
+        sample.push_back(names[col], defaultValue(column->type()));
+        t.m_columns.emplace_back(std::move(column));
+        t.m_backColumns.emplace_back(std::move(back));
+    }
+
+    if (in.status() == QDataStream::Ok) {
+        t.m_schema = sample.schema();
+        t.m_pinned.resize(t.m_columns.size(), false);
+        table = std::move(t);
+    }
+    return in;
+}
+
+} // evoplex
@@ -258,12 +258,13 @@ SetOfAttributes AGSameFuncForAll::create(int size, std::function<void(int)> prog
 {
     size = size < 1 ? m_size : size;
 
+    const AttributesSchemaPtr schema = AttributesSchema::fromScope(m_attrsScope);
     SetOfAttributes ret;
     ret.reserve(static_cast<size_t>(size));
     for (int id = 0; id < size; ++id) {
-        Attributes attrs(m_attrsScope.size());
+        Attributes attrs(schema);
         for (auto attrRange : m_attrsScope) {
-            attrs.replace(attrRange->id(), attrRange->attrName(), f_value(attrRange));
+            attrs.setValue(attrRange->id(), f_value(attrRange));
         }
         ret.emplace_back(attrs);
         progress(id);
@@ -292,12 +293,8 @@ SetOfAttributes AGDiffFunctions::create(int size, std::function<void(int)> progr
 {
     size = size < 1 ? m_size : size;
 
-    SetOfAttributes setOfAttrs;
-    setOfAttrs.reserve(static_cast<size_t>(size));
-    for (int i = 0; i < size; ++i) {
-        Attributes attrs(m_attrsScope.size());
-        setOfAttrs.emplace_back(attrs);
-    }
+    const AttributesSchemaPtr schema = AttributesSchema::fromScope(m_attrsScope);
+    SetOfAttributes setOfAttrs(static_cast<size_t>(size), Attributes(schema));
 
     std::function<Value()> value;
     for (const AttrCmd& cmd : m_attrCmds) {
@@ -324,7 +321,7 @@ SetOfAttributes AGDiffFunctions::create(int size, std::function<void(int)> progr
         }
 
         for (Attributes& attrs : setOfAttrs) {
-            attrs.replace(attrRange->id(), attrRange->attrName(), value());
+            attrs.setValue(attrRange->id(), value());
         }
         delete prg;
     }
@@ -0,0 +1,380 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+
+#include "batchrunner.h"
+#include "experiment.h"
+#include "experimentsmgr.h"
+#include "expinputs.h"
+#include "project.h"
+
+namespace evoplex {
+
+BatchRunner::BatchRunner(MainApp* mainApp)
+    : QObject(),
+      m_mainApp(mainApp),
+      m_done(false),
+      m_numWorkers(0),
+      m_pool(nullptr),
+      m_nextJob(0),
+      m_nextExpId(0),
+      m_numJobs(0),
+      m_numFailedJobs(0),
+      m_worker(nullptr),
+      m_workerIndex(0)
+{
+}
+
+bool BatchRunner::init(const QStringList& args, QString& error)
+{
+    QCommandLineParser parser;
+    parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    parser.setApplicationDescription("Runs the experiments of a project without the GUI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("project", "The project (csv file) to be run.");
+    parser.addOptions({
+        { "no-gui", "Runs without the GUI." },
+        { "experiments", "The ids of the experiments to be run; all of them and the sweeps by default.", "1,2,..." },
+        { "threads", "The max number of threads.", "n" },
+        { "stepsToFlush", "The number of steps kept in memory before writing them to file.", "n" },
+        { "memoryBudget", "The memory (in MB) the trials may take; 0 means no limit.", "mb" },
+        { "timeSlice", "The time (in ms) a trial runs before giving way to the waiting ones; "
+                       "0 means no limit.", "ms" },
+        { "workers", "Runs the experiments in n worker processes.", "n" },
+        { "worker", "Runs the experiments sent by a coordinator; it is used by -workers.", "server" },
+        { "workerIndex", "The index of this worker; it is used by -workers.", "i" }
+    });
+
+    if (!parser.parse(args)) {
+        error = parser.errorText() + "\n\n" + parser.helpText();
+        return false;
+    }
+    const bool isWorker = parser.isSet("worker");
+    if (parser.isSet("help") || parser.positionalArguments().size() != (isWorker ? 0 : 1)) {
+        error = parser.helpText();
+        return false;
+    }
+
+    // the settings are only changed for this run
+    if (parser.isSet("threads")) {
+        bool ok = false;
+        const int threads = parser.value("threads").toInt(&ok);
+        if (!ok) {
+            error = "the number of threads must be an integer.";
+            return false;
+        }
+        m_mainApp->expMgr()->setMaxThreadCount(threads, &error, false);
+        if (!error.isEmpty()) {
+            return false;
+        }
+    }
+    if (parser.isSet("stepsToFlush")) {
+        bool ok = false;
+        const int steps = parser.value("stepsToFlush").toInt(&ok);
+        if (!ok || steps < 1) {
+            error = "the number of steps to flush must be greater than 0.";
+            return false;
+        }
+        m_mainApp->setStepsToFlush(steps, false);
+        m_workerArgs << "-stepsToFlush" << QString::number(steps);
+    }
+    if (parser.isSet("memoryBudget")) {
+        bool ok = false;
+        const int budget = parser.value("memoryBudget").toInt(&ok);
+        if (!ok || budget < 0) {
+            error = "the memory budget must be a positive integer (or 0 for no limit).";
+            return false;
+        }
+        m_mainApp->expMgr()->setMemoryBudget(budget, false);
+    }
+    if (parser.isSet("timeSlice")) {
+        bool ok = false;
+        const int ms = parser.value("timeSlice").toInt(&ok);
+        if (!ok || ms < 0) {
+            error = "the time slice must be a positive integer (or 0 for no limit).";
+            return false;
+        }
+        m_mainApp->expMgr()->setTimeSlice(ms, false);
+        m_workerArgs << "-timeSlice" << QString::number(ms);
+    }
+    if (parser.isSet("workers")) {
+        bool ok = false;
+        m_numWorkers = parser.value("workers").toInt(&ok);
+        if (!ok || m_numWorkers < 1) {
+            error = "the number of workers must be greater than 0.";
+            return false;
+        }
+        // the threads are split among the workers, unless they are set
+        const int threads = parser.isSet("threads")
+                ? m_mainApp->expMgr()->maxThreadsCount()
+                : std::max(1, m_mainApp->expMgr()->maxThreadsCount() / m_numWorkers);
+        m_workerArgs << "-threads" << QString::number(threads);
+        // likewise, the memory budget is split among the workers
+        const int budget = m_mainApp->expMgr()->memoryBudget();
+        if (budget > 0) {
+            m_workerArgs << "-memoryBudget" << QString::number(std::max(1, budget / m_numWorkers));
+        }
+    }
+
+    // the project is not added to the list of recent projects
+    m_project = m_mainApp->newProject(error);
+    if (!m_project) {
+        return false;
+    }
+    if (isWorker) {
+        m_serverName = parser.value("worker");
+        m_workerIndex = parser.value("workerIndex").toInt();
+        m_worker = new WorkerClient(m_mainApp, m_project);
+        m_worker->setParent(this);
+        return true;
+    }
+    const QString filePath = parser.positionalArguments().first();
+    m_project->setFilePath(filePath);
+    QString importError;
+    if (m_project->importExperiments(filePath, importError) < 1) {
+        error = importError;
+        return false;
+    }
+
+    if (parser.isSet("experiments")) {
+        for (const QString& idStr : parser.value("experiments").split(",", QString::SkipEmptyParts)) {
+            bool ok = false;
+            ExperimentPtr exp = m_project->experiment(idStr.toInt(&ok));
+            if (!ok || !exp) {
+                error = QString("the experiment '%1' does not exist.").arg(idStr);
+                return false;
+            }
+            m_exps.emplace_back(exp);
+        }
+        // the points of the sweeps have no ids yet; they can't be chosen
+        for (const SweepPtr& sweep : m_project->sweeps()) {
+            QTextStream(stdout) << QString("[S%1] not chosen by -experiments; it will be skipped\n")
+                                   .arg(sweep->row());
+        }
+    } else {
+        for (auto const& it : m_project->experiments()) {
+            m_exps.emplace_back(it.second);
+        }
+        m_sweeps = m_project->sweeps();
+    }
+
+    if (m_exps.empty() && m_sweeps.empty()) {
+        error = "there are no experiments to be run.";
+        return false;
+    }
+    return true;
+}
+
+void BatchRunner::start()
+{
+    if (m_worker) {
+        QString error;
+        if (!m_worker->connectTo(m_serverName, m_workerIndex, error)) {
+            QTextStream(stderr) << error << "\n";
+            QCoreApplication::exit(InvalidArgs);
+        }
+        return;
+    }
+
+    if (m_numWorkers > 0) {
+        m_nextExpId = m_project->generateExpId();
+        m_pool = new WorkerPool(m_numWorkers, m_workerArgs,
+                                [this](WorkerPool::Job& job) { return nextJob(job); }, this);
+        connect(m_pool, SIGNAL(progressUpdated(int,int)), SLOT(workerProgress(int,int)));
+        connect(m_pool, SIGNAL(jobDone(int,bool)), SLOT(workerJobDone(int,bool)));
+        connect(m_pool, SIGNAL(finished()), SLOT(workersFinished()));
+        QString error;
+        if (!m_pool->start(error)) {
+            QTextStream(stderr) << error << "\n";
+            QCoreApplication::exit(InvalidArgs);
+        }
+        return;
+    }
+
+    QTextStream out(stdout);
+    for (const ExperimentPtr& exp : m_exps) {
+        if (exp->expStatus() == Status::Invalid) {
+            out << QString("[E%1] invalid; it will be skipped\n").arg(exp->id());
+            continue;
+        }
+        // the status changes in the workers; let's handle it in this thread
+        connect(exp.get(), SIGNAL(statusChanged(Status)), SLOT(checkStatus()), Qt::QueuedConnection);
+        m_printedProgress[exp->id()] = -1;
+    }
+    for (const SweepPtr& sweep : m_sweeps) {
+        out << QString("[S%1] %2 points\n").arg(sweep->row()).arg(sweep->size());
+        connect(sweep.get(), SIGNAL(pointDone()), SLOT(printProgress()));
+        connect(sweep.get(), SIGNAL(finished()), SLOT(checkStatus()));
+        m_printedPoints[sweep->row()] = 0;
+    }
+    out.flush();
+
+    connect(m_mainApp->expMgr(), SIGNAL(progressUpdated()),
+            SLOT(printProgress()), Qt::QueuedConnection);
+    connect(m_mainApp->expMgr(), SIGNAL(trialsWaiting(int,QString)),
+            SLOT(printWaiting(int,QString)), Qt::QueuedConnection);
+
+    for (const ExperimentPtr& exp : m_exps) {
+        if (exp->expStatus() != Status::Invalid) {
+            exp->play();
+        }
+    }
+    for (const SweepPtr& sweep : m_sweeps) {
+        sweep->play();
+    }
+    checkStatus(); // there might be nothing to be run
+}
+
+void BatchRunner::printWaiting(int expId, const QString& reason)
+{
+    QTextStream(stdout) << QString("[E%1] waiting: %2\n").arg(expId).arg(reason);
+}
+
+void BatchRunner::printProgress()
+{
+    QTextStream out(stdout);
+    for (const ExperimentPtr& exp : m_exps) {
+        auto it = m_printedProgress.find(exp->id());
+        if (it == m_printedProgress.end()) {
+            continue;
+        }
+        const int percentage = exp->progress() * 100 / 360;
+        if (percentage != it->second) {
+            it->second = percentage;
+            out << QString("[E%1] %2%\n").arg(exp->id()).arg(percentage);
+        }
+    }
+    for (const SweepPtr& sweep : m_sweeps) {
+        qint64& printed = m_printedPoints[sweep->row()];
+        if (sweep->numDone() != printed) {
+            printed = sweep->numDone();
+            out << QString("[S%1] %2/%3 points\n").arg(sweep->row()).arg(printed).arg(sweep->size());
+        }
+    }
+    out.flush();
+}
+
+void BatchRunner::checkStatus()
+{
+    if (m_done || !std::all_of(m_exps.cbegin(), m_exps.cend(),
+                               [](const ExperimentPtr& e) { return e->hasEnded(); }) ||
+            !std::all_of(m_sweeps.cbegin(), m_sweeps.cend(),
+                         [](const SweepPtr& s) { return s->isDone(); })) {
+        return;
+    }
+    m_done = true;
+
+    printProgress();
+    QTextStream out(stdout);
+    int failed = 0;
+    for (const ExperimentPtr& exp : m_exps) {
+        if (exp->expStatus() == Status::Invalid) {
+            ++failed;
+        }
+    }
+    qint64 numExps = static_cast<qint64>(m_exps.size());
+    for (const SweepPtr& sweep : m_sweeps) {
+        failed += sweep->numFailed();
+        numExps += sweep->numDone();
+    }
+    out << QString("%1 of %2 experiments finished\n").arg(numExps - failed).arg(numExps);
+    out.flush();
+
+    QCoreApplication::exit(failed ? FailedExps : Success);
+}
+
+bool BatchRunner::nextJob(WorkerPool::Job& job)
+{
+    QTextStream out(stdout);
+
+    // the workers import the experiments from their rows
+    while (m_nextJob < m_exps.size()) {
+        const ExperimentPtr& exp = m_exps.at(m_nextJob++);
+        if (exp->expStatus() == Status::Invalid) {
+            out << QString("[E%1] invalid; it will be skipped\n").arg(exp->id());
+            ++m_numJobs;
+            ++m_numFailedJobs;
+            continue;
+        }
+
+        const ExpInputs* inputs = exp->inputs();
+        const QString modelId_ = exp->modelId() + "_";
+        const QString graphId_ = exp->graphId() + "_";
+        job.expId = exp->id();
+        job.header.clear();
+        job.values.clear();
+        for (const QString& name : inputs->exportAttrNames(false)) {
+            if (name.isEmpty()) {
+                continue;
+            }
+            QString attrName = name;
+            Value v;
+            if (attrName.startsWith(modelId_)) {
+                v = inputs->model(attrName.remove(modelId_));
+            } else if (attrName.startsWith(graphId_)) {
+                v = inputs->graph(attrName.remove(graphId_));
+            } else {
+                v = inputs->general(attrName);
+            }
+            job.header.append(name);
+            job.values.append(v.toQString());
+        }
+        return true;
+    }
+
+    // then, the points of the sweeps
+    for (size_t i = m_nextJob - m_exps.size(); i < m_sweeps.size(); ++i, ++m_nextJob) {
+        if (m_sweeps.at(i)->takePoint(m_nextExpId, job.values)) {
+            job.expId = m_nextExpId++;
+            job.header = m_sweeps.at(i)->header();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::workerProgress(int expId, int percentage)
+{
+    int& printed = m_printedProgress[expId];
+    if (percentage != printed) {
+        printed = percentage;
+        QTextStream(stdout) << QString("[E%1] %2%\n").arg(expId).arg(percentage);
+    }
+}
+
+void BatchRunner::workerJobDone(int expId, bool ok)
+{
+    ++m_numJobs;
+    if (!ok) {
+        ++m_numFailedJobs;
+    }
+    m_printedProgress.erase(expId);
+    QTextStream(stdout) << QString("[E%1] %2\n").arg(expId).arg(ok ? "finished" : "failed");
+}
+
+void BatchRunner::workersFinished()
+{
+    QTextStream(stdout) << QString("%1 of %2 experiments finished\n")
+                           .arg(m_numJobs - m_numFailedJobs).arg(m_numJobs);
+    QCoreApplication::exit(m_numFailedJobs ? FailedExps : Success);
+}
+
+} // evoplex
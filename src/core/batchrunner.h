@@ -0,0 +1,112 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QStringList>
+
+#include "mainapp.h"
+#include "sweep.h"
+#include "workerpool.h"
+
+namespace evoplex {
+
+/**
+ * @brief Runs the experiments of a project without the GUI.
+ *
+ * Usage: evoplex -no-gui [options] project.csv
+ *
+ * It imports the experiments of the project, runs the chosen ones through
+ * the ExperimentsMgr and prints their progress to stdout. The sweeps of the
+ * project are also run, unless some experiments are chosen; then, they are
+ * reported as skipped. Once all of them are done, the application exits
+ * with one of the ExitCode values.
+ *
+ * With '-workers N', the experiments are run by N worker processes instead;
+ * see WorkerPool. Each worker is started with '-worker <server>'.
+ *
+ * With '-memoryBudget MB', the trials only start while their estimated
+ * memory fits in the budget; see ExperimentsMgr::setMemoryBudget().
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        Success = 0,       // all experiments have finished
+        InvalidArgs = 1,   // nothing was run
+        FailedExps = 2     // some experiments are invalid
+    };
+
+    explicit BatchRunner(MainApp* mainApp);
+
+    // Parses the command line and imports the project.
+    // Returns false if something is not valid.
+    bool init(const QStringList& args, QString& error);
+
+public slots:
+    // Plays the experiments. It must be called from the event loop,
+    // which is exited once all experiments are done.
+    void start();
+
+private slots:
+    // prints the progress of the experiments and sweeps which have changed
+    void printProgress();
+    // exits the event loop once all experiments are done
+    void checkStatus();
+    // tells why the trials of an experiment have not started yet
+    void printWaiting(int expId, const QString& reason);
+
+    // the experiments run by the workers
+    void workerProgress(int expId, int percentage);
+    void workerJobDone(int expId, bool ok);
+    void workersFinished();
+
+private:
+    MainApp* m_mainApp;
+    ProjectPtr m_project;
+    std::vector<ExperimentPtr> m_exps;
+    std::vector<SweepPtr> m_sweeps;
+    std::map<int, int> m_printedProgress; // <expId, percentage>
+    std::map<int, qint64> m_printedPoints; // <sweep row, points done>
+    bool m_done;
+
+    // coordinator mode: the number of worker processes (0 if disabled)
+    int m_numWorkers;
+    QStringList m_workerArgs;
+    WorkerPool* m_pool;
+    size_t m_nextJob; // the next experiment (or sweep) to hand out
+    int m_nextExpId;  // the id of the next point of a sweep
+    int m_numJobs;
+    int m_numFailedJobs;
+
+    // worker mode: the pool we take the experiments from
+    WorkerClient* m_worker;
+    QString m_serverName;
+    int m_workerIndex;
+
+    // gives the next row to be run by a worker
+    bool nextJob(WorkerPool::Job& job);
+};
+
+} // evoplex
+#endif // BATCH_RUNNER_H
@@ -14,48 +14,100 @@
  * limitations under the License.
  */
 
+#include <QtGlobal>
+#include <new>
+
 #include "include/edge.h"
 #include "edge_p.h"
 
 namespace evoplex {
 
 BaseEdge::BaseEdge(const constructor_key&, int id, const Node& origin,
-                   const Node& neighbour, Attributes* attrs, bool ownsAttrs)
+                   const Node& neighbour, Attributes attrs)
     : m_id(id),
-      m_origin(origin),
-      m_neighbour(neighbour),
-      m_attrs(attrs),
-      m_ownsAttrs(ownsAttrs)
+      m_origin(origin.m_ptr.get()),
+      m_neighbour(neighbour.m_ptr.get()),
+      m_attrs(std::move(attrs))
+{
+}
+
+/*******************************************************/
+/*******************************************************/
+
+EdgeArena::~EdgeArena()
 {
+    Q_ASSERT_X(m_size == 0, "~EdgeArena", "all edges must be destroyed first");
 }
 
-BaseEdge::~BaseEdge()
+BaseEdge* EdgeArena::create(int id, const Node& origin, const Node& neighbour, Attributes attrs)
 {
-    if (m_ownsAttrs) {
-        delete m_attrs;
+    void* mem;
+    if (!m_free.empty()) {
+        mem = m_free.back();
+        m_free.pop_back();
+    } else {
+        if (m_top == capacity()) {
+            m_blocks.emplace_back(new Storage[kBlockSize]);
+        }
+        mem = &m_blocks[m_top / kBlockSize][m_top % kBlockSize];
+        ++m_top;
     }
+    ++m_size;
+    return new (mem) BaseEdge(BaseEdge::constructor_key(), id, origin, neighbour, std::move(attrs));
 }
 
+void EdgeArena::destroy(BaseEdge* edge)
+{
+    edge->~BaseEdge();
+    m_free.emplace_back(edge);
+    --m_size;
+}
+
+void EdgeArena::release()
+{
+    Q_ASSERT_X(m_size == 0, "EdgeArena", "all edges must be destroyed first");
+    m_blocks.clear();
+    std::vector<BaseEdge*>().swap(m_free);
+    m_top = 0;
+}
+
+void EdgeArena::reserve(size_t numEdges)
+{
+    if (numEdges <= m_size) {
+        return;
+    }
+    m_blocks.reserve((numEdges + kBlockSize - 1) / kBlockSize);
+    while (capacity() - m_top + m_free.size() < numEdges - m_size) {
+        m_blocks.emplace_back(new Storage[kBlockSize]);
+    }
+}
+
+/*******************************************************/
+/*******************************************************/
+
 Edge::Edge()
-    : m_ptr(nullptr)
+    : m_ptr(nullptr),
+      m_reversed(false)
 {}
 
-Edge::Edge(EdgePtr edge)
-    : m_ptr(edge)
+Edge::Edge(BaseEdge* edge, bool reversed)
+    : m_ptr(edge),
+      m_reversed(reversed)
 {}
 
 Edge::Edge(const std::pair<const int, Edge>& p)
-    : m_ptr(p.second.m_ptr)
+    : m_ptr(p.second.m_ptr),
+      m_reversed(p.second.m_reversed)
 {}
 
 int Edge::id() const
 { return m_ptr->id(); }
 
-const Node& Edge::origin() const
-{ return m_ptr->origin(); }
+Node Edge::origin() const
+{ return m_reversed ? m_ptr->neighbour() : m_ptr->origin(); }
 
-const Node& Edge::neighbour() const
-{ return m_ptr->neighbour(); }
+Node Edge::neighbour() const
+{ return m_reversed ? m_ptr->origin() : m_ptr->neighbour(); }
 
 const Attributes* Edge::attrs() const
 { return m_ptr->attrs(); }
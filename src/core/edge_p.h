@@ -18,33 +18,33 @@
 #define EDGE_P_H
 
 #include <memory>
-#include <unordered_map>
+#include <type_traits>
+#include <vector>
 
 #include "attributes.h"
+#include "include/node.h"
 
 namespace evoplex {
 
-class Node;
-class BaseEdge;
-using EdgePtr = std::shared_ptr<BaseEdge>;
-
 /**
- * @brief An Edge connects a node to itself or to another node.
+ * @brief The record of an Edge connecting a node to itself or to another node.
+ * It is shared by both directions of the edge, i.e., the outgoing Edge
+ * of the origin and the incoming Edge of the neighbour.
  * @attention An edge can only be created by an AbstractGraph derived object.
  */
 class BaseEdge
 {
     friend class AbstractGraph;
+    friend class EdgeArena;
     friend class TestEdge;
+    friend class TestAdjacency;
 
 private:
     struct constructor_key { /* this is a private key accessible only to friends */ };
 
 public:
     explicit BaseEdge(const constructor_key&, int id, const Node& origin,
-        const Node& neighbour, Attributes* attrs=new Attributes(), bool ownsAttrs=true);
-
-    ~BaseEdge();
+        const Node& neighbour, Attributes attrs=Attributes());
 
     /**
      * @brief Gets the edge's attributes.
@@ -65,19 +65,81 @@ public:
     inline int id() const;
     /**
      * @brief Gets the source Node.
+     * @note The returned Node does not own the node, which lives as long
+     * as it belongs to the graph (an edge never outlives its nodes).
      */
-    inline const Node& origin() const;
+    inline Node origin() const;
     /**
      * @brief Gets the target Node.
+     * @note The returned Node does not own the node, which lives as long
+     * as it belongs to the graph (an edge never outlives its nodes).
      */
-    inline const Node& neighbour() const;
+    inline Node neighbour() const;
 
 private:
     const int m_id;
-    const Node& m_origin;
-    const Node& m_neighbour;
-    Attributes* m_attrs;
-    const bool m_ownsAttrs;
+    // not owned; the nodes remove their edges before being destroyed
+    BaseNode* const m_origin;
+    BaseNode* const m_neighbour;
+    Attributes m_attrs;
+};
+
+/**
+ * @brief A pool of BaseEdge records owned by a graph.
+ * The records are allocated in contiguous blocks, so creating an edge
+ * does not touch the heap (but for its attributes) and the address of
+ * a record never changes. Destroyed records are reused by the next edges.
+ */
+class EdgeArena
+{
+public:
+    //! Number of records in each block.
+    static constexpr size_t kBlockSize = 4096;
+
+    EdgeArena() : m_size(0), m_top(0) {}
+    //! Destructor. All records must have been destroyed.
+    ~EdgeArena();
+
+    EdgeArena(const EdgeArena&) = delete;
+    EdgeArena& operator=(const EdgeArena&) = delete;
+
+    /**
+     * @brief Constructs a record in the pool.
+     */
+    BaseEdge* create(int id, const Node& origin, const Node& neighbour, Attributes attrs);
+
+    /**
+     * @brief Destroys a record created by this pool.
+     */
+    void destroy(BaseEdge* edge);
+
+    /**
+     * @brief Frees all blocks.
+     * @warning All records must have been destroyed.
+     */
+    void release();
+
+    /**
+     * @brief Allocates enough blocks to hold @p numEdges records.
+     */
+    void reserve(size_t numEdges);
+
+    /**
+     * @brief Gets the number of live records.
+     */
+    inline size_t size() const { return m_size; }
+    /**
+     * @brief Gets the number of records that fit in the allocated blocks.
+     */
+    inline size_t capacity() const { return m_blocks.size() * kBlockSize; }
+
+private:
+    using Storage = typename std::aligned_storage<sizeof(BaseEdge), alignof(BaseEdge)>::type;
+
+    std::vector<std::unique_ptr<Storage[]>> m_blocks;
+    std::vector<BaseEdge*> m_free; // destroyed records
+    size_t m_size;
+    size_t m_top; // records ever taken from the blocks
 };
 
 /************************************************************************
@@ -87,26 +149,26 @@ private:
 inline int BaseEdge::id() const
 { return m_id; }
 
-inline const Node& BaseEdge::origin() const
-{ return m_origin; }
+inline Node BaseEdge::origin() const
+{ return Node(NodePtr(NodePtr(), m_origin)); }
 
-inline const Node& BaseEdge::neighbour() const
-{ return m_neighbour; }
+inline Node BaseEdge::neighbour() const
+{ return Node(NodePtr(NodePtr(), m_neighbour)); }
 
 inline const Attributes* BaseEdge::attrs() const
-{ return m_attrs; }
+{ return &m_attrs; }
 
 inline const Value& BaseEdge::attr(int id) const
-{ return m_attrs->value(id); }
+{ return m_attrs.value(id); }
 
 inline Value BaseEdge::attr(const QString& name, Value defaultValue) const
-{ return m_attrs->value(name, defaultValue); }
+{ return m_attrs.value(name, defaultValue); }
 
 inline void BaseEdge::setAttr(int id, const Value& value)
-{ m_attrs->setValue(id, value); }
+{ m_attrs.setValue(id, value); }
 
 inline void BaseEdge::addAttr(QString name, Value value)
-{ m_attrs->push_back(name, value); }
+{ m_attrs.push_back(name, value); }
 
 } // evoplex
-#endif // EDGE_H
+#endif // EDGE_P_H
@@ -0,0 +1,68 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "abstractgraph.h"
+#include "edgebuilder.h"
+
+namespace evoplex {
+
+EdgeBuilder::EdgeBuilder(AbstractGraph* graph, int numBuffers)
+    : m_graph(graph)
+{
+    Q_ASSERT_X(m_graph, "EdgeBuilder", "the graph must be valid");
+    if (numBuffers < 1) {
+        numBuffers = std::max(1, QThread::idealThreadCount());
+    }
+    m_buffers.resize(static_cast<size_t>(numBuffers));
+}
+
+void EdgeBuilder::reserve(int numEdges)
+{
+    const size_t perBuffer = (static_cast<size_t>(std::max(0, numEdges))
+                              + m_buffers.size() - 1) / m_buffers.size();
+    for (EdgeBuffer& b : m_buffers) {
+        b.reserve(perBuffer);
+    }
+}
+
+void EdgeBuilder::run(const Task& task)
+{
+    const int numChunks = numBuffers();
+    if (numChunks == 1) {
+        task(0, 1, m_buffers.front());
+        return;
+    }
+
+    std::vector<int> chunks(m_buffers.size());
+    for (int i = 0; i < numChunks; ++i) {
+        chunks[static_cast<size_t>(i)] = i;
+    }
+    QtConcurrent::blockingMap(chunks, [this, &task, numChunks](int chunk) {
+        task(chunk, numChunks, m_buffers[static_cast<size_t>(chunk)]);
+    });
+}
+
+bool EdgeBuilder::commit()
+{
+    return m_graph->commitEdges(m_buffers);
+}
+
+} // evoplex
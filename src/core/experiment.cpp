@@ -15,11 +15,18 @@
  */
 
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
 
+#include "edge_p.h"
 #include "experiment.h"
+#include "node_p.h"
 #include "nodes.h"
 #include "nodes_p.h"
 #include "project.h"
+#include "sweep.h"
 #include "trial.h"
 #include "utils.h"
 
@@ -32,14 +39,22 @@ Experiment::Experiment(MainApp* mainApp, const int id, ProjectWPtr project)
       m_inputs(nullptr),
       m_graphType(GraphType::Invalid),
       m_numTrials(0),
+      m_forkAt(0),
       m_autoDeleteTrials(true),
       m_stopAt(-1),
       m_pauseAt(-1),
       m_progress(0),
+      m_stepsDone(0),
+      m_trialFootprint(0),
       m_delay(0),
-      m_expStatus(Status::Invalid)
+      m_expStatus(Status::Invalid),
+      m_resumeTrials(false),
+      m_pendingForks(0),
+      m_forked(false)
 {
     Q_ASSERT_X(project.lock(), "Experiment", "an experiment must belong to a valid project");
+    connect(this, SIGNAL(progressUpdated(quint16)),
+            m_mainApp->expMgr(), SIGNAL(progressUpdated()));
 }
 
 Experiment::~Experiment()
@@ -67,6 +82,10 @@ void Experiment::deleteTrials()
     }
     m_trials.clear();
     m_clonableNodes.clear();
+    m_sharedTopology.reset();
+    m_forkPoint.reset();
+    m_pendingForks = 0;
+    m_forked = false;
 }
 
 bool Experiment::setInputs(ExpInputsPtr inputs, QString& error)
@@ -80,6 +99,10 @@ bool Experiment::setInputs(ExpInputsPtr inputs, QString& error)
     Q_ASSERT(inputs.get() != m_inputs);
     delete m_inputs;
     m_inputs = inputs.release();
+    // the new inputs may not match the other points of the sweep
+    m_sweepCache.reset();
+    m_sweepKey.clear();
+    m_trialFootprint = 0;
 
     // a few asserts for critical things that should never happen!
     Q_ASSERT_X(this == m_project.lock()->experiment(m_id).get(),
@@ -105,6 +128,23 @@ bool Experiment::setInputs(ExpInputsPtr inputs, QString& error)
     setStopAt(m_inputs->general(GENERAL_ATTR_STOPAT).toInt());
     setPauseAt(m_stopAt);
 
+    QString stopError;
+    m_stopCondition = StopCondition::parse(m_inputs->general(GENERAL_ATTR_STOPWHEN).toQString(), stopError);
+    if (!stopError.isEmpty()) {
+        error += stopError + "\n";
+        m_expStatus = Status::Invalid;
+    } else if (m_stopCondition.type() != StopCondition::Type::None &&
+               m_inputs->fileCaches().empty()) {
+        error += "the stop condition is evaluated on the outputs; please, add some!\n";
+        m_expStatus = Status::Invalid;
+    }
+
+    m_forkAt = m_inputs->general(GENERAL_ATTR_FORKAT).toInt();
+    if (m_forkAt < 0 || m_forkAt >= m_stopAt) {
+        error += QString("the trials must be forked before the last step (%1)!\n").arg(m_stopAt);
+        m_expStatus = Status::Invalid;
+    }
+
     if (!error.isEmpty()) {
         qWarning() << error;
     }
@@ -133,11 +173,22 @@ bool Experiment::disable(QString* error)
     m_filePathPrefix.clear();
     m_fileHeader.clear();
     m_expStatus = Status::Disabled;
+    m_stepsDone = 0;
     setProgress(0);
     return true;
 }
 
 bool Experiment::reset(QString* error)
+{
+    return createTrials(error, false);
+}
+
+bool Experiment::resume(QString* error)
+{
+    return createTrials(error, true);
+}
+
+bool Experiment::createTrials(QString* error, bool resume)
 {
     QMutexLocker locker(&m_mutex);
 
@@ -159,12 +210,23 @@ bool Experiment::reset(QString* error)
     }
 
     m_stopAt = m_inputs->general(GENERAL_ATTR_STOPAT).toInt();
+    m_stepsDone = 0;
     setProgress(0);
 
     for (auto const& o : m_outputs) {
         o->flushAll();
     }
 
+    m_resumeTrials = resume;
+    if (!resume) {
+        for (quint16 trialId = 0; trialId < m_numTrials; ++trialId) {
+            const QString path = checkpointPath(trialId);
+            if (!path.isEmpty()) {
+                QFile::remove(path);
+            }
+        }
+    }
+
     deleteTrials();
     m_trials.reserve(static_cast<size_t>(m_numTrials));
     for (quint16 trialId = 0; trialId < m_numTrials; ++trialId) {
@@ -208,6 +270,36 @@ void Experiment::enable(QString& error)
     m_fileHeader += "\n";
 }
 
+QString Experiment::checkpointPath(quint16 trialId) const
+{
+    if (m_filePathPrefix.isEmpty()) {
+        return QString();
+    }
+    return m_filePathPrefix + QString("%1.ckpt").arg(trialId);
+}
+
+void Experiment::writeStopSteps() const
+{
+    if (m_stopCondition.type() == StopCondition::Type::None || m_filePathPrefix.isEmpty()) {
+        return;
+    }
+
+    const QString fpath = m_filePathPrefix + "stops.csv";
+    QFile file(fpath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "unable to write the last step of the trials in" << fpath;
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream << "trial,stopStep,converged\n";
+    for (quint16 trialId = 0; trialId < m_numTrials; ++trialId) {
+        const Trial* trial = m_trials.at(trialId);
+        stream << trialId << "," << trial->step() << "," << (trial->converged() ? 1 : 0) << "\n";
+    }
+    file.close();
+}
+
 const Trial* Experiment::trial(quint16 trialId) const
 {
     auto it = m_trials.find(trialId);
@@ -216,22 +308,28 @@ const Trial* Experiment::trial(quint16 trialId) const
     return it->second;
 }
 
-void Experiment::updateProgressValue()
+void Experiment::stepDone(int numSteps)
 {
-    if (m_expStatus != Status::Running) {
-        return;
+    const qint64 done = m_stepsDone.fetch_add(numSteps, std::memory_order_relaxed) + numSteps;
+    const qint64 total = static_cast<qint64>(m_stopAt) * m_numTrials;
+    if (total <= 0) {
+        return; // it is being stopped
     }
 
-    float p = 0.f;
-    for (auto const& t : m_trials) {
-        p += (static_cast<float>(t.second->step()) / m_stopAt);
-    }
-    auto newProg = static_cast<quint16>(std::ceil(p * 360.f / m_numTrials));
-    if (newProg != m_progress) {
-        setProgress(newProg);
+    const auto p = static_cast<quint16>(std::min<qint64>(360, (done * 360 + total - 1) / total));
+    // most steps do not change the integer progress; no need to write it then
+    if (p != m_progress.load(std::memory_order_relaxed)) {
+        setProgress(p);
     }
 }
 
+bool Experiment::waitsForFork(const Trial* trial) const
+{
+    // a stopped experiment does not run the burn-in; see stop()
+    return m_forkAt > 0 && !m_forked && trial->id() != 0 &&
+            trial->status() == Status::Disabled && m_stopAt > m_forkAt;
+}
+
 void Experiment::trialFinished(Trial* trial)
 {
     QMutexLocker locker(&m_mutex);
@@ -266,6 +364,7 @@ void Experiment::expFinished()
 
     if (allTrialsFinished) {
         m_expStatus = Status::Finished;
+        writeStopSteps();
         if (m_autoDeleteTrials) {
             locker.unlock();
             disable(); // sets to Status::Disabled
@@ -275,7 +374,6 @@ void Experiment::expFinished()
         // reset the stopAt flag to maximum
         setStopAt(m_inputs->general(GENERAL_ATTR_STOPAT).toInt());
     } else { // all or some trials are paused
-        updateProgressValue();
         m_expStatus = Status::Paused; // exp is still good for another step
     }
     setPauseAt(m_stopAt); // reset the pauseAt flag to maximum
@@ -293,6 +391,20 @@ void Experiment::toggle()
     }
 }
 
+void Experiment::pause()
+{
+    m_pauseAt = -1;
+    m_mainApp->expMgr()->flushDelayedTrials(this);
+}
+
+void Experiment::stop()
+{
+    m_stopAt = 0;
+    m_pauseAt = 0;
+    m_mainApp->expMgr()->flushDelayedTrials(this);
+    play();
+}
+
 void Experiment::play()
 {
     m_mainApp->expMgr()->play(shared_from_this());
@@ -332,6 +444,14 @@ Nodes Experiment::cloneCachedNodes(const int trialId)
     return nodes;
 }
 
+TopologyPtr Experiment::sharedTopology() const
+{
+    if (!m_sharedTopology && m_sweepCache) {
+        return m_sweepCache->topology(m_sweepKey);
+    }
+    return m_sharedTopology;
+}
+
 AttrsGeneratorPtr Experiment::edgeAttrsGen(bool& ok) const
 {
     ok = true;
@@ -352,6 +472,14 @@ AttrsGeneratorPtr Experiment::edgeAttrsGen(bool& ok) const
 
 Nodes Experiment::createNodes() const
 {
+    // the points of a sweep with the same graph inputs start from the same nodes
+    if (m_sweepCache) {
+        Nodes nodes = m_sweepCache->nodes(m_sweepKey);
+        if (!nodes.empty()) {
+            return nodes;
+        }
+    }
+
     const QString& cmd = m_inputs->general(GENERAL_ATTR_NODES).toQString();
 
     QString error;
@@ -367,6 +495,52 @@ Nodes Experiment::createNodes() const
     return nodes;
 }
 
+qint64 Experiment::trialFootprint()
+{
+    if (m_trialFootprint > 0) {
+        return m_trialFootprint;
+    }
+
+    // the number of nodes, without creating them
+    const QString& cmd = m_inputs->general(GENERAL_ATTR_NODES).toQString();
+    const AttributesScope& nodeScope = modelPlugin()->nodeAttrsScope();
+    qint64 numNodes = 0;
+    if (QFileInfo::exists(cmd)) {
+        // one node per line; the first lines tell how long the lines are
+        QFile file(cmd);
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            const QByteArray head = file.read(1 << 16);
+            const qint64 lines = std::max(1, head.count('\n'));
+            numNodes = file.size() * lines / std::max(1, head.size());
+        }
+    } else {
+        QString error;
+        auto ag = AttrsGenerator::parse(nodeScope, cmd, error);
+        numNodes = ag ? ag->size() : 0;
+    }
+
+    // the graphs of the models usually have a handful of edges per node,
+    // e.g., square lattices and small-world networks
+    const int kEdgesPerNode = 4;
+    const qint64 numEdges = numNodes * kEdgesPerNode;
+
+    const qint64 nodeBytes = 2 * sizeof(void*) // the shared_ptr's control block
+            + (m_graphType == GraphType::Directed ? sizeof(DNode) : sizeof(UNode))
+            + sizeof(std::pair<const int, Node>)
+            + nodeScope.size() * sizeof(Value);
+    // the record, its entries in the edges of the graph and of its nodes,
+    // and its entry in the pairs' index
+    const qint64 edgeBytes = sizeof(BaseEdge)
+            + 3 * sizeof(std::pair<const int, Edge>)
+            + sizeof(std::pair<const quint64, int>) + 3 * sizeof(void*)
+            + modelPlugin()->edgeAttrsScope().size() * sizeof(Value);
+
+    const qint64 bytes = std::max<qint64>(1, numNodes * nodeBytes + numEdges * edgeBytes);
+    qint64 expected = 0;
+    m_trialFootprint.compare_exchange_strong(expected, bytes);
+    return m_trialFootprint;
+}
+
 bool Experiment::removeOutput(const OutputPtr& output)
 {
     if (m_expStatus != Status::Paused) {
@@ -408,7 +582,7 @@ void Experiment::setExpStatus(Status s)
 
 void Experiment::setProgress(quint16 p)
 {
-    m_progress = p;
+    m_progress.store(p, std::memory_order_relaxed);
     emit (progressUpdated(p));
 }
 
@@ -17,11 +17,13 @@
 #ifndef EXPERIMENT_H
 #define EXPERIMENT_H
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <QByteArray>
 #include <QMutex>
 
 #include "attrsgenerator.h"
@@ -32,12 +34,16 @@
 #include "mainapp.h"
 #include "output.h"
 #include "graphplugin.h"
+#include "lattice.h"
 #include "modelplugin.h"
+#include "stopcondition.h"
+#include "topology_p.h"
 
 namespace evoplex {
 
 
 class Experiment;
+class SweepCache;
 class Trial;
 
 using ExperimentPtr = std::shared_ptr<Experiment>;
@@ -52,6 +58,7 @@ class Experiment : public QObject, public std::enable_shared_from_this<Experimen
 
     friend class ExperimentsMgr;
     friend class Project;
+    friend class Sweep;
     friend class Trial;
 
 public:
@@ -73,8 +80,13 @@ public:
     // disable it and set the status to Invalid.
     void invalidate();
 
+    // It creates the trials from scratch and removes their checkpoints.
     bool reset(QString*error=nullptr);
 
+    // Same as reset(), but the trials resume from their latest
+    // checkpoints, if any.
+    bool resume(QString* error=nullptr);
+
     // create a set of nodes for the current inputs
     Nodes createNodes() const;
 
@@ -103,7 +115,10 @@ public:
     inline int id() const;
     inline ProjectPtr project() const;
     inline int numTrials() const;
+    inline int forkAt() const;
+    inline const StopCondition& stopCondition() const;
     inline Status expStatus() const;
+    inline bool hasEnded() const;
     inline quint16 progress() const;
     inline const ExpInputs* inputs() const;
     inline const QString& modelId() const;
@@ -121,12 +136,13 @@ public slots:
     void playNext();
 
     // pause all trials asap
-    inline void pause();
+    // the trials waiting for the delay are paused straight away
+    void pause();
 
     // stop all trials asap
     // It sets stopAt and playAt to 0 and makes sure that all trials are
     // triggred once to make them turn from Disabled (-1) to Finished (0)
-    inline void stop();
+    void stop();
 
 signals:
     void trialCreated(int trialId);
@@ -134,11 +150,6 @@ signals:
     void progressUpdated(quint16);
     void statusChanged(Status);
 
-private slots:
-    // Updates the progress value.
-    // This method might be expensive!
-    void updateProgressValue();
-
 private:
     QMutex m_mutex;
     MainApp* m_mainApp;
@@ -148,27 +159,60 @@ private:
     const ExpInputs* m_inputs;
     GraphType m_graphType;
     int m_numTrials;
+    int m_forkAt; // 0 if the trials are not forked
     bool m_autoDeleteTrials;
     int m_stopAt;
+    StopCondition m_stopCondition; // the trials may stop before 'm_stopAt'
 
     QString m_fileHeader;   // file header is the same for all trials; let's save it then
     QString m_filePathPrefix;
     std::unordered_set<OutputPtr> m_outputs;
 
     int m_pauseAt;
-    quint16 m_progress; // current progress value [0, 360]
+    std::atomic<quint16> m_progress; // current progress value [0, 360]
+    std::atomic<qint64> m_stepsDone; // steps run by all trials since the last reset
+    std::atomic<qint64> m_trialFootprint; // bytes; 0 if not estimated yet
     quint16 m_delay;
     Status m_expStatus;
 
     Trials m_trials;
+    bool m_resumeTrials; // the trials look for a checkpoint when they start
 
     // The trials are meant to have the same initial population.
     // So, considering that it might be a very expensive operation (eg, I/O),
     // we try to do the heavy stuff only once, storing the initial population
     // in the 'm_clonableNodes' container. Except when the experiment has only
-    // one trial.
+    // one trial. The nodes' attributes are stored in a table whose columns are
+    // shared (copy-on-write) by the trials' clones.
     Nodes m_clonableNodes;
 
+    // Likewise, deterministic graphs build the same edges for all trials.
+    // The first trial takes a read-only snapshot of its edges, which is
+    // shared (copy-on-write) by the graphs of the other trials.
+    TopologyPtr m_sharedTopology;
+
+    // The points of a sweep which only differ in the model's attributes
+    // also share the nodes and topology above; see Sweep.
+    std::shared_ptr<SweepCache> m_sweepCache;
+    QString m_sweepKey;
+
+    // The state of trial 0 at step 'm_forkAt', from which the other trials
+    // start. The nodes' table and the topology are shared (copy-on-write)
+    // by the forked graphs; the lattice is rebuilt as it is cheaper.
+    struct ForkPoint
+    {
+        int step;
+        Nodes nodes;
+        TopologyPtr topology;
+        std::unique_ptr<const Lattice> lattice;
+        QByteArray modelState;
+    };
+    std::unique_ptr<ForkPoint> m_forkPoint;
+    int m_pendingForks; // the forked trials which have not taken 'm_forkPoint' yet
+    // trial 0 has gone past 'm_forkAt'; the forked trials can start.
+    // If 'm_forkPoint' is null, they start from scratch instead.
+    std::atomic<bool> m_forked;
+
     // Parse the edge attrs command and return an AttrsGenerator
     AttrsGeneratorPtr edgeAttrsGen(bool& ok) const;
 
@@ -177,8 +221,28 @@ private:
     // This method is NOT thread-safe.
     Nodes cloneCachedNodes(const int trialId);
 
+    // the topology shared by the trials (or by the points of the sweep)
+    // it is null if the edges must be built
+    TopologyPtr sharedTopology() const;
+
+    // The memory (in bytes) a trial is expected to take, estimated from
+    // the number of nodes and the attributes' schema; see ExperimentsMgr.
+    // The edges are assumed to be a few per node until trial 0 has been
+    // set up and measured (Trial::init).
+    qint64 trialFootprint();
+
     void deleteTrials();
 
+    // creates the trials; see reset() and resume()
+    bool createTrials(QString* error, bool resume);
+
+    // the file holding the latest checkpoint of a trial
+    // it is empty if the experiment has no output directory
+    QString checkpointPath(quint16 trialId) const;
+
+    // true if the trial must not be queued until trial 0 reaches 'm_forkAt'
+    bool waitsForFork(const Trial* trial) const;
+
     // trigged when a Trial ends
     // also runs in a work thread
     void trialFinished(Trial *trial);
@@ -196,6 +260,14 @@ private:
 
     // set progress value and emit progressUpdated()
     void setProgress(quint16 p);
+
+    // counts the steps of a trial and publishes the progress if it has changed
+    // it is lock-free and runs in a work thread
+    void stepDone(int numSteps = 1);
+
+    // writes the last step of each trial to '<prefix>stops.csv'
+    // it is only done if the trials may stop earlier
+    void writeStopSteps() const;
 };
 
 /************************************************************************
@@ -208,18 +280,12 @@ inline bool Experiment::hasOutputs() const
 inline void Experiment::addOutput(OutputPtr output)
 { m_outputs.insert(output); }
 
-inline void Experiment::pause()
-{ m_pauseAt = -1; }
-
 inline int Experiment::pauseAt() const
 { return m_pauseAt; }
 
 inline void Experiment::setPauseAt(int step)
 { m_pauseAt = step > m_stopAt ? m_stopAt : step; }
 
-inline void Experiment::stop()
-{ m_stopAt = 0; m_pauseAt = 0; play(); }
-
 inline int Experiment::stopAt() const
 { return m_stopAt; }
 
@@ -250,11 +316,25 @@ inline ProjectPtr Experiment::project() const
 inline int Experiment::numTrials() const
 { return m_numTrials; }
 
+inline int Experiment::forkAt() const
+{ return m_forkAt; }
+
+inline const StopCondition& Experiment::stopCondition() const
+{ return m_stopCondition; }
+
 inline Status Experiment::expStatus() const
 { return m_expStatus; }
 
+inline bool Experiment::hasEnded() const
+{
+    // a finished experiment whose trials are auto-deleted is disabled;
+    // unlike one which has not started yet, it keeps the full progress
+    return m_expStatus == Status::Finished || m_expStatus == Status::Invalid ||
+            (m_expStatus == Status::Disabled && progress() == 360);
+}
+
 inline quint16 Experiment::progress() const
-{ return m_progress; }
+{ return m_progress.load(std::memory_order_relaxed); }
 
 inline const ExpInputs* Experiment::inputs() const
 { return m_inputs; }
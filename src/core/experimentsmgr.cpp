@@ -25,47 +25,42 @@
 namespace evoplex {
 
 ExperimentsMgr::ExperimentsMgr()
-    : m_lastThreadPriority(INT32_MAX),
-      m_timerProgress(new QTimer(this))
+    : m_memoryReserved(0)
 {
     resetSettingsToDefault();
 
     m_threads = m_userPrefs.value("settings/threads", m_threads).toInt();
     m_threads = m_threads > QThread::idealThreadCount() ? QThread::idealThreadCount() : m_threads;
+    m_memoryBudget = m_userPrefs.value("settings/memoryBudget", m_memoryBudget.load()).toInt();
+    m_timeSlice = m_userPrefs.value("settings/timeSlice", m_timeSlice.load()).toInt();
     m_threadPool.setMaxThreadCount(m_threads);
+    m_scheduler.reset(new TrialScheduler(&m_threadPool, m_threads,
+                                         [this](Trial* trial) { runTrial(trial); },
+                                         [this](Trial* trial, bool force) { return admitTrial(trial, force); }));
     qDebug() << "setting the max number of threads to" << m_threads;
 
-    m_timerProgress->setSingleShot(true);
-    connect(m_timerProgress, SIGNAL(timeout()), SLOT(updateProgressValues()));
+    m_clock.start();
+    m_delayTimer.setSingleShot(true);
+    connect(&m_delayTimer, SIGNAL(timeout()), SLOT(queueDelayedTrials()));
+    connect(this, SIGNAL(trialDelayed()), SLOT(queueDelayedTrials()), Qt::QueuedConnection);
 }
 
 ExperimentsMgr::~ExperimentsMgr()
 {
-    m_threadPool.clear();
-    m_threadPool.waitForDone();
-    delete m_timerProgress;
+    m_delayTimer.stop();
+    m_scheduler.reset(); // drops the queued trials and waits for the running ones
 }
 
 void ExperimentsMgr::resetSettingsToDefault()
 {
     m_threads = QThread::idealThreadCount();
-}
-
-void ExperimentsMgr::updateProgressValues()
-{
-    if (!m_running.empty()) {
-        for (auto const& exp : m_running) {
-            exp->updateProgressValue();
-        }
-        m_timerProgress->start(500);
-        emit (progressUpdated());
-    }
+    m_memoryBudget = 0;
+    m_timeSlice = 0;
 }
 
 void ExperimentsMgr::play(ExperimentPtr exp)
 {
     QtConcurrent::run(this, &ExperimentsMgr::_play, exp);
-    m_timerProgress->start(500); // every half a second, check progress
 }
 
 void ExperimentsMgr::_play(ExperimentPtr exp)
@@ -78,7 +73,7 @@ void ExperimentsMgr::_play(ExperimentPtr exp)
         return;
     }
 
-    if (exp->expStatus() == Status::Disabled && !exp->reset()) {
+    if (exp->expStatus() == Status::Disabled && !exp->resume()) {
         return; // something went wrong while initializing the experimnt
     }
 
@@ -90,102 +85,265 @@ void ExperimentsMgr::_play(ExperimentPtr exp)
     }
 
     // iterate by id to maintain id order
+    std::vector<Trial*> trials;
+    trials.reserve(exp->trials().size());
     for (quint16 id = 0; id < exp->trials().size(); ++id) {
         Trial* trial = exp->trials().at(id);
         if (trial->status() != Status::Disabled) {
             trial->m_status = Status::Queued;
         }
-        m_queuedTrials.emplace_back(trial);
+        // the forked trials are queued by trial 0; see playForks()
+        if (!exp->waitsForFork(trial)) {
+            trials.emplace_back(trial);
+        }
     }
+    m_pendingTrials[exp.get()] += static_cast<int>(trials.size());
 
     locker.unlock();
-    processQueue();
+    m_scheduler->enqueue(trials);
 }
 
-void ExperimentsMgr::trialFinished(Trial* trial)
+void ExperimentsMgr::requeueTrial(Trial* trial, int delay)
 {
-    QMutexLocker locker(&m_mutex);
+    // it is still pending; the experiment goes on running
+    if (delay <= 0) {
+        m_scheduler->requeue(trial);
+        return;
+    }
 
-    m_runningTrials.remove(trial);
-    if (isTheLastTrial(trial)) {
-        ExperimentPtr exp = trial->m_exp;
+    QMutexLocker locker(&m_delayMutex);
+    m_delayedTrials.emplace(m_clock.elapsed() + delay, trial);
+    locker.unlock();
+    emit (trialDelayed());
+}
 
-        locker.unlock();
-        exp->expFinished(); // might delete all trials
-        locker.relock();
+void ExperimentsMgr::queueDelayedTrials()
+{
+    QMutexLocker locker(&m_delayMutex);
+    const qint64 now = m_clock.elapsed();
+    std::vector<Trial*> trials;
+    auto it = m_delayedTrials.begin();
+    for (; it != m_delayedTrials.end() && it->first <= now; ++it) {
+        trials.emplace_back(it->second);
+    }
+    m_delayedTrials.erase(m_delayedTrials.begin(), it);
+    if (!m_delayedTrials.empty()) {
+        m_delayTimer.start(static_cast<int>(m_delayedTrials.begin()->first - now));
+    }
+    locker.unlock();
 
-        m_running.remove(exp);
-        emit (progressUpdated());
+    if (!trials.empty()) {
+        m_scheduler->enqueue(trials);
+    }
+}
 
-        if (exp->expStatus() != Status::Invalid && exp->expStatus() != Status::Disabled) {
-            m_idle.emplace_back(exp);
+void ExperimentsMgr::flushDelayedTrials(const Experiment* exp)
+{
+    QMutexLocker locker(&m_delayMutex);
+    std::vector<Trial*> trials;
+    for (auto it = m_delayedTrials.begin(); it != m_delayedTrials.end();) {
+        if (it->second->m_exp.get() == exp) {
+            trials.emplace_back(it->second);
+            it = m_delayedTrials.erase(it);
+        } else {
+            ++it;
         }
+    }
+    locker.unlock();
+
+    // they are still pending; the experiment finishes once they are taken
+    if (!trials.empty()) {
+        m_scheduler->enqueue(trials);
+    }
+}
+
+void ExperimentsMgr::removeDelayedTrial(const Trial* trial)
+{
+    QMutexLocker locker(&m_delayMutex);
+    for (auto it = m_delayedTrials.begin(); it != m_delayedTrials.end(); ++it) {
+        if (it->second == trial) {
+            m_delayedTrials.erase(it);
+            return;
+        }
+    }
+}
+
+void ExperimentsMgr::playForks(const ExperimentPtr& exp)
+{
+    QMutexLocker locker(&m_mutex);
 
-        if (m_running.empty() && m_queued.empty()) {
-            m_lastThreadPriority = INT32_MAX; // reset priority
+    std::vector<Trial*> trials;
+    for (quint16 id = 1; id < exp->trials().size(); ++id) {
+        Trial* trial = exp->trials().at(id);
+        if (trial->status() == Status::Disabled) {
+            trials.emplace_back(trial);
         }
     }
+    // trial 0 is still pending, so the experiment cannot finish meanwhile
+    m_pendingTrials[exp.get()] += static_cast<int>(trials.size());
 
     locker.unlock();
-    processQueue();
+    m_scheduler->enqueue(trials);
 }
 
-bool ExperimentsMgr::isTheLastTrial(const Trial* trial)
+void ExperimentsMgr::runTrial(Trial* trial)
 {
-    for (auto const& t : m_runningTrials) {
-        if (t->m_exp == trial->m_exp)
-            return false;
+    QMutexLocker locker(&m_mutex);
+    Experiment* exp = trial->m_exp.get();
+
+    // checks if we really need to run this trial
+    if (!exp || exp->expStatus() == Status::Invalid ||
+            exp->expStatus() == Status::Finished ||
+            exp->pauseAt() < 0) { // is paused
+        if (trial->m_yielded) {
+            trial->m_yielded = false;
+            trial->m_model->afterLoop(); // it was requeued in the middle of the loop
+        }
+        locker.unlock();
+        trialFinished(trial);
+        return;
     }
-    for (auto const& t : m_queuedTrials) {
-        if (t->m_exp == trial->m_exp)
-            return false;
+
+    // checks if this is the first time we run this experiment
+    if (exp->expStatus() != Status::Running) {
+        exp->setExpStatus(Status::Running);
+        m_running.emplace_back(trial->m_exp);
+        m_queued.remove(trial->m_exp);
     }
-    return true;
+
+    locker.unlock();
+    trial->run(); // calls trialFinished() when it is done
 }
 
-void ExperimentsMgr::processQueue()
+bool ExperimentsMgr::needsMemory(const Trial* trial) const
 {
-    QMutexLocker locker(&m_mutex);
-    if (static_cast<int>(m_runningTrials.size()) < m_threads) {
-        Trial* trial = nullptr;
-        while (!trial && !m_queuedTrials.empty()) {
-            trial = m_queuedTrials.front();
-            m_queuedTrials.pop_front();
-        }
+    const Experiment* exp = trial->m_exp.get();
+    // the trials which have been set up already hold their memory, and
+    // the ones of paused experiments are only dropped; see runTrial()
+    return trial->m_reservedMemory == 0 && trial->m_status == Status::Disabled &&
+            exp->expStatus() != Status::Invalid && exp->pauseAt() >= 0;
+}
 
-        if (!trial) {
-            return;
-        }
+bool ExperimentsMgr::timeSliceExpired(qint64 elapsed) const
+{
+    if (m_timeSlice <= 0 || elapsed < m_timeSlice || m_scheduler->numQueued() == 0) {
+        return false;
+    }
+    // the trials waiting for memory would not start in its place
+    const qint64 budget = static_cast<qint64>(m_memoryBudget) << 20;
+    return m_scheduler->anyQueued([this, budget](Trial* trial) {
+        return budget <= 0 || !needsMemory(trial) ||
+                m_memoryReserved + trial->m_exp->trialFootprint() <= budget;
+    });
+}
+
+bool ExperimentsMgr::admitTrial(Trial* trial, bool force)
+{
+    if (!needsMemory(trial)) {
+        return true;
+    }
+    Experiment* exp = trial->m_exp.get();
+
+    // the delayed trials are not running, but they will be shortly
+    if (force) {
+        QMutexLocker locker(&m_delayMutex);
+        force = m_delayedTrials.empty();
+    }
 
-        Experiment* exp = trial->m_exp.get();
+    const qint64 footprint = exp->trialFootprint();
+    const qint64 budget = static_cast<qint64>(m_memoryBudget) << 20;
 
-        // checks if we really need to run this trial
-        if (!exp || exp->expStatus() == Status::Invalid ||
-                exp->expStatus() == Status::Finished ||
-                exp->pauseAt() < 0) { // is paused
+    QMutexLocker locker(&m_memoryMutex);
+    if (budget > 0 && !force && m_memoryReserved + footprint > budget) {
+        if (m_waitingForMemory.insert(exp).second) {
+            const QString reason = QString("not enough memory; a trial needs ~%1 MB and "
+                                           "%2 of %3 MB are taken by other trials")
+                    .arg(footprint >> 20).arg(m_memoryReserved >> 20).arg(budget >> 20);
             locker.unlock();
-            trialFinished(trial);
-            return;
+            qDebug() << QString("[E%1] the trials are waiting:").arg(exp->id()) << reason;
+            emit (trialsWaiting(exp->id(), reason));
         }
+        return false;
+    }
 
-        // checks if this is the first time we run this experiment
-        if (exp->expStatus() != Status::Running) {
-            exp->setExpStatus(Status::Running);
-            m_running.emplace_back(trial->m_exp);
-            m_queued.remove(trial->m_exp);
-        }
+    m_memoryReserved += footprint;
+    trial->m_reservedMemory = footprint;
+    m_waitingForMemory.erase(exp);
+    return true;
+}
+
+void ExperimentsMgr::calibrateMemory(Trial* trial, qint64 bytes)
+{
+    bytes = std::max<qint64>(1, bytes);
+    trial->m_exp->m_trialFootprint = bytes;
+
+    QMutexLocker locker(&m_memoryMutex);
+    const qint64 diff = bytes - trial->m_reservedMemory;
+    m_memoryReserved += diff;
+    trial->m_reservedMemory = bytes;
+    locker.unlock();
+
+    if (diff < 0) {
+        m_scheduler->retry();
+    }
+}
+
+void ExperimentsMgr::releaseMemory(qint64 bytes)
+{
+    QMutexLocker locker(&m_memoryMutex);
+    m_memoryReserved -= bytes;
+    locker.unlock();
+
+    if (m_scheduler) { // it may be called while the manager is being deleted
+        m_scheduler->retry();
+    }
+}
+
+void ExperimentsMgr::setMemoryBudget(int megabytes, bool persist)
+{
+    m_memoryBudget = std::max(0, megabytes);
+    if (persist) {
+        m_userPrefs.setValue("settings/memoryBudget", m_memoryBudget.load());
+    }
+    qDebug() << "setting the memory budget to" << m_memoryBudget << "MB";
+    m_scheduler->retry(); // a larger budget may admit the waiting trials
+}
+
+void ExperimentsMgr::setTimeSlice(int ms, bool persist)
+{
+    m_timeSlice = std::max(0, ms);
+    if (persist) {
+        m_userPrefs.setValue("settings/timeSlice", m_timeSlice.load());
+    }
+    qDebug() << "setting the time slice to" << m_timeSlice << "ms";
+}
+
+void ExperimentsMgr::trialFinished(Trial* trial)
+{
+    QMutexLocker locker(&m_mutex);
 
-        m_runningTrials.emplace_back(trial);
-        // play in the same order of insertion
-        m_threadPool.start(trial, m_lastThreadPriority--);
+    auto it = m_pendingTrials.find(trial->m_exp.get());
+    Q_ASSERT_X(it != m_pendingTrials.end(), "trialFinished", "the trial was not queued");
+    if (--it->second == 0) {
+        m_pendingTrials.erase(it);
+        ExperimentPtr exp = trial->m_exp;
 
         locker.unlock();
-        processQueue();
+        exp->expFinished(); // might delete all trials
+        locker.relock();
+
+        m_running.remove(exp);
+        emit (progressUpdated());
+
+        if (exp->expStatus() != Status::Invalid && exp->expStatus() != Status::Disabled) {
+            m_idle.emplace_back(exp);
+        }
     }
 }
 
 void ExperimentsMgr::remove(const ExperimentPtr& exp)
 {
+    flushDelayedTrials(exp.get());
     removeFromQueue(exp);
     QMutexLocker locker(&m_mutex);
     m_idle.remove(exp);
@@ -196,13 +354,11 @@ void ExperimentsMgr::removeFromQueue(const ExperimentPtr& exp)
     QMutexLocker locker(&m_mutex);
     if (exp->expStatus() == Status::Queued) {
         m_queued.remove(exp);
-        auto it = m_queuedTrials.begin();
-        while (it != m_queuedTrials.end()) {
-            if ((*it)->m_exp == exp) {
-                it = m_queuedTrials.erase(it);
-            } else {
-                ++it;
-            }
+        const int numRemoved = m_scheduler->remove(
+                    [&exp](Trial* trial) { return trial->m_exp == exp; });
+        auto it = m_pendingTrials.find(exp.get());
+        if (it != m_pendingTrials.end() && (it->second -= numRemoved) <= 0) {
+            m_pendingTrials.erase(it);
         }
         exp->setExpStatus(Status::Paused);
     }
@@ -224,7 +380,7 @@ void ExperimentsMgr::clearQueue()
     m_queued.clear();
 }
 
-void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
+void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error, bool persist)
 {
     if (m_threads == newValue) {
         return;
@@ -240,15 +396,24 @@ void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
     }
 
     QMutexLocker locker(&m_mutex);
-    if (!m_running.empty() || !m_queued.empty()) {
-        QString e("Cannot set the number of threads while running experiments."
-                  " Please, pause all your experiments and try again.");
-        if (error) *error = e;
-        qWarning() << e;
-        return;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!m_running.empty() || !m_queued.empty()) {
+            QString e("Cannot set the number of threads while running experiments."
+                      " Please, pause all your experiments and try again.");
+            if (error) *error = e;
+            qWarning() << e;
+            return;
+        }
+        if (attempt == 0) {
+            // the workers may still be dropping the trials of paused experiments
+            locker.unlock();
+            m_threadPool.waitForDone();
+            locker.relock();
+        }
     }
 
     m_threadPool.setMaxThreadCount(newValue);
+    m_scheduler->setNumWorkers(newValue);
     if (newValue != m_threadPool.maxThreadCount()) {
         QString e("Could not set the number of threads to %1.\n"
                   "Assigning the maximum value available: %2.");
@@ -260,7 +425,9 @@ void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
              << m_threads << "to" << newValue;
 
     m_threads = newValue;
-    m_userPrefs.setValue("settings/threads", m_threads);
+    if (persist) {
+        m_userPrefs.setValue("settings/threads", m_threads);
+    }
 }
 
 } // evoplex
@@ -17,14 +17,21 @@
 #ifndef EXPERIMENTMGR_H
 #define EXPERIMENTMGR_H
 
+#include <atomic>
 #include <list>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
-#include <QTimer>
 #include <QSettings>
 #include <QThreadPool>
+#include <QTimer>
+
+#include "trialscheduler.h"
 
 namespace evoplex {
 
@@ -45,12 +52,59 @@ public:
     void play(ExperimentPtr exp);
 
     inline int maxThreadsCount() const { return m_threads; }
-    void setMaxThreadCount(const int newValue, QString* error=nullptr);
+
+    // the pool running the trials; its idle threads also run the
+    // partitions of the trials' parallel steps
+    inline QThreadPool* threadPool() { return &m_threadPool; }
+    // the value is only kept for this session if 'persist' is false
+    void setMaxThreadCount(const int newValue, QString* error=nullptr, bool persist=true);
+
+    // The memory (in MB) the trials may take; 0 means no limit.
+    // A trial is only started if its estimated footprint fits in the
+    // budget, or if no other trial is running.
+    inline int memoryBudget() const { return m_memoryBudget; }
+    void setMemoryBudget(int megabytes, bool persist=true);
+
+    // the memory (in bytes) taken by the trials which have been started
+    inline qint64 memoryReserved() const { return m_memoryReserved; }
+
+    // the trial has been measured; it updates its reserved memory and
+    // the footprint expected for the other trials of its experiment
+    void calibrateMemory(Trial* trial, qint64 bytes);
+
+    // called when a trial is deleted
+    void releaseMemory(qint64 bytes);
+
+    // The time (in ms) a trial may run while other trials are waiting;
+    // 0 means no limit. Once it is over, the trial is paused and queued
+    // again, behind the waiting trials.
+    inline int timeSlice() const { return m_timeSlice; }
+    void setTimeSlice(int ms, bool persist=true);
+
+    // true if a trial which has been running for 'elapsed' ms must give way,
+    // i.e., if a queued trial could start in its place
+    bool timeSliceExpired(qint64 elapsed) const;
+
+    // Queues a trial which has given way to the others, or which waits
+    // for its experiment's delay (in ms) before running the next step.
+    // The delayed trials are kept out of the workers and queued by a timer.
+    // It is called by the trial while it is running.
+    void requeueTrial(Trial* trial, int delay=0);
+
+    // queues the delayed trials of 'exp' straight away, e.g., when it is paused
+    void flushDelayedTrials(const Experiment* exp);
+
+    // forgets a delayed trial; called when a trial is deleted
+    void removeDelayedTrial(const Trial* trial);
 
     // trigged when a Trial ends
     // also runs in a work thread
     void trialFinished(Trial* trial);
 
+    // queues the trials waiting for trial 0 to reach the fork point
+    // called by trial 0 while it is running
+    void playForks(const ExperimentPtr& exp);
+
     void remove(const ExperimentPtr& exp);
     void removeFromQueue(const ExperimentPtr& exp);
     void removeFromIdle(const ExperimentPtr& exp);
@@ -59,22 +113,44 @@ public slots:
     void clearQueue();
 
 signals:
+    // emitted when the progress of any experiment changes
     void progressUpdated();
 
+    // emitted (from a work thread) when the trials of an experiment
+    // start waiting for memory to be released
+    void trialsWaiting(int expId, const QString& reason);
+
+    // internal; tells the timer of the delayed trials (in the main thread)
+    // that a trial has been delayed
+    void trialDelayed();
+
 private slots:
-    void updateProgressValues();
+    // queues the delayed trials which are due and sets the timer for the next
+    void queueDelayedTrials();
 
 private:
     QThreadPool m_threadPool;
     QMutex m_mutex;
     QSettings m_userPrefs;
     int m_threads;
-    int m_lastThreadPriority;
+    std::atomic<int> m_memoryBudget; // MB
+    std::atomic<int> m_timeSlice; // ms
 
-    QTimer* m_timerProgress; // update the progress value of all running experiments
+    // the trials waiting for their experiment's delay, by due time (ms)
+    QMutex m_delayMutex;
+    std::multimap<qint64, Trial*> m_delayedTrials;
+    QElapsedTimer m_clock;
+    QTimer m_delayTimer;
 
-    std::list<Trial*> m_runningTrials;
-    std::list<Trial*> m_queuedTrials;
+    QMutex m_memoryMutex;
+    std::atomic<qint64> m_memoryReserved; // bytes
+    // the experiments which have been told to wait; it avoids repeating it
+    std::unordered_set<const Experiment*> m_waitingForMemory;
+
+    std::unique_ptr<TrialScheduler> m_scheduler;
+    // the number of trials of each experiment which are queued or running;
+    // the experiment is finished when it reaches zero
+    std::unordered_map<const Experiment*, int> m_pendingTrials;
 
     std::list<ExperimentPtr> m_running;
     std::list<ExperimentPtr> m_queued;
@@ -82,9 +158,11 @@ private:
 
     void _play(ExperimentPtr exp);
 
-    void processQueue();
-
-    bool isTheLastTrial(const Trial* trial);
+    // called by the scheduler's workers
+    void runTrial(Trial* trial);
+    bool admitTrial(Trial* trial, bool force);
+    // true if the trial has to reserve memory before it is started
+    bool needsMemory(const Trial* trial) const;
 };
 
 } // evoplex
@@ -106,6 +106,19 @@ ExpInputsPtr ExpInputs::parse(const MainApp* mainApp, const QStringList& header,
     parseAttrs(ei.get(), mainApp, header, values, failedAttrs);
     parseFileCache(ei.get(), failedAttrs, errMsg);
 
+    // projects saved before these attributes existed neither fork
+    // their trials nor stop them earlier
+    const std::vector<std::pair<QString, Value>> optionalAttrs = {
+        { GENERAL_ATTR_FORKAT, Value(0) },
+        { GENERAL_ATTR_STOPWHEN, Value("") }
+    };
+    for (auto const& attr : optionalAttrs) {
+        if (!ei->m_generalAttrs->contains(attr.first)) {
+            auto attrRange = mainApp->generalAttrsScope().value(attr.first);
+            ei->m_generalAttrs->replace(attrRange->id(), attr.first, attr.second);
+        }
+    }
+
     // make sure all attributes exist
     auto checkAll = [&failedAttrs](Attributes* attrs, const AttributesScope& attrsScope) {
         for (auto const& attrRange : attrsScope) {
@@ -24,7 +24,8 @@ namespace evoplex {
 
 GraphPlugin::GraphPlugin(QPluginLoader* loader, const QString& libPath)
     : Plugin(PluginType::Graph, loader, libPath),
-      m_supportsEdgeAttrsGen(false)
+      m_supportsEdgeAttrsGen(false),
+      m_isDeterministic(false)
 {
     if (m_type == PluginType::Invalid) {
         return;
@@ -61,6 +62,16 @@ GraphPlugin::GraphPlugin(QPluginLoader* loader, const QString& libPath)
             m_validGraphTypes.emplace_back(type);
         }
     }
+
+    if (m_metaData.contains(PLUGIN_ATTR_DETERMINISTIC)) {
+        if (!m_metaData.value(PLUGIN_ATTR_DETERMINISTIC).isBool()) {
+            qWarning() << QString("the attribute '%1' must be a boolean.")
+                          .arg(PLUGIN_ATTR_DETERMINISTIC);
+            m_type = PluginType::Invalid;
+            return;
+        }
+        m_isDeterministic = m_metaData.value(PLUGIN_ATTR_DETERMINISTIC).toBool();
+    }
 }
 
 } // evoplex
@@ -17,17 +17,30 @@
 #ifndef ABSTRACT_GRAPH_H
 #define ABSTRACT_GRAPH_H
 
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 #include <QtDebug>
 #include <QMutex>
 
 #include "abstractplugin.h"
+#include "adjacency.h"
+#include "attrhandle.h"
+#include "attributestable.h"
 #include "attrsgenerator.h"
+#include "edgebuilder.h"
 #include "edges.h"
 #include "enum.h"
+#include "lattice.h"
 #include "nodes.h"
 
+class QDataStream;
+
 namespace evoplex {
 
+class EdgeArena;
+class Topology;
+
 /**
  * @brief Provides a common interface for Graph plugins.
  * @see AbstractGraph
@@ -53,6 +66,8 @@ public:
  */
 class AbstractGraph : public AbstractGraphInterface
 {
+    friend class BaseNode;
+    friend class EdgeBuilder;
     friend class Trial;
 
 public:
@@ -81,6 +96,9 @@ public:
 
     /**
      * @brief Gets the edges.
+     * @note The edges of a topology shared with other trials are only
+     *       created on the first call to this or to any other method
+     *       touching the Edge objects (e.g., Node::outEdges()).
      */
     inline const Edges& edges() const;
 
@@ -93,11 +111,31 @@ public:
 
     /**
      * @brief Returns the Edge that connects \p originId to \p neighbourId.
+     * In undirected graphs, the nodes can be given in any order and the
+     * origin of the returned Edge is \p originId. If the nodes are connected
+     * by parallel edges, any of them is returned.
+     * @note It takes O(1) on average. The index of the nodes' pairs is built
+     *       on the first call and kept up to date from then on.
      * @param originId A valid node id.
      * @param neighbourId A valid node id.
      * @throw std::out_of_range if no such data is present.
      */
-    inline const Edge& edge(int originId, int neighbourId) const;
+    const Edge& edge(int originId, int neighbourId) const;
+
+    /**
+     * @brief Checks if the Edge objects have not been created yet.
+     * It is the case of a topology shared with other trials or of a
+     * lattice(), until some method needs the Edge objects.
+     * @see edges()
+     */
+    inline bool hasPendingEdges() const;
+
+    /**
+     * @brief Gets a number that changes whenever a node or an edge is
+     * added to or removed from the graph.
+     * The Edge objects obtained at the same revision are still valid.
+     */
+    inline size_t revision() const;
 
     /**
      * @brief Gets the nodes.
@@ -111,8 +149,83 @@ public:
      */
     inline Node node(int nodeId) const;
 
+    /**
+     * @brief Gets the neighbours of \p nodeId through its outgoing edges.
+     * The ids are read from a compressed sparse row (CSR) snapshot of the
+     * graph, which is stored contiguously in memory and rebuilt on demand
+     * after any change in the topology, or computed on the fly if the
+     * graph is a lattice(). For undirected graphs, it is the same as
+     * inNeighbours().
+     * @param nodeId A valid node id.
+     * @throw std::out_of_range if no such data is present.
+     * @see outAdjacency()
+     */
+    inline Neighbours outNeighbours(int nodeId) const;
+
+    /**
+     * @brief Gets the neighbours of \p nodeId through its incoming edges.
+     * @copydetails outNeighbours()
+     */
+    inline Neighbours inNeighbours(int nodeId) const;
+
+    /**
+     * @brief Gets the CSR snapshot of the outgoing edges.
+     * If the graph is a lattice(), its edges are created first.
+     * @see outNeighbours()
+     */
+    inline const Adjacency& outAdjacency() const;
+
+    /**
+     * @brief Gets the CSR snapshot of the incoming edges.
+     * @copydetails outAdjacency()
+     * @see inNeighbours()
+     */
+    inline const Adjacency& inAdjacency() const;
+
+    /**
+     * @brief Gets the implicit topology of the graph.
+     * @returns nullptr if the graph is not a lattice.
+     * @see setLattice()
+     */
+    inline const Lattice* lattice() const;
+
+    /**
+     * @brief Gets the columnar store of the nodes' attributes.
+     * The row of each node is its id, so a model can scan a whole
+     * attribute linearly through AttributesTable::column().
+     * @note Nodes added with a set of attributes that differs from the
+     *       other nodes keep their own attributes outside of the table.
+     */
+    inline const AttributesTable& nodeAttrsTable() const;
+
+    /**
+     * @brief Resolves a typed handle to the nodes' attribute \p name.
+     * @returns An invalid handle if the attribute is not present, if its
+     *          values are not of type T or if some node is not stored in
+     *          the nodeAttrsTable().
+     * @note The column is shared (copy-on-write) with the other trials
+     *       until a valid handle is returned, as the handle may write it.
+     * @see AttrHandle
+     */
+    template <typename T>
+    AttrHandle<T> nodeAttrHandle(const QString& name) const;
+
+    /**
+     * @brief Resolves a double-buffered handle to the nodes' attribute \p name.
+     * The back buffer is created on the first call, and the trial swaps
+     * it with the current values after each step. Thus, the model must
+     * write every node with AttrBuffer::setNext() in each step.
+     * @returns An invalid handle under the same conditions of nodeAttrHandle().
+     * @see AttrBuffer
+     */
+    template <typename T>
+    AttrBuffer<T> nodeAttrBuffer(const QString& name);
+
     /**
      * @brief Gets a random Node in the graph.
+     * It is O(1) on average: the removed nodes leave tombstones that take
+     * extra draws, but the trial squeeze()s the graph between steps once
+     * they outnumber the live nodes.
      * @return If the graph has no nodes, it returns an invalid/empty Node.
      */
     Node randNode() const;
@@ -125,7 +238,25 @@ public:
     /**
      * @brief Gets the number of edges in the graph.
      */
-    inline int numEdges() const;
+    int numEdges() const;
+
+    /**
+     * @brief Estimates the memory used by the nodes, in bytes.
+     * It includes the node objects, their attributes and the node container;
+     * the shared attributes' schema is counted only once.
+     * @see edgesMemoryUsage()
+     */
+    size_t nodesMemoryUsage() const;
+
+    /**
+     * @brief Estimates the memory used by the edges, in bytes.
+     * It includes the pool of edge records, their attributes and
+     * the edge containers held by the graph and by the nodes. If the
+     * graph uses a topology shared with other trials, it is the size
+     * of the shared snapshot instead.
+     * @see nodesMemoryUsage()
+     */
+    size_t edgesMemoryUsage() const;
 
     /**
      * @brief Creates a Node with \p attrs and adds it into the graph.
@@ -148,7 +279,7 @@ public:
      * @returns the new Edge
      * @warning the nodes' ids must belong to the graph.
      */
-    inline Edge addEdge(int originId, int neighbourId, Attributes* attrs=new Attributes());
+    inline Edge addEdge(int originId, int neighbourId, Attributes attrs=Attributes());
 
     /**
      * @brief Creates and adds an Edge into the graph.
@@ -158,7 +289,37 @@ public:
      * @returns the new Edge
      * @warning the nodes' ids must belong to the graph.
      */
-    Edge addEdge(const Node& origin, const Node& neighbour, Attributes* attrs=new Attributes());
+    Edge addEdge(const Node& origin, const Node& neighbour, Attributes attrs=Attributes());
+
+    /**
+     * @copydoc addEdge(int, int, Attributes)
+     * @note The graph takes the ownership of @p attrs, which may be null.
+     */
+    inline Edge addEdge(int originId, int neighbourId, Attributes* attrs);
+
+    /**
+     * @copydoc addEdge(const Node&, const Node&, Attributes)
+     * @note The graph takes the ownership of @p attrs, which may be null.
+     */
+    Edge addEdge(const Node& origin, const Node& neighbour, Attributes* attrs);
+
+    /**
+     * @brief Preallocates the records of @p numEdges edges.
+     * It is useful to speed up the creation of large graphs.
+     * @see EdgeBuilder
+     */
+    void reserveEdges(int numEdges);
+
+    /**
+     * @brief Uses the implicit topology of @p lattice instead of edges.
+     * The neighbours are then computed on the fly, so no memory is spent
+     * on the edges. They are created only if some method needs the Edge
+     * objects (e.g., edges() or Node::outEdges()) and they have no
+     * attributes. Any change in the topology turns it into a regular graph.
+     * @returns false if the graph has edges or if its nodes' ids are
+     *          not 0..lattice.numNodes()-1.
+     */
+    bool setLattice(const Lattice& lattice);
 
     /**
      * @brief Removes all edges of the graph.
@@ -201,6 +362,27 @@ public:
      */
     Edges::iterator removeEdge(Edges::iterator it);
 
+    /**
+     * @brief Gets the fraction of tombstones in the nodes' or in the
+     *        edges' container, whichever is larger.
+     * Removing a node or an edge leaves a tombstone in its slot, so that
+     * removals are O(1) and do not invalidate the iterators. They are
+     * skipped by the iterators and by randNode(), and dropped by squeeze().
+     */
+    double fragmentation() const;
+
+    /**
+     * @brief Drops the tombstones left by the removed nodes and edges.
+     * The ids and the order of the elements are kept, so the topology
+     * does not change. The rows of nodeAttrsTable() are addressed by the
+     * node ids, so only the rows after the last node are dropped. The
+     * trial calls it between steps whenever the tombstones outnumber the
+     * live nodes or edges.
+     * @warning It invalidates the iterators and the references to the
+     *          Node and Edge objects held by the containers.
+     */
+    void squeeze();
+
 /**@}*/
 
 protected:
@@ -210,16 +392,82 @@ protected:
 
     //! constructor
     AbstractGraph();
+    //! destructor
+    ~AbstractGraph() override;
 
 private:
     int m_lastNodeId;
     int m_lastEdgeId;
     QMutex m_mutex;
 
-    std::uniform_int_distribution<int> m_numNodesDist;
+    std::shared_ptr<AttributesTable> m_nodeAttrs;
+
+    // owns the records of all edges in the graph
+    std::unique_ptr<EdgeArena> m_edgeArena;
+
+    // CSR snapshots of the topology; they are rebuilt lazily
+    // and may be shared with the graphs of other trials
+    mutable QMutex m_adjMutex;
+    mutable std::atomic<bool> m_adjDirty;
+    std::atomic<size_t> m_revision;
+    mutable AdjacencyPtr m_outAdj;
+    mutable AdjacencyPtr m_inAdj; // same as m_outAdj if undirected
+
+    // the id of the edges keyed by the pair of nodes (see pairKey());
+    // it is built on the first lookup and then updated along with m_edges,
+    // always under m_adjMutex, as edge() may build it from any thread
+    mutable std::unordered_multimap<quint64, int> m_pairs;
+    mutable std::atomic<bool> m_pairsIndexed;
+
+    // the shared topology or the lattice whose Edge objects are not created yet
+    std::shared_ptr<const Topology> m_topology;
+    std::unique_ptr<const Lattice> m_lattice;
+    std::atomic<bool> m_edgesPending;
 
     bool setup(Trial& trial, AttrsGeneratorPtr edgeGen,
                const Attributes& attrs, Nodes& nodes);
+
+    // takes a read-only snapshot of the edges to be shared with other graphs
+    std::shared_ptr<const Topology> shareTopology() const;
+
+    // uses the edges of a topology built by another graph with the same nodes
+    // instead of calling reset(); returns false if the nodes do not match
+    bool adoptTopology(std::shared_ptr<const Topology> topology);
+
+    // creates the Edge objects of the adopted topology, if not done yet
+    inline void ensureEdges() const;
+    void createPendingEdges();
+
+    // adds the edges of all buffers at once; called by EdgeBuilder::commit()
+    bool commitEdges(std::vector<EdgeBuffer>& buffers);
+
+    // writes the nodes, the edges and their attributes to a trial checkpoint
+    void saveState(QDataStream& out) const;
+    // replaces the nodes and the edges with the ones written by saveState();
+    // the graph is not changed if the data is not valid
+    bool restoreState(QDataStream& in);
+
+    // creates the edge without locking the mutex or touching the adjacency
+    Edge insertEdge(int edgeId, const Node& origin, const Node& neighbour, Attributes attrs);
+
+    // removes the edge from m_edges and destroys its record
+    void destroyEdge(int edgeId);
+
+    // the key of the pair of nodes in m_pairs; it is symmetric if undirected
+    inline quint64 pairKey(int originId, int neighbourId) const;
+    // builds m_pairs from scratch
+    void indexPairs() const;
+    // removes the edge from m_pairs, if it is being indexed
+    void unindexPair(const BaseEdge* e);
+
+    // stores the node's attributes in m_nodeAttrs if they match its schema
+    void bindNodeAttrs(const Node& node);
+
+    // rebuilds the CSR snapshots if the topology has changed
+    void updateAdjacency() const;
+
+    // flags the CSR snapshots as outdated
+    inline void invalidateAdjacency();
 };
 
 
@@ -234,29 +482,91 @@ inline bool AbstractGraph::isUndirected() const
 { return type() == GraphType::Undirected; }
 
 inline const Edges& AbstractGraph::edges() const
-{ return m_edges; }
+{ ensureEdges(); return m_edges; }
+
+inline bool AbstractGraph::hasPendingEdges() const
+{ return m_edgesPending; }
+
+inline size_t AbstractGraph::revision() const
+{ return m_revision; }
 
 inline const Nodes& AbstractGraph::nodes() const
 { return m_nodes; }
 
 inline const Edge& AbstractGraph::edge(int edgeId) const
-{ return m_edges.at(edgeId); }
+{ ensureEdges(); return m_edges.at(edgeId); }
+
+inline const AttributesTable& AbstractGraph::nodeAttrsTable() const
+{ return *m_nodeAttrs; }
+
+template <typename T>
+AttrHandle<T> AbstractGraph::nodeAttrHandle(const QString& name) const
+{
+    // the type is checked without detaching the column from the other trials
+    const AttributesTable& table = *m_nodeAttrs;
+    const int col = table.indexOf(name);
+    if (col < 0 || table.size() != m_nodes.size() ||
+            table.column(col).type() != AttrTraits<T>::type) {
+        return AttrHandle<T>();
+    }
+    // the handle writes the column, so only then it gets a copy of its own
+    return AttrHandle<T>(&m_nodeAttrs->column(col), col);
+}
+
+template <typename T>
+AttrBuffer<T> AbstractGraph::nodeAttrBuffer(const QString& name)
+{
+    const AttrHandle<T> front = nodeAttrHandle<T>(name);
+    if (!front.isValid()) {
+        return AttrBuffer<T>();
+    }
+    return AttrBuffer<T>(front.m_column, &m_nodeAttrs->backColumn(front.attrId()), front.attrId());
+}
 
-inline const Edge& AbstractGraph::edge(int originId, int neighbourId) const
-{ return m_nodes.at(originId).outEdges().at(neighbourId); }
+inline Neighbours AbstractGraph::outNeighbours(int nodeId) const
+{ return m_lattice ? m_lattice->outNeighbours(nodeId) : outAdjacency().neighbours(nodeId); }
+
+inline Neighbours AbstractGraph::inNeighbours(int nodeId) const
+{ return m_lattice ? m_lattice->inNeighbours(nodeId) : inAdjacency().neighbours(nodeId); }
+
+inline const Lattice* AbstractGraph::lattice() const
+{ return m_lattice.get(); }
+
+inline const Adjacency& AbstractGraph::outAdjacency() const
+{ if (m_adjDirty) { updateAdjacency(); } return *m_outAdj; }
+
+inline const Adjacency& AbstractGraph::inAdjacency() const
+{ if (m_adjDirty) { updateAdjacency(); } return *m_inAdj; }
+
+inline void AbstractGraph::invalidateAdjacency()
+{ m_adjDirty = true; ++m_revision; m_lattice.reset(); }
+
+inline void AbstractGraph::ensureEdges() const
+{
+    // creating the edges does not change the graph from the outside
+    if (m_edgesPending) { const_cast<AbstractGraph*>(this)->createPendingEdges(); }
+}
+
+inline quint64 AbstractGraph::pairKey(int originId, int neighbourId) const
+{
+    if (isUndirected() && originId > neighbourId) {
+        std::swap(originId, neighbourId);
+    }
+    return (quint64(quint32(originId)) << 32) | quint32(neighbourId);
+}
 
 inline Node AbstractGraph::node(int nodeId) const
 { return m_nodes.at(nodeId); }
 
-inline int AbstractGraph::numEdges() const
-{ return static_cast<int>(m_edges.size()); }
-
 inline int AbstractGraph::numNodes() const
 { return static_cast<int>(m_nodes.size()); }
 
 inline Node AbstractGraph::addNode(Attributes attr)
 { return addNode(attr, 0, m_lastNodeId+1); }
 
+inline Edge AbstractGraph::addEdge(int originId, int neighbourId, Attributes attrs)
+{  return addEdge(m_nodes.at(originId), m_nodes.at(neighbourId), std::move(attrs)); }
+
 inline Edge AbstractGraph::addEdge(int originId, int neighbourId, Attributes* attrs)
 {  return addEdge(m_nodes.at(originId), m_nodes.at(neighbourId), attrs); }
 
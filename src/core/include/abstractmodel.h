@@ -17,13 +17,16 @@
 #ifndef ABSTRACT_MODEL_H
 #define ABSTRACT_MODEL_H
 
+#include <functional>
 #include <memory.h>
 #include <vector>
+#include <QDataStream>
 
 #include "abstractplugin.h"
 #include "abstractgraph.h"
 #include "edges.h"
 #include "nodes.h"
+#include "partition.h"
 
 namespace evoplex {
 
@@ -69,6 +72,24 @@ public:
      * @return the Value output for each of the \p inputs
      */
     virtual Values customOutputs(const Values& inputs) const = 0;
+
+    /**
+     * @brief Writes the state of the model that is not held by the graph
+     *        (e.g., counters or caches) to a trial checkpoint.
+     * The nodes, the edges, their attributes and the PRGs are saved by the
+     * trial. The default implementation of this function writes nothing.
+     * @return false if the state cannot be saved.
+     * @see restoreState()
+     */
+    virtual bool saveState(QDataStream& out) const = 0;
+
+    /**
+     * @brief Reads the state written by saveState() from a trial checkpoint.
+     * It is called after init(), which runs on the restored graph.
+     * The default implementation of this function reads nothing.
+     * @return false if the state is not valid; the trial starts over then.
+     */
+    virtual bool restoreState(QDataStream& in) = 0;
 };
 
 /**
@@ -115,12 +136,40 @@ public:
     //! @copydoc AbstractGraph::edge(int originId, int neighbourId) const
     inline const Edge& edge(int originId, int neighbourId) const;
 
+    //! @copydoc AbstractGraph::nodeAttrHandle
+    template <typename T>
+    inline AttrHandle<T> nodeAttrHandle(const QString& name) const;
+
+    //! @copydoc AbstractGraph::nodeAttrBuffer
+    template <typename T>
+    inline AttrBuffer<T> nodeAttrBuffer(const QString& name) const;
+
+    /**
+     * @brief Calls \p func for each Partition of the nodes' ids and waits
+     *        for all of them to finish.
+     * The partitions run in parallel, on the idle threads of the pool that
+     * runs the trials, and in the calling thread. A partition may read any
+     * node, but it must only write to the nodes in its own range.
+     * @code
+     * parallelFor([this](const Partition& p) {
+     *     for (int id = p.firstId(); id < p.endId(); ++id) {
+     *         m_state.set(id, p.prg()->bernoulli());
+     *     }
+     * });
+     * @endcode
+     */
+    void parallelFor(const std::function<void(const Partition&)>& func) const;
+
     // AbstractModelInterface stuff
     // the default implementation of the functions below do nothing
     inline void beforeLoop() override {}
     inline void afterLoop() override {}
     inline Values customOutputs(const Values& inputs) const override
     { Q_UNUSED(inputs); return Values(); }
+    inline bool saveState(QDataStream& out) const override
+    { Q_UNUSED(out); return true; }
+    inline bool restoreState(QDataStream& in) override
+    { Q_UNUSED(in); return true; }
 
 /**@}*/
 
@@ -148,5 +197,13 @@ inline const Edge& AbstractModel::edge(int edgeId) const
 inline const Edge &AbstractModel::edge(int originId, int neighbourId) const
 { return graph()->edge(originId, neighbourId); }
 
+template <typename T>
+inline AttrHandle<T> AbstractModel::nodeAttrHandle(const QString& name) const
+{ return graph()->nodeAttrHandle<T>(name); }
+
+template <typename T>
+inline AttrBuffer<T> AbstractModel::nodeAttrBuffer(const QString& name) const
+{ return graph()->nodeAttrBuffer<T>(name); }
+
 } // evoplex
 #endif // ABSTRACT_MODEL_H
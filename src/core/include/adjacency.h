@@ -0,0 +1,192 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "nodes.h"
+
+namespace evoplex {
+
+/**
+ * @brief A read-only view of the neighbours of a node.
+ * It points to a contiguous range of node ids (and the ids of the
+ * corresponding edges) stored in an Adjacency object. The neighbours
+ * computed on the fly (e.g., by a Lattice) are held by the view itself.
+ * @note The view is invalidated if the graph topology changes.
+ * @ingroup PublicAPI
+ */
+class Neighbours
+{
+    friend class Lattice;
+
+public:
+    //! Max number of neighbours held by the view itself.
+    static constexpr int kMaxInline = 8;
+
+    //! Constructs an empty range.
+    Neighbours() : m_ids(nullptr), m_edgeIds(nullptr), m_size(0), m_buf{} {}
+
+    /**
+     * @brief Constructor.
+     * @param ids A pointer to the first neighbour's id.
+     * @param edgeIds A pointer to the first edge's id.
+     * @param size The number of neighbours.
+     */
+    Neighbours(const int* ids, const int* edgeIds, int size)
+        : m_ids(ids), m_edgeIds(edgeIds), m_size(size), m_buf{} {}
+
+    /**
+     * @brief Gets a pointer to the first neighbour's id.
+     */
+    inline const int* begin() const { return m_ids ? m_ids : m_buf; }
+    /**
+     * @brief Gets a pointer past the last neighbour's id.
+     */
+    inline const int* end() const { return begin() + m_size; }
+
+    /**
+     * @brief Gets the number of neighbours.
+     */
+    inline int size() const { return m_size; }
+    /**
+     * @brief Checks if the node has no neighbours.
+     */
+    inline bool empty() const { return m_size == 0; }
+
+    /**
+     * @brief Gets the id of the \p i-th neighbour.
+     * @warning It does not check boundaries.
+     */
+    inline int operator[](int i) const { return begin()[i]; }
+
+    /**
+     * @brief Gets the id of the edge connecting the node to its \p i-th neighbour.
+     * @returns -1 if the neighbours are computed on the fly, i.e., there are no edges.
+     * @warning It does not check boundaries.
+     */
+    inline int edgeId(int i) const { return m_edgeIds ? m_edgeIds[i] : -1; }
+
+private:
+    const int* m_ids; // null if the ids are held in m_buf
+    const int* m_edgeIds;
+    int m_size;
+    int m_buf[kMaxInline];
+
+    inline void push(int id) { m_buf[m_size++] = id; }
+};
+
+/**
+ * @brief A compressed sparse row (CSR) representation of the graph.
+ *
+ * The neighbours of the node with id 'i' are stored contiguously in
+ * neighbourIds() from offsets()[i] to offsets()[i+1]; edgeIds() follows
+ * the same layout. Node ids without a node (e.g., removed nodes) have
+ * an empty range.
+ *
+ * It is a snapshot of the topology and does not change when edges are
+ * added or removed, it must be rebuilt instead.
+ * @see AbstractGraph::outNeighbours()
+ * @ingroup PublicAPI
+ */
+class Adjacency
+{
+public:
+    //! Constructor.
+    Adjacency() = default;
+
+    /**
+     * @brief Rebuilds the CSR arrays from the edges of \p nodes.
+     * @param nodes The set of nodes.
+     * @param outward Uses the outgoing edges if true; incoming otherwise.
+     */
+    void build(const Nodes& nodes, bool outward);
+
+    /**
+     * @brief Releases all the memory.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the neighbours of \p nodeId.
+     * @throw std::out_of_range if \p nodeId is not in the snapshot.
+     */
+    inline Neighbours neighbours(int nodeId) const;
+
+    /**
+     * @brief Gets the number of neighbours of \p nodeId.
+     * @throw std::out_of_range if \p nodeId is not in the snapshot.
+     */
+    inline int degree(int nodeId) const;
+
+    /**
+     * @brief Gets the number of node slots, i.e., the max node id + 1.
+     */
+    inline int numSlots() const;
+
+    /**
+     * @brief Gets the offsets (size numSlots()+1).
+     */
+    inline const std::vector<int>& offsets() const { return m_offsets; }
+    /**
+     * @brief Gets the neighbours' ids.
+     */
+    inline const std::vector<int>& neighbourIds() const { return m_neighbourIds; }
+    /**
+     * @brief Gets the edges' ids.
+     */
+    inline const std::vector<int>& edgeIds() const { return m_edgeIds; }
+
+private:
+    std::vector<int> m_offsets;
+    std::vector<int> m_neighbourIds;
+    std::vector<int> m_edgeIds;
+};
+
+//! A snapshot may be shared by the graphs of several trials.
+using AdjacencyPtr = std::shared_ptr<const Adjacency>;
+
+/************************************************************************
+   Adjacency: Inline member functions
+ ************************************************************************/
+
+inline int Adjacency::numSlots() const
+{ return m_offsets.empty() ? 0 : static_cast<int>(m_offsets.size()) - 1; }
+
+inline Neighbours Adjacency::neighbours(int nodeId) const
+{
+    if (nodeId < 0 || nodeId >= numSlots()) {
+        throw std::out_of_range("node id is not in the adjacency");
+    }
+    const size_t first = static_cast<size_t>(m_offsets[nodeId]);
+    return Neighbours(m_neighbourIds.data() + first, m_edgeIds.data() + first,
+                      m_offsets[nodeId+1] - m_offsets[nodeId]);
+}
+
+inline int Adjacency::degree(int nodeId) const
+{
+    if (nodeId < 0 || nodeId >= numSlots()) {
+        throw std::out_of_range("node id is not in the adjacency");
+    }
+    return m_offsets[nodeId+1] - m_offsets[nodeId];
+}
+
+} // evoplex
+#endif // ADJACENCY_H
@@ -0,0 +1,230 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ATTR_HANDLE_H
+#define ATTR_HANDLE_H
+
+#include <QtGlobal>
+
+#include "attributestable.h"
+#include "node.h"
+
+namespace evoplex {
+
+/**
+ * @brief Maps the C++ types to the typed storage of an AttributeColumn.
+ * It is specialized for bool, char, double and int.
+ */
+template <typename T>
+struct AttrTraits;
+
+template <>
+struct AttrTraits<bool> {
+    static constexpr Value::Type type = Value::BOOL;
+    static inline bool get(const AttributeColumn& c, size_t row) { return c.boolAt(row); }
+    static inline void set(AttributeColumn& c, size_t row, bool v) { c.setBoolAt(row, v); }
+};
+
+template <>
+struct AttrTraits<char> {
+    static constexpr Value::Type type = Value::CHAR;
+    static inline char get(const AttributeColumn& c, size_t row) { return c.charAt(row); }
+    static inline void set(AttributeColumn& c, size_t row, char v) { c.setCharAt(row, v); }
+};
+
+template <>
+struct AttrTraits<double> {
+    static constexpr Value::Type type = Value::DOUBLE;
+    static inline double get(const AttributeColumn& c, size_t row) { return c.doubleAt(row); }
+    static inline void set(AttributeColumn& c, size_t row, double v) { c.setDoubleAt(row, v); }
+};
+
+template <>
+struct AttrTraits<int> {
+    static constexpr Value::Type type = Value::INT;
+    static inline int get(const AttributeColumn& c, size_t row) { return c.intAt(row); }
+    static inline void set(AttributeColumn& c, size_t row, int v) { c.setIntAt(row, v); }
+};
+
+/**
+ * @brief A typed handle to one of the nodes' attributes.
+ *
+ * It is resolved once (e.g., in AbstractModel::init()) and reads and
+ * writes the typed column of the attribute directly, i.e., without
+ * creating Value objects or checking their types.
+ *
+ * @code
+ * AttrHandle<bool> live = graph()->nodeAttrHandle<bool>("live");
+ * if (live.isValid() && live.get(node)) { live.set(node, false); }
+ * @endcode
+ *
+ * @warning Writing a value of another type through Node::setAttr() turns
+ *          the column into a generic one and invalidates the handle.
+ *          It is only checked in debug builds.
+ * @see AbstractGraph::nodeAttrHandle()
+ * @ingroup PublicAPI
+ */
+template <typename T>
+class AttrHandle
+{
+    friend class AbstractGraph;
+
+public:
+    //! Constructs an invalid handle.
+    AttrHandle() : m_column(nullptr), m_attrId(-1) {}
+
+    /**
+     * @brief Checks if the handle points to a column of type T.
+     */
+    inline bool isValid() const { return m_column != nullptr; }
+
+    /**
+     * @brief Gets the id of the attribute.
+     */
+    inline int attrId() const { return m_attrId; }
+
+    /**
+     * @brief Gets the attribute of the node @p nodeId.
+     * @warning It does not check boundaries.
+     */
+    inline T get(int nodeId) const;
+    //! @copydoc get(int) const
+    inline T get(const Node& node) const { return get(node.id()); }
+
+    /**
+     * @brief Sets the attribute of the node @p nodeId.
+     * @warning It does not check boundaries.
+     */
+    inline void set(int nodeId, T value) const;
+    //! @copydoc set(int, T) const
+    inline void set(const Node& node, T value) const { set(node.id(), value); }
+
+private:
+    AttributeColumn* m_column;
+    int m_attrId;
+
+    AttrHandle(AttributeColumn* column, int attrId)
+        : m_column(column), m_attrId(attrId) {}
+};
+
+/**
+ * @brief A typed handle to a double-buffered nodes' attribute.
+ *
+ * It is meant for synchronous updates: get() reads the current values
+ * while setNext() writes the next ones into a back buffer, which is
+ * swapped with the current values in O(1) at the end of each step.
+ * Thus, there is no need for a temporary copy of the next states, and
+ * the nodes can be updated in parallel.
+ *
+ * @code
+ * AttrBuffer<bool> live = graph()->nodeAttrBuffer<bool>("live");
+ * for (Node node : nodes()) { live.setNext(node, !live.get(node)); }
+ * @endcode
+ *
+ * @note The back buffer is not refreshed before each step; it still holds
+ *       the values from before the last swap. Thus, a model must write
+ *       every node with setNext() in each step, or the nodes left out get
+ *       back the values they had two steps earlier. The values set through
+ *       Node::setAttr() between the steps are read by get() as usual.
+ * @see AbstractGraph::nodeAttrBuffer()
+ * @ingroup PublicAPI
+ */
+template <typename T>
+class AttrBuffer
+{
+    friend class AbstractGraph;
+
+public:
+    //! Constructs an invalid handle.
+    AttrBuffer() : m_front(nullptr), m_back(nullptr), m_attrId(-1) {}
+
+    /**
+     * @brief Checks if the handle points to a column of type T.
+     */
+    inline bool isValid() const { return m_front != nullptr; }
+
+    /**
+     * @brief Gets the id of the attribute.
+     */
+    inline int attrId() const { return m_attrId; }
+
+    /**
+     * @brief Gets the current attribute of the node @p nodeId.
+     * @warning It does not check boundaries.
+     */
+    inline T get(int nodeId) const;
+    //! @copydoc get(int) const
+    inline T get(const Node& node) const { return get(node.id()); }
+
+    /**
+     * @brief Sets the attribute of the node @p nodeId in the next step.
+     * @warning It does not check boundaries.
+     */
+    inline void setNext(int nodeId, T value) const;
+    //! @copydoc setNext(int, T) const
+    inline void setNext(const Node& node, T value) const { setNext(node.id(), value); }
+
+private:
+    AttributeColumn* m_front;
+    AttributeColumn* m_back;
+    int m_attrId;
+
+    AttrBuffer(AttributeColumn* front, AttributeColumn* back, int attrId)
+        : m_front(front), m_back(back), m_attrId(attrId) {}
+};
+
+/************************************************************************
+   AttrHandle: Inline member functions
+ ************************************************************************/
+
+template <typename T>
+inline T AttrHandle<T>::get(int nodeId) const
+{
+    Q_ASSERT_X(m_column && m_column->type() == AttrTraits<T>::type,
+               "AttrHandle", "invalid handle");
+    return AttrTraits<T>::get(*m_column, static_cast<size_t>(nodeId));
+}
+
+template <typename T>
+inline void AttrHandle<T>::set(int nodeId, T value) const
+{
+    Q_ASSERT_X(m_column && m_column->type() == AttrTraits<T>::type,
+               "AttrHandle", "invalid handle");
+    AttrTraits<T>::set(*m_column, static_cast<size_t>(nodeId), value);
+}
+
+/************************************************************************
+   AttrBuffer: Inline member functions
+ ************************************************************************/
+
+template <typename T>
+inline T AttrBuffer<T>::get(int nodeId) const
+{
+    Q_ASSERT_X(m_front && m_front->type() == AttrTraits<T>::type,
+               "AttrBuffer", "invalid handle");
+    return AttrTraits<T>::get(*m_front, static_cast<size_t>(nodeId));
+}
+
+template <typename T>
+inline void AttrBuffer<T>::setNext(int nodeId, T value) const
+{
+    Q_ASSERT_X(m_back && m_back->type() == AttrTraits<T>::type,
+               "AttrBuffer", "invalid handle");
+    AttrTraits<T>::set(*m_back, static_cast<size_t>(nodeId), value);
+}
+
+} // evoplex
+#endif // ATTR_HANDLE_H
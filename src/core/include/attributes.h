@@ -20,22 +20,87 @@
 #include <QPair>
 #include <QString>
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <stdint.h>
 
+#include "attributerange.h"
 #include "value.h"
 #include "utils.h"
 
 namespace evoplex {
 
 class Attributes;
+class AttributesSchema;
 using SetOfAttributes = std::vector<Attributes>;
+using AttributesSchemaPtr = std::shared_ptr<const AttributesSchema>;
+
+/**
+ * @brief The names and types of a set of attributes.
+ * A schema is immutable and shared by all the Attributes objects built
+ * from it, e.g., all nodes of a graph, so each of them only holds the values.
+ * The id of an attribute is its position in the schema.
+ */
+class AttributesSchema
+{
+    friend class Attributes;
+
+public:
+    /**
+     * @brief Constructor.
+     * @param names The attributes' names.
+     * @param types The attributes' types; Value::INVALID if unknown.
+     */
+    explicit AttributesSchema(std::vector<QString> names={},
+                              std::vector<Value::Type> types={});
+
+    /**
+     * @brief Creates a schema with the attributes in @p attrsScope,
+     *        sorted by their ids.
+     */
+    static AttributesSchemaPtr fromScope(const AttributesScope& attrsScope);
+
+    /**
+     * @brief Gets the number of attributes.
+     */
+    inline int size() const;
+    /**
+     * @brief Gets the name of all attributes.
+     */
+    inline const std::vector<QString>& names() const;
+    /**
+     * @brief Gets the name of the attribute at @p id.
+     * @throw std::out_of_range if the @p id is not present.
+     */
+    inline const QString& name(int id) const;
+    /**
+     * @brief Gets the type of the attribute at @p id.
+     * @throw std::out_of_range if the @p id is not present.
+     */
+    inline Value::Type type(int id) const;
+    /**
+     * @brief Returns the index position of @p name or -1 if not present.
+     */
+    inline int indexOf(const QString& name) const;
+
+    /**
+     * @brief Estimates the memory used by the schema, in bytes.
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::vector<QString> m_names;
+    std::vector<Value::Type> m_types;
+};
 
 /**
  * @brief A container of labeled values.
  * It offers fixed time access to individual elements in
  * any order by id and linear time by name.
+ *
+ * The names are held by an AttributesSchema, which is shared between
+ * copies; it is only copied when one of them changes a name.
  */
 class Attributes
 {
@@ -44,9 +109,14 @@ public:
      * @brief Constructor.
      * @param size The containers size.
      */
-    Attributes(int size) { resize(size); }
+    Attributes(int size) : m_ownSchema(nullptr) { resize(size); }
+    /**
+     * @brief Constructs a container with the attributes in @p schema.
+     * All values are set to Value().
+     */
+    explicit Attributes(AttributesSchemaPtr schema);
     //! Constructor.
-    Attributes() {}
+    Attributes() : m_ownSchema(nullptr) {}
 
     //! Destructor.
     ~Attributes() {}
@@ -151,11 +221,49 @@ public:
      */
     inline void setValue(int id, const Value& value);
 
+    /**
+     * @brief Gets the schema holding the attributes' names.
+     * @returns A null pointer if the container has never been resized.
+     */
+    inline AttributesSchemaPtr schema() const;
+
+    /**
+     * @brief Estimates the memory used by the container, in bytes.
+     * The shared schema is not included.
+     * @see AttributesSchema::memoryUsage()
+     */
+    size_t memoryUsage() const;
+
 private:
-    std::vector<QString> m_names;
+    AttributesSchemaPtr m_schema;
+    // the schema created by this container (or by the one it was copied
+    // from); a schema received from outside is never changed in place
+    AttributesSchema* m_ownSchema;
     std::vector<Value> m_values;
+
+    // gets the schema for writing; copies it if it is shared
+    AttributesSchema& detach();
 };
 
+/************************************************************************
+   AttributesSchema: Inline member functions
+ ************************************************************************/
+
+inline int AttributesSchema::size() const
+{ return static_cast<int>(m_names.size()); }
+
+inline const std::vector<QString>& AttributesSchema::names() const
+{ return m_names; }
+
+inline const QString& AttributesSchema::name(int id) const
+{ return m_names.at(static_cast<size_t>(id)); }
+
+inline Value::Type AttributesSchema::type(int id) const
+{ return m_types.at(static_cast<size_t>(id)); }
+
+inline int AttributesSchema::indexOf(const QString& name) const
+{ return Utils::indexOf(m_names, name); }
+
 
 /************************************************************************
    Attributes: Inline member functions
@@ -163,13 +271,16 @@ private:
 
 inline void Attributes::resize(int size) {
     size_t s = size < 0 ? 0 : static_cast<size_t>(size);
-    m_names.resize(s);
-    m_values.resize(s);
+    if (s != m_values.size()) {
+        AttributesSchema& schema = detach();
+        schema.m_names.resize(s);
+        schema.m_types.resize(s, Value::INVALID);
+        m_values.resize(s);
+    }
 }
 
 inline void Attributes::reserve(int size) {
     size_t s = size < 0 ? 0 : static_cast<size_t>(size);
-    m_names.reserve(s);
     m_values.reserve(s);
 }
 
@@ -177,13 +288,13 @@ inline int Attributes::size() const
 { return static_cast<int>(m_values.size()); }
 
 inline bool Attributes::isEmpty() const
-{ return m_names.empty(); }
+{ return m_values.empty(); }
 
 inline bool Attributes::empty() const
-{ return m_names.empty(); }
+{ return m_values.empty(); }
 
 inline int Attributes::indexOf(const QString& name) const
-{ return Utils::indexOf(m_names, name); }
+{ return m_schema ? m_schema->indexOf(name) : -1; }
 
 inline bool Attributes::contains(const QString& name) const
 { return indexOf(name) > -1; }
@@ -191,22 +302,32 @@ inline bool Attributes::contains(const QString& name) const
 inline void Attributes::replace(int id, QString newName, Value newValue) {
     if (id < 0) throw std::out_of_range("id must be positive!");
     size_t _id = static_cast<size_t>(id);
-    m_names.at(_id) = newName;
     m_values.at(_id) = newValue;
+    if (m_schema->m_names[_id] != newName) {
+        AttributesSchema& schema = detach();
+        schema.m_names[_id] = newName;
+        schema.m_types[_id] = newValue.type();
+    }
 }
 
 inline void Attributes::push_back(QString name, Value value) {
-    m_names.emplace_back(name);
+    AttributesSchema& schema = detach();
+    schema.m_names.emplace_back(name);
+    schema.m_types.emplace_back(value.type());
     m_values.emplace_back(value);
-    if (m_names.size() >= INT32_MAX)
+    if (m_values.size() >= INT32_MAX)
         throw std::length_error("too many attributes");
 }
 
-inline const std::vector<QString>& Attributes::names() const
-{ return m_names; }
+inline const std::vector<QString>& Attributes::names() const {
+    static const std::vector<QString> kEmpty;
+    return m_schema ? m_schema->m_names : kEmpty;
+}
 
-inline const QString& Attributes::name(int id) const
-{ return m_names.at(id); }
+inline const QString& Attributes::name(int id) const {
+    if (!m_schema) throw std::out_of_range("the container is empty!");
+    return m_schema->name(id);
+}
 
 inline const std::vector<Value>& Attributes::values() const
 { return m_values; }
@@ -224,5 +345,8 @@ inline void Attributes::setValue(int id, const Value& value) {
     m_values.at(static_cast<size_t>(id)) = value;
 }
 
+inline AttributesSchemaPtr Attributes::schema() const
+{ return m_schema; }
+
 } // evoplex
 #endif // ATTRIBUTES_H
@@ -0,0 +1,414 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ATTRIBUTES_TABLE_H
+#define ATTRIBUTES_TABLE_H
+
+#include <QtGlobal>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "attributes.h"
+#include "value.h"
+
+class QDataStream;
+
+namespace evoplex {
+
+/**
+ * @brief A contiguous array holding one attribute of a set of entities.
+ *
+ * The values are stored according to the column's type(): booleans are
+ * bit-packed, chars, doubles and integers are stored in plain arrays and
+ * strings are interned, i.e., each row holds the index of a unique string.
+ *
+ * Writing a value of a different type turns the column into a generic
+ * one (type() == Value::INVALID), which stores an array of Value objects.
+ *
+ * @note Rows of a bool column share 64-bit words, so concurrent writes
+ *       must not touch the same word.
+ * @ingroup PublicAPI
+ */
+class AttributeColumn
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param type The type of the values; Value::INVALID for a generic column.
+     */
+    explicit AttributeColumn(Value::Type type=Value::INVALID);
+
+    /**
+     * @brief Gets the type of the values in the column.
+     * @returns Value::INVALID if it is a generic column.
+     */
+    inline Value::Type type() const { return m_type; }
+    /**
+     * @brief Checks if the column holds Value objects of any type.
+     */
+    inline bool isGeneric() const { return m_type == Value::INVALID; }
+    /**
+     * @brief Gets the number of rows.
+     */
+    inline size_t size() const { return m_size; }
+
+    /**
+     * @brief Resizes the column to \p numRows.
+     * The new rows are default-initialized (e.g., false, 0, empty string).
+     */
+    void resize(size_t numRows);
+
+    /**
+     * @brief Reserves memory for \p numRows.
+     */
+    void reserve(size_t numRows);
+
+    /**
+     * @brief Gets the value at \p row.
+     * @warning It does not check boundaries.
+     */
+    Value value(size_t row) const;
+
+    /**
+     * @brief Sets the value at \p row.
+     * If the type of \p value differs from type(), the column becomes generic.
+     * @warning It does not check boundaries.
+     */
+    void setValue(size_t row, const Value& value);
+
+    /**
+     * @name Typed accessors
+     * They do not check boundaries or type(); they are meant for linear scans.
+     * @see AttrHandle
+     */
+    ///@{
+    inline bool boolAt(size_t row) const;
+    inline char charAt(size_t row) const { return m_chars[row]; }
+    inline double doubleAt(size_t row) const { return m_doubles[row]; }
+    inline int intAt(size_t row) const { return m_ints[row]; }
+    inline const Value& stringAt(size_t row) const;
+    inline const Value& genericAt(size_t row) const { return m_generic[row]; }
+
+    inline void setBoolAt(size_t row, bool value);
+    inline void setCharAt(size_t row, char value) { m_chars[row] = value; }
+    inline void setDoubleAt(size_t row, double value) { m_doubles[row] = value; }
+    inline void setIntAt(size_t row, int value) { m_ints[row] = value; }
+
+    //! The bit-packed booleans; row 'i' is the bit (i % 64) of the word (i / 64).
+    inline const std::vector<quint64>& bools() const { return m_bits; }
+    inline const std::vector<char>& chars() const { return m_chars; }
+    inline const std::vector<double>& doubles() const { return m_doubles; }
+    inline const std::vector<qint32>& ints() const { return m_ints; }
+    //! The index of each row in strings().
+    inline const std::vector<qint32>& stringIds() const { return m_ints; }
+    //! The unique strings in the column.
+    inline const std::vector<Value>& strings() const { return m_strings; }
+    inline const std::vector<Value>& generics() const { return m_generic; }
+    ///@}
+
+    /**
+     * @brief Swaps the content of two columns in O(1).
+     */
+    void swap(AttributeColumn& other);
+
+    /**
+     * @brief Counts how many of the \p rows hold each value in \p header.
+     * @param rows A mask of the rows to be considered; all rows if empty.
+     */
+    std::vector<int> count(const Values& header, const std::vector<bool>& rows) const;
+
+    /**
+     * @brief Estimates the memory used by the column, in bytes.
+     */
+    size_t memoryUsage() const;
+
+private:
+    friend QDataStream& operator<<(QDataStream& out, const AttributeColumn& col);
+    friend QDataStream& operator>>(QDataStream& in, AttributeColumn& col);
+
+    Value::Type m_type;
+    size_t m_size;
+    std::vector<quint64> m_bits;
+    std::vector<char> m_chars;
+    std::vector<double> m_doubles;
+    std::vector<qint32> m_ints; // integers or string ids
+    std::vector<Value> m_strings;
+    std::unordered_map<Value, qint32> m_stringIds;
+    std::vector<Value> m_generic;
+
+    qint32 intern(const Value& value);
+    void toGeneric();
+};
+
+/**
+ * @brief A struct-of-arrays store of the attributes of a set of entities.
+ *
+ * It holds one AttributeColumn per attribute name, and each entity is
+ * a row. Rows can be added or removed at any position; removed rows are
+ * kept as invalid until they are reused.
+ *
+ * Copying a table is cheap: the copy shares the columns with the original
+ * one, and a column is only copied when either table writes to it.
+ * @see AbstractGraph::nodeAttrsTable()
+ * @ingroup PublicAPI
+ */
+class AttributesTable
+{
+public:
+    //! Constructs an empty table with no columns.
+    AttributesTable() : m_size(0) {}
+
+    /**
+     * @brief Constructs an empty table.
+     * It has one column for each attribute in \p sample, with the type
+     * of the corresponding value.
+     */
+    explicit AttributesTable(const Attributes& sample);
+
+    /**
+     * @brief Copy constructor.
+     * The columns are shared (copy-on-write), but for the ones accessed
+     * through the non-const column(), which are copied straight away.
+     * The back buffers are not copied.
+     */
+    AttributesTable(const AttributesTable& other);
+    //! @copydoc AttributesTable(const AttributesTable&)
+    AttributesTable& operator=(const AttributesTable& other);
+    AttributesTable(AttributesTable&&) = default;
+    AttributesTable& operator=(AttributesTable&&) = default;
+
+    /**
+     * @brief Gets the number of columns.
+     */
+    inline int numColumns() const { return static_cast<int>(m_columns.size()); }
+    /**
+     * @brief Gets the name of all columns.
+     */
+    inline const std::vector<QString>& names() const;
+    /**
+     * @brief Gets the index of the column \p name or -1 if it is not present.
+     */
+    inline int indexOf(const QString& name) const;
+    /**
+     * @brief Gets the schema shared by the rows of the table.
+     */
+    inline AttributesSchemaPtr schema() const { return m_schema; }
+
+    /**
+     * @brief Gets the column \p col.
+     * @throw std::out_of_range if \p col is not present.
+     */
+    inline const AttributeColumn& column(int col) const;
+    /**
+     * @copydoc column
+     * If the column is shared with another table, it is copied first.
+     * The returned reference remains valid even if the table is copied.
+     */
+    inline AttributeColumn& column(int col);
+
+    /**
+     * @brief Gets the back buffer of the column \p col.
+     * The back buffer holds the next values of a synchronous update,
+     * so that the column can be read while the next values are written.
+     * It is created on the first call as a copy of the column.
+     * @throw std::out_of_range if \p col is not present.
+     * @see swapBuffers()
+     */
+    AttributeColumn& backColumn(int col);
+    /**
+     * @brief Checks if the column \p col has a back buffer.
+     */
+    inline bool hasBackColumn(int col) const;
+    /**
+     * @brief Swaps each column that has a back buffer with it, in O(1).
+     * Afterwards, the back buffers hold the values from before the swap;
+     * they are not refreshed, so all rows must be written again before
+     * the next swap.
+     */
+    void swapBuffers();
+
+    /**
+     * @brief Gets the number of rows, including the invalid ones.
+     */
+    inline size_t numRows() const { return m_valid.size(); }
+    /**
+     * @brief Gets the number of valid rows.
+     */
+    inline size_t size() const { return m_size; }
+    /**
+     * @brief Checks if \p row holds the attributes of an entity.
+     */
+    inline bool isValidRow(size_t row) const { return row < m_valid.size() && m_valid[row]; }
+    /**
+     * @brief Gets the mask of valid rows.
+     */
+    inline const std::vector<bool>& validRows() const { return m_valid; }
+
+    /**
+     * @brief Checks if \p attrs can be stored in the table, i.e.,
+     *        if it has the same attribute names of the table.
+     */
+    bool matches(const Attributes& attrs) const;
+
+    /**
+     * @brief Reserves memory for \p numRows rows.
+     */
+    void reserve(size_t numRows);
+
+    /**
+     * @brief Stores \p attrs in the \p row, growing the table if needed.
+     * @throw std::invalid_argument if \p attrs does not match the table.
+     */
+    void insertRow(size_t row, const Attributes& attrs);
+
+    /**
+     * @brief Flags \p row as invalid.
+     */
+    void removeRow(size_t row);
+
+    /**
+     * @brief Drops the invalid rows at the end of the table.
+     * The other invalid rows are kept, as the rows are addressed by
+     * position (e.g., the node id) and thus cannot be moved.
+     */
+    void squeeze();
+
+    /**
+     * @brief Gets a copy of the attributes stored in \p row.
+     */
+    Attributes row(size_t row) const;
+
+    /**
+     * @brief Gets the value at \p row and \p col.
+     * @throw std::out_of_range if \p col is not present.
+     */
+    inline Value value(size_t row, int col) const;
+
+    /**
+     * @brief Sets the value at \p row and \p col.
+     * If the column is shared with another table, it is copied first.
+     * @warning Copying a shared column is not thread-safe; call detachAll()
+     *          before setting values from multiple threads.
+     * @throw std::out_of_range if \p col is not present.
+     */
+    inline void setValue(size_t row, int col, const Value& value);
+
+    /**
+     * @brief Copies all columns shared with other tables.
+     * Afterwards, setValue() writes to the rows in place, so that distinct
+     * rows can be set from multiple threads.
+     */
+    void detachAll();
+
+    /**
+     * @brief Estimates the memory used by the table, in bytes.
+     * It includes the shared schema and the columns shared with other tables.
+     */
+    size_t memoryUsage() const;
+
+private:
+    friend QDataStream& operator<<(QDataStream& out, const AttributesTable& table);
+    friend QDataStream& operator>>(QDataStream& in, AttributesTable& table);
+
+    AttributesSchemaPtr m_schema;
+    std::vector<std::shared_ptr<AttributeColumn>> m_columns;
+    // columns handed out for writing; they are never shared again,
+    // so the references kept by the callers (e.g., AttrHandle) stay valid
+    std::vector<bool> m_pinned;
+    // the back buffers; null if the column has none
+    std::vector<std::unique_ptr<AttributeColumn>> m_backColumns;
+    std::vector<bool> m_valid;
+    size_t m_size; // number of valid rows
+
+    // gets the column for writing; copies it if it is shared
+    AttributeColumn& detach(size_t col);
+};
+
+/**
+ * @brief Writes the typed storage of \p col to the stream \p out.
+ */
+QDataStream& operator<<(QDataStream& out, const AttributeColumn& col);
+/**
+ * @brief Reads a column written by operator<<() from the stream \p in.
+ */
+QDataStream& operator>>(QDataStream& in, AttributeColumn& col);
+
+/**
+ * @brief Writes the names, the rows and the columns of \p table,
+ *        including their back buffers, to the stream \p out.
+ */
+QDataStream& operator<<(QDataStream& out, const AttributesTable& table);
+/**
+ * @brief Reads a table written by operator<<() from the stream \p in.
+ * The table gets a new schema and columns that are not shared.
+ */
+QDataStream& operator>>(QDataStream& in, AttributesTable& table);
+
+/************************************************************************
+   AttributeColumn: Inline member functions
+ ************************************************************************/
+
+inline bool AttributeColumn::boolAt(size_t row) const
+{ return (m_bits[row >> 6] >> (row & 63)) & 1u; }
+
+inline void AttributeColumn::setBoolAt(size_t row, bool value)
+{
+    const quint64 mask = quint64(1) << (row & 63);
+    if (value) {
+        m_bits[row >> 6] |= mask;
+    } else {
+        m_bits[row >> 6] &= ~mask;
+    }
+}
+
+inline const Value& AttributeColumn::stringAt(size_t row) const
+{ return m_strings[static_cast<size_t>(m_ints[row])]; }
+
+/************************************************************************
+   AttributesTable: Inline member functions
+ ************************************************************************/
+
+inline const std::vector<QString>& AttributesTable::names() const
+{
+    static const std::vector<QString> kEmpty;
+    return m_schema ? m_schema->names() : kEmpty;
+}
+
+inline int AttributesTable::indexOf(const QString& name) const
+{ return m_schema ? m_schema->indexOf(name) : -1; }
+
+inline const AttributeColumn& AttributesTable::column(int col) const
+{ return *m_columns.at(static_cast<size_t>(col)); }
+
+inline AttributeColumn& AttributesTable::column(int col)
+{
+    AttributeColumn& c = detach(static_cast<size_t>(col));
+    m_pinned[static_cast<size_t>(col)] = true;
+    return c;
+}
+
+inline bool AttributesTable::hasBackColumn(int col) const
+{ return m_backColumns.at(static_cast<size_t>(col)) != nullptr; }
+
+inline Value AttributesTable::value(size_t row, int col) const
+{ return column(col).value(row); }
+
+inline void AttributesTable::setValue(size_t row, int col, const Value& value)
+{ detach(static_cast<size_t>(col)).setValue(row, value); }
+
+} // evoplex
+#endif // ATTRIBUTES_TABLE_H
@@ -57,6 +57,10 @@
 #define GENERAL_ATTR_GRAPHTYPE "graphType"
 //! a command to AttrsGenerator
 #define GENERAL_ATTR_EDGEATTRS "edgeAttrs"
+//! step at which the trials are forked from trial 0; 0 to disable it
+#define GENERAL_ATTR_FORKAT "forkAt"
+//! a condition to stop the trials earlier; see StopCondition
+#define GENERAL_ATTR_STOPWHEN "stopWhen"
 
 //! path to the directory in which the file will be saved
 #define OUTPUT_DIR "outputDirectory"
@@ -102,6 +106,8 @@
 #define PLUGIN_ATTR_VALIDGRAPHTYPES "validGraphTypes"
 //! true if the graph supports edge attributes generator
 #define PLUGIN_ATTR_EDGEATTRSGEN "supportsEdgeAttrsGen"
+//! true if the graph always creates the same edges for the same inputs
+#define PLUGIN_ATTR_DETERMINISTIC "deterministic"
 
 //! @}
 #endif // CONSTANTS_H
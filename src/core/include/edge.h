@@ -17,34 +17,28 @@
 #ifndef EDGE_H
 #define EDGE_H
 
-#include <memory>
-#include <unordered_map>
-
 #include "attributes.h"
 
 namespace evoplex {
 
 class Node;
 class BaseEdge;
-using EdgePtr = std::shared_ptr<BaseEdge>;
 
 /**
  * @brief An Edge connects a Node to itself or to another Node.
- * This class wraps a std::shared_ptr<BaseEdge>.
+ * This class is a lightweight handle to a BaseEdge record, which is
+ * owned by the graph and shared by both directions of the edge.
  * @note An edge should be created by an AbstractGraph derived object.
+ * @warning The handle is invalidated when the edge is removed from the graph.
  * @ingroup PublicAPI
  */
 class Edge
 {
     friend class AbstractGraph;
     friend class TestEdge;
+    friend class TestAdjacency;
 
 public:
-    /**
-     * @brief Constructor.
-     * @param edge std::shared_ptr<BaseEdge>
-     */
-    Edge(EdgePtr edge);
     /**
      * @brief Constructor to ease range-based for loops.
      * @param p A pair <edgeId, Edge>.
@@ -53,12 +47,17 @@ public:
     //! Constructor.
     Edge();
 
+    /**
+     * @brief Checks if the current Edge is null.
+     */
+    inline bool isNull() const;
+
     //! @copydoc BaseEdge::id
     int id() const;
     //! @copydoc BaseEdge::origin
-    const Node& origin() const;
+    Node origin() const;
     //! @copydoc BaseEdge::neighbour
-    const Node& neighbour() const;
+    Node neighbour() const;
 
     //! @copydoc BaseEdge::attrs
     const Attributes* attrs() const;
@@ -73,8 +72,23 @@ public:
     void addAttr(QString name, Value value);
 
 private:
-    EdgePtr m_ptr;
+    BaseEdge* m_ptr;
+    bool m_reversed; // true if it goes from the record's neighbour to its origin
+
+    /**
+     * @brief Constructor.
+     * @param edge The edge's record.
+     * @param reversed If true, the handle goes from neighbour to origin.
+     */
+    explicit Edge(BaseEdge* edge, bool reversed=false);
 };
 
+/************************************************************************
+   Edge: Inline member functions
+ ************************************************************************/
+
+inline bool Edge::isNull() const
+{ return !m_ptr; }
+
 } // evoplex
 #endif // EDGE_H
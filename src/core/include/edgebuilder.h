@@ -0,0 +1,143 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef EDGE_BUILDER_H
+#define EDGE_BUILDER_H
+
+#include <functional>
+#include <vector>
+
+#include "attributes.h"
+
+namespace evoplex {
+
+class AbstractGraph;
+
+/**
+ * @brief Collects the edges created by a single thread.
+ * @see EdgeBuilder
+ * @ingroup PublicAPI
+ */
+class EdgeBuffer
+{
+    friend class AbstractGraph;
+
+public:
+    /**
+     * @brief Appends an edge from \p originId to \p neighbourId.
+     * The ids are only checked by EdgeBuilder::commit().
+     */
+    inline void add(int originId, int neighbourId, Attributes attrs=Attributes());
+
+    /**
+     * @brief Reserves memory for \p numEdges edges.
+     */
+    inline void reserve(size_t numEdges) { m_entries.reserve(numEdges); }
+
+    /**
+     * @brief Gets the number of edges in the buffer.
+     */
+    inline size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        int originId;
+        int neighbourId;
+        Attributes attrs;
+    };
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Creates the edges of a graph in bulk.
+ *
+ * The edges are appended to one EdgeBuffer per thread, with no locking,
+ * and added to the graph at once by commit(), which takes the graph's
+ * mutex and allocates the memory for all edges a single time.
+ *
+ * The edges are added in the order of the buffers, so the edges' ids do
+ * not depend on the number of threads as long as each buffer holds a
+ * contiguous chunk of the work.
+ *
+ * @code
+ * EdgeBuilder builder(this);
+ * builder.run([this](int chunk, int numChunks, EdgeBuffer& buffer) {
+ *     const int first = chunk * numNodes() / numChunks;
+ *     const int last = (chunk + 1) * numNodes() / numChunks;
+ *     for (int id = first; id < last; ++id) { buffer.add(id, ...); }
+ * });
+ * builder.commit();
+ * @endcode
+ * @see AbstractGraph::addEdge()
+ * @ingroup PublicAPI
+ */
+class EdgeBuilder
+{
+public:
+    //! A task filling the buffer of one of the chunks.
+    using Task = std::function<void(int chunk, int numChunks, EdgeBuffer& buffer)>;
+
+    /**
+     * @brief Constructor.
+     * @param graph The graph which will receive the edges.
+     * @param numBuffers The number of buffers; QThread::idealThreadCount() if < 1.
+     */
+    explicit EdgeBuilder(AbstractGraph* graph, int numBuffers=0);
+
+    /**
+     * @brief Gets the number of buffers.
+     */
+    inline int numBuffers() const { return static_cast<int>(m_buffers.size()); }
+
+    /**
+     * @brief Gets the buffer \p i.
+     * @throw std::out_of_range if \p i is not a valid buffer.
+     */
+    inline EdgeBuffer& buffer(int i) { return m_buffers.at(static_cast<size_t>(i)); }
+
+    /**
+     * @brief Reserves memory for \p numEdges, evenly spread over the buffers.
+     */
+    void reserve(int numEdges);
+
+    /**
+     * @brief Runs \p task once for each buffer, in parallel, and waits
+     *        for all of them to finish.
+     */
+    void run(const Task& task);
+
+    /**
+     * @brief Adds the edges of all buffers into the graph and clears them.
+     * @returns false if some edge refers to a node not in the graph;
+     *          no edge is added in that case.
+     */
+    bool commit();
+
+private:
+    AbstractGraph* m_graph;
+    std::vector<EdgeBuffer> m_buffers;
+};
+
+/************************************************************************
+   EdgeBuffer: Inline member functions
+ ************************************************************************/
+
+inline void EdgeBuffer::add(int originId, int neighbourId, Attributes attrs)
+{ m_entries.push_back({originId, neighbourId, std::move(attrs)}); }
+
+} // evoplex
+#endif // EDGE_BUILDER_H
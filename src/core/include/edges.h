@@ -17,34 +17,34 @@
 #ifndef EDGES_H
 #define EDGES_H
 
-#include <unordered_map>
-
 #include "edge.h"
+#include "idmap.h"
 
 namespace evoplex {
 
 /**
  * @brief An Edge container.
- * It is an unordered_map with the edge's id as the key.
+ * It is an IdMap with the edge's id as the key.
  * @see Edge
  * @ingroup PublicAPI
  */
-class Edges : private std::unordered_map<int, Edge>
+class Edges : private IdMap<Edge>
 {
     friend class AbstractGraph;
+    friend class BaseNode;
     friend class DNode;
     friend class UNode;
 
 public:
-    using std::unordered_map<int, Edge>::at;
-    using std::unordered_map<int, Edge>::begin;
-    using std::unordered_map<int, Edge>::cbegin;
-    using std::unordered_map<int, Edge>::end;
-    using std::unordered_map<int, Edge>::cend;
-    using std::unordered_map<int, Edge>::iterator;
-    using std::unordered_map<int, Edge>::const_iterator;
-    using std::unordered_map<int, Edge>::empty;
-    using std::unordered_map<int, Edge>::size;
+    using IdMap<Edge>::at;
+    using IdMap<Edge>::begin;
+    using IdMap<Edge>::cbegin;
+    using IdMap<Edge>::end;
+    using IdMap<Edge>::cend;
+    using IdMap<Edge>::iterator;
+    using IdMap<Edge>::const_iterator;
+    using IdMap<Edge>::empty;
+    using IdMap<Edge>::size;
 };
 
 } // evoplex
@@ -0,0 +1,490 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IDMAP_H
+#define IDMAP_H
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace evoplex {
+
+/**
+ * @brief A container of Node or Edge objects keyed by their ids.
+ *
+ * The elements are stored contiguously in a vector of slots. While the ids
+ * are contiguous (i.e., 0..n-1), the container is in the dense mode: the
+ * slot of an element is its id, so the lookup is a plain array access and
+ * the iteration follows the id order.
+ *
+ * Removing an element leaves a tombstone (a null element) in its slot, so
+ * that removals do not invalidate the iterators. If an element is inserted
+ * with an id that does not fit in the dense layout, the container switches
+ * to the sparse mode: the slots are packed in insertion order and the ids
+ * are resolved by a linear scan (for few elements) or by a hash index.
+ * squeeze() switches it back to the dense mode once the ids fit again.
+ *
+ * @tparam T The element type. A default-constructed T must be null and
+ *           T::isNull() must tell it apart from a valid element.
+ */
+template <class T>
+class IdMap
+{
+public:
+    using key_type = int;
+    using mapped_type = T;
+    using value_type = std::pair<const int, T>;
+    using size_type = size_t;
+
+    /**
+     * @brief A forward iterator that skips the tombstones.
+     */
+    template <bool IsConst>
+    class Iterator
+    {
+        friend class IdMap;
+        using Pair = std::pair<const int, T>;
+        using Ptr = typename std::conditional<IsConst, const Pair*, Pair*>::type;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Pair;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Ptr;
+        using reference = typename std::conditional<IsConst, const Pair&, Pair&>::type;
+
+        Iterator() : m_it(nullptr), m_end(nullptr) {}
+        Iterator(Ptr it, Ptr end) : m_it(it), m_end(end) { skipTombstones(); }
+        //! Converts an iterator into a const_iterator.
+        template <bool C = IsConst, class = typename std::enable_if<C>::type>
+        Iterator(const Iterator<false>& it) : m_it(it.m_it), m_end(it.m_end) {}
+
+        inline reference operator*() const { return *m_it; }
+        inline pointer operator->() const { return m_it; }
+        inline Iterator& operator++() { ++m_it; skipTombstones(); return *this; }
+        inline Iterator operator++(int) { Iterator i(*this); ++(*this); return i; }
+        inline bool operator==(const Iterator& i) const { return m_it == i.m_it; }
+        inline bool operator!=(const Iterator& i) const { return m_it != i.m_it; }
+
+    private:
+        friend class Iterator<true>;
+        Ptr m_it;
+        Ptr m_end;
+
+        inline void skipTombstones()
+        { while (m_it != m_end && m_it->second.isNull()) { ++m_it; } }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    //! Constructor.
+    IdMap() : m_size(0), m_dense(true) {}
+    //! Copy constructor.
+    IdMap(const IdMap&) = default;
+    //! Move constructor.
+    IdMap(IdMap&&) = default;
+    //! Assignment operator; the elements are not assignable.
+    IdMap& operator=(IdMap other) { swap(other); return *this; }
+
+    inline iterator begin() { return iterator(first(), last()); }
+    inline const_iterator begin() const { return cbegin(); }
+    inline const_iterator cbegin() const { return const_iterator(first(), last()); }
+    inline iterator end() { return iterator(last(), last()); }
+    inline const_iterator end() const { return cend(); }
+    inline const_iterator cend() const { return const_iterator(last(), last()); }
+
+    /**
+     * @brief Checks if the container has no elements.
+     */
+    inline bool empty() const { return m_size == 0; }
+    /**
+     * @brief Gets the number of elements.
+     */
+    inline size_t size() const { return m_size; }
+
+    /**
+     * @brief Gets the element with id \p id.
+     * @throw std::out_of_range if no such data is present.
+     */
+    inline T& at(int id);
+    //! @copydoc at
+    inline const T& at(int id) const;
+
+    /**
+     * @brief Finds the element with id \p id.
+     * @returns end() if no such data is present.
+     */
+    inline iterator find(int id);
+    //! @copydoc find
+    inline const_iterator find(int id) const;
+
+    /**
+     * @brief Returns 1 if \p id is present; 0 otherwise.
+     */
+    inline size_t count(int id) const { return slotOf(id) == npos ? 0 : 1; }
+
+    /**
+     * @brief Inserts the pair <id, element> if its id is not present.
+     * @returns An iterator to the element with such id and true
+     *          if it has been inserted.
+     * @note It may invalidate the iterators.
+     */
+    std::pair<iterator, bool> insert(const value_type& v);
+
+    /**
+     * @brief Removes the element with id \p id.
+     * It does not invalidate the iterators.
+     * @returns The number of elements removed (0 or 1).
+     */
+    size_t erase(int id);
+
+    /**
+     * @brief Removes the element pointed by \p it.
+     * It does not invalidate the iterators.
+     * @returns An iterator to the following element.
+     */
+    iterator erase(const_iterator it);
+
+    /**
+     * @brief Removes all elements and goes back to the dense mode.
+     */
+    void clear();
+
+    /**
+     * @brief Reserves slots for at least \p n elements.
+     */
+    inline void reserve(size_t n) { m_slots.reserve(n); }
+
+    /**
+     * @brief Swaps the content of two containers.
+     */
+    void swap(IdMap& other);
+
+    /**
+     * @brief Checks if the slot of each element is its id.
+     */
+    inline bool isDense() const { return m_dense; }
+
+    /**
+     * @brief Gets the number of slots, including the tombstones.
+     */
+    inline size_t numSlots() const { return m_slots.size(); }
+
+    /**
+     * @brief Gets the content of the \p i-th slot.
+     * The element is null if the slot is a tombstone.
+     * @warning It does not check boundaries.
+     */
+    inline const value_type& slot(size_t i) const { return m_slots[i]; }
+
+    /**
+     * @brief Gets the \p k-th element in the iteration order.
+     * It is O(1) when there is no tombstone; O(n) otherwise.
+     * @warning It does not check boundaries.
+     */
+    inline const value_type& nth(size_t k) const;
+
+    /**
+     * @brief Gets a random element.
+     * It draws slots until it finds an element, so it takes
+     * numSlots() / size() draws on average.
+     * @param draw A function returning a uniform integer in [0, n].
+     * @warning The container must not be empty.
+     */
+    template <class Draw>
+    inline const value_type& randElement(Draw draw) const;
+
+    /**
+     * @brief Removes the tombstones.
+     * If the ids fit in a dense layout with no more tombstones than
+     * elements, the container is (or goes back to) the dense mode, whose
+     * slots are the ids. Otherwise, the slots are packed in the current
+     * order and the container becomes sparse.
+     */
+    void squeeze();
+
+private:
+    static const size_t npos = static_cast<size_t>(-1);
+    // max number of slots to resolve an id by a linear scan
+    static const size_t kMaxLinearScan = 16;
+
+    std::vector<value_type> m_slots;
+    std::unordered_map<int, size_t> m_index; // id -> slot (sparse mode only)
+    size_t m_size; // number of elements (i.e., excluding tombstones)
+    bool m_dense;
+
+    inline value_type* first() { return m_slots.data(); }
+    inline const value_type* first() const { return m_slots.data(); }
+    inline value_type* last() { return m_slots.data() + m_slots.size(); }
+    inline const value_type* last() const { return m_slots.data() + m_slots.size(); }
+
+    // gets the slot of a valid element or npos if not found
+    inline size_t slotOf(int id) const;
+
+    // packs the slots in the current order, dropping the tombstones
+    void pack();
+
+    // moves each element to the slot of its id if the ids fit in a
+    // dense layout that is at most half tombstones; true if it did so
+    bool densify();
+};
+
+/************************************************************************
+   IdMap: Inline member functions
+ ************************************************************************/
+
+template <class T>
+inline size_t IdMap<T>::slotOf(int id) const
+{
+    if (m_dense) {
+        const size_t i = static_cast<size_t>(id);
+        return (id >= 0 && i < m_slots.size() && !m_slots[i].second.isNull()) ? i : npos;
+    }
+    if (m_slots.size() <= kMaxLinearScan) {
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            if (m_slots[i].first == id && !m_slots[i].second.isNull()) {
+                return i;
+            }
+        }
+        return npos;
+    }
+    auto it = m_index.find(id);
+    return it == m_index.end() ? npos : it->second;
+}
+
+template <class T>
+inline T& IdMap<T>::at(int id)
+{
+    const size_t i = slotOf(id);
+    if (i == npos) {
+        throw std::out_of_range("IdMap::at: no such id");
+    }
+    return m_slots[i].second;
+}
+
+template <class T>
+inline const T& IdMap<T>::at(int id) const
+{
+    const size_t i = slotOf(id);
+    if (i == npos) {
+        throw std::out_of_range("IdMap::at: no such id");
+    }
+    return m_slots[i].second;
+}
+
+template <class T>
+inline typename IdMap<T>::iterator IdMap<T>::find(int id)
+{
+    const size_t i = slotOf(id);
+    return i == npos ? end() : iterator(first() + i, last());
+}
+
+template <class T>
+inline typename IdMap<T>::const_iterator IdMap<T>::find(int id) const
+{
+    const size_t i = slotOf(id);
+    return i == npos ? cend() : const_iterator(first() + i, last());
+}
+
+template <class T>
+inline const typename IdMap<T>::value_type& IdMap<T>::nth(size_t k) const
+{
+    if (m_size == m_slots.size()) {
+        return m_slots[k];
+    }
+    auto it = cbegin();
+    std::advance(it, k);
+    return *it;
+}
+
+template <class T>
+template <class Draw>
+inline const typename IdMap<T>::value_type& IdMap<T>::randElement(Draw draw) const
+{
+    const size_t lastSlot = m_slots.size() - 1;
+    while (true) {
+        const value_type& s = m_slots[static_cast<size_t>(draw(lastSlot))];
+        if (!s.second.isNull()) {
+            return s;
+        }
+    }
+}
+
+/************************************************************************
+   IdMap: Member functions
+ ************************************************************************/
+
+template <class T>
+std::pair<typename IdMap<T>::iterator, bool> IdMap<T>::insert(const value_type& v)
+{
+    const size_t existing = slotOf(v.first);
+    if (existing != npos) {
+        return {iterator(first() + existing, last()), false};
+    }
+
+    if (m_dense) {
+        const size_t i = static_cast<size_t>(v.first);
+        if (v.first >= 0 && i < m_slots.size()) { // reuse a tombstone
+            m_slots[i].second = v.second;
+            ++m_size;
+            return {iterator(first() + i, last()), true};
+        } else if (i == m_slots.size()) {
+            m_slots.emplace_back(v);
+            ++m_size;
+            return {iterator(last() - 1, last()), true};
+        }
+        // the id does not fit in the dense layout
+        pack();
+        m_dense = false;
+    } else if (m_slots.size() - m_size > m_size) {
+        pack(); // too many tombstones
+    }
+
+    m_slots.emplace_back(v);
+    ++m_size;
+    if (m_slots.size() > kMaxLinearScan) {
+        if (m_index.empty()) {
+            // the tombstones are left out; a re-inserted id must map to its new slot
+            for (size_t i = 0; i < m_slots.size(); ++i) {
+                if (!m_slots[i].second.isNull()) {
+                    m_index.insert({m_slots[i].first, i});
+                }
+            }
+        } else {
+            m_index.insert({v.first, m_slots.size() - 1});
+        }
+    }
+    return {iterator(last() - 1, last()), true};
+}
+
+template <class T>
+size_t IdMap<T>::erase(int id)
+{
+    const size_t i = slotOf(id);
+    if (i == npos) {
+        return 0;
+    }
+    m_slots[i].second = T();
+    m_index.erase(id);
+    --m_size;
+    return 1;
+}
+
+template <class T>
+typename IdMap<T>::iterator IdMap<T>::erase(const_iterator it)
+{
+    const size_t i = static_cast<size_t>(it.m_it - first());
+    m_index.erase(m_slots[i].first);
+    m_slots[i].second = T();
+    --m_size;
+    return iterator(first() + i + 1, last());
+}
+
+template <class T>
+void IdMap<T>::clear()
+{
+    m_slots.clear();
+    m_index.clear();
+    m_size = 0;
+    m_dense = true;
+}
+
+template <class T>
+void IdMap<T>::swap(IdMap& other)
+{
+    m_slots.swap(other.m_slots);
+    m_index.swap(other.m_index);
+    std::swap(m_size, other.m_size);
+    std::swap(m_dense, other.m_dense);
+}
+
+template <class T>
+void IdMap<T>::squeeze()
+{
+    const size_t tombstones = m_slots.size() - m_size;
+    if (m_dense && tombstones <= m_size) {
+        return;
+    }
+    if (!densify() && tombstones > 0) {
+        pack();
+        m_dense = false;
+    }
+}
+
+template <class T>
+bool IdMap<T>::densify()
+{
+    int maxId = -1;
+    for (auto const& s : m_slots) {
+        if (!s.second.isNull()) {
+            if (s.first < 0) {
+                return false;
+            }
+            maxId = std::max(maxId, s.first);
+        }
+    }
+    const size_t numSlots = static_cast<size_t>(maxId + 1);
+    if (numSlots > 2 * m_size) {
+        return false;
+    }
+
+    std::vector<T> byId(numSlots);
+    for (auto& s : m_slots) {
+        if (!s.second.isNull()) {
+            byId[static_cast<size_t>(s.first)] = std::move(s.second);
+        }
+    }
+    std::vector<value_type> dense;
+    dense.reserve(numSlots);
+    for (size_t i = 0; i < numSlots; ++i) {
+        dense.emplace_back(static_cast<int>(i), std::move(byId[i]));
+    }
+    m_slots.swap(dense);
+    m_index.clear();
+    m_dense = true;
+    return true;
+}
+
+template <class T>
+void IdMap<T>::pack()
+{
+    // pair<const int, T> is not assignable, so we move the elements
+    // into a new vector instead of shifting them in place
+    std::vector<value_type> packed;
+    packed.reserve(m_size);
+    for (auto& s : m_slots) {
+        if (!s.second.isNull()) {
+            packed.emplace_back(std::move(s));
+        }
+    }
+    m_slots.swap(packed);
+
+    m_index.clear();
+    if (m_slots.size() > kMaxLinearScan) {
+        m_index.reserve(m_slots.size());
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            m_index.insert({m_slots[i].first, i});
+        }
+    }
+}
+
+} // evoplex
+#endif // IDMAP_H
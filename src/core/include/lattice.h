@@ -0,0 +1,167 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATTICE_H
+#define LATTICE_H
+
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "adjacency.h"
+
+namespace evoplex {
+
+/**
+ * @brief A regular lattice whose neighbours are computed on the fly.
+ *
+ * The nodes are laid out in a grid of width() columns and height() rows,
+ * where the id of the node at (row, col) is row*width()+col. Each node is
+ * connected to the nodes displaced by offsets(); with periodic boundary
+ * conditions (i.e., a toroid) the displacements wrap around the grid,
+ * otherwise the ones falling outside of it are dropped.
+ *
+ * In a directed lattice, the offsets lead to the out-neighbours of a node
+ * and the opposite ones to its in-neighbours. In an undirected lattice,
+ * each offset stands for an edge in both directions, so it must list only
+ * one of each pair of opposite offsets (e.g., north and west).
+ *
+ * It takes O(1) memory regardless of the number of nodes.
+ * @see AbstractGraph::setLattice()
+ * @ingroup PublicAPI
+ */
+class Lattice
+{
+public:
+    //! A displacement in rows and columns.
+    using Offset = std::pair<int, int>;
+
+    /**
+     * @brief Constructor.
+     * @param width,height The shape of the grid.
+     * @param offsets The displacements from a node to its neighbours.
+     * @param periodic True for periodic boundary conditions.
+     * @param directed True for a directed lattice.
+     * @throw std::invalid_argument if the shape is empty or a node
+     *        would have more than Neighbours::kMaxInline neighbours.
+     */
+    Lattice(int width, int height, std::vector<Offset> offsets,
+            bool periodic, bool directed);
+
+    inline int width() const { return m_width; }
+    inline int height() const { return m_height; }
+    inline const std::vector<Offset>& offsets() const { return m_offsets; }
+    inline bool isPeriodic() const { return m_periodic; }
+    inline bool isDirected() const { return m_directed; }
+
+    /**
+     * @brief Gets the number of nodes, i.e., width()*height().
+     */
+    inline int numNodes() const { return m_width * m_height; }
+    /**
+     * @brief Gets the number of edges.
+     */
+    inline int numEdges() const { return m_numEdges; }
+
+    /**
+     * @brief Gets the neighbours of \p nodeId through its outgoing edges.
+     * @throw std::out_of_range if \p nodeId is not in the lattice.
+     */
+    inline Neighbours outNeighbours(int nodeId) const;
+    /**
+     * @brief Gets the neighbours of \p nodeId through its incoming edges.
+     * @throw std::out_of_range if \p nodeId is not in the lattice.
+     */
+    inline Neighbours inNeighbours(int nodeId) const;
+
+    /**
+     * @brief Calls \p func(originId, neighbourId) for each edge.
+     * The edges are sorted by origin and then by offset.
+     */
+    inline void forEachEdge(const std::function<void(int, int)>& func) const;
+    /**
+     * @brief Calls \p func(originId, neighbourId) for each edge leaving
+     *        the nodes in the rows [\p firstRow, \p lastRow).
+     */
+    void forEachEdge(const std::function<void(int, int)>& func, int firstRow, int lastRow) const;
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<Offset> m_offsets;
+    bool m_periodic;
+    bool m_directed;
+    int m_numEdges;
+
+    // gets the id of the node at (row+dRow, col+dCol) or -1 if there is none
+    inline int neighbourId(int row, int col, int dRow, int dCol) const;
+    // collects the neighbours through the offsets (sign=1) and/or their opposites
+    inline Neighbours neighbours(int nodeId, bool forward, bool backward) const;
+};
+
+/************************************************************************
+   Lattice: Inline member functions
+ ************************************************************************/
+
+inline int Lattice::neighbourId(int row, int col, int dRow, int dCol) const
+{
+    row += dRow;
+    col += dCol;
+    if (m_periodic) {
+        row = ((row % m_height) + m_height) % m_height;
+        col = ((col % m_width) + m_width) % m_width;
+    } else if (row < 0 || row >= m_height || col < 0 || col >= m_width) {
+        return -1;
+    }
+    return row * m_width + col;
+}
+
+inline Neighbours Lattice::neighbours(int nodeId, bool forward, bool backward) const
+{
+    if (nodeId < 0 || nodeId >= numNodes()) {
+        throw std::out_of_range("node id is not in the lattice");
+    }
+    const int row = nodeId / m_width;
+    const int col = nodeId % m_width;
+    Neighbours nbs;
+    if (forward) {
+        for (const Offset& o : m_offsets) {
+            const int id = neighbourId(row, col, o.first, o.second);
+            if (id >= 0) { nbs.push(id); }
+        }
+    }
+    if (backward) {
+        for (const Offset& o : m_offsets) {
+            const int id = neighbourId(row, col, -o.first, -o.second);
+            if (id >= 0) { nbs.push(id); }
+        }
+    }
+    return nbs;
+}
+
+inline void Lattice::forEachEdge(const std::function<void(int, int)>& func) const
+{ forEachEdge(func, 0, m_height); }
+
+inline Neighbours Lattice::outNeighbours(int nodeId) const
+{ return neighbours(nodeId, true, !m_directed); }
+
+inline Neighbours Lattice::inNeighbours(int nodeId) const
+{ return neighbours(nodeId, !m_directed, true); }
+
+} // evoplex
+#endif // LATTICE_H
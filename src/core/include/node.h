@@ -35,8 +35,10 @@ using NodePtr = std::shared_ptr<BaseNode>;
 class Node
 {
     friend class AbstractGraph;
+    friend class BaseEdge;
     friend class NodesPrivate;
     friend class TestNodes;
+    friend class TestAdjacency;
 
 public:
     /**
@@ -75,7 +77,7 @@ public:
     /**
      * @brief Checks if the current Node is null.
      */
-    bool isNull() const;
+    inline bool isNull() const;
 
     //! @copydoc BaseNode::clone
     NodePtr clone() const;
@@ -87,9 +89,9 @@ public:
     float y() const;
 
     //! @copydoc BaseNode::attrs
-    const Attributes& attrs() const;
+    Attributes attrs() const;
     //! @copydoc BaseNode::attr
-    const Value& attr(int id) const;
+    Value attr(int id) const;
     //! @copydoc BaseNode::attr(const QString& name, Value defaultValue=Value()) const
     Value attr(const QString& name, Value defaultValue=Value()) const;
 
@@ -120,5 +122,12 @@ private:
     NodePtr m_ptr;
 };
 
+/************************************************************************
+   Node: Inline member functions
+ ************************************************************************/
+
+inline bool Node::isNull() const
+{ return !m_ptr; }
+
 } // evoplex
 #endif // NODE_P_H
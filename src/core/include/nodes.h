@@ -17,34 +17,36 @@
 #ifndef NODES_H
 #define NODES_H
 
-#include <unordered_map>
-
+#include "idmap.h"
 #include "node.h"
 
 namespace evoplex {
 
 /**
  * @brief A Node container.
- * It is an unordered_map with the node's id as the key.
+ * It is an IdMap with the node's id as the key. As the nodes created
+ * by evoplex have contiguous ids, it is usually dense, i.e., the lookup is
+ * O(1) and the iteration follows the id order.
  * @see Node
  * @ingroup PublicAPI
  */
-class Nodes : private std::unordered_map<int, Node>
+class Nodes : private IdMap<Node>
 {
     friend class AbstractGraph;
     friend class Experiment;
     friend class NodesPrivate;
+    friend class TestAdjacency;
 
 public:
-    using std::unordered_map<int, Node>::at;
-    using std::unordered_map<int, Node>::begin;
-    using std::unordered_map<int, Node>::cbegin;
-    using std::unordered_map<int, Node>::end;
-    using std::unordered_map<int, Node>::cend;
-    using std::unordered_map<int, Node>::iterator;
-    using std::unordered_map<int, Node>::const_iterator;
-    using std::unordered_map<int, Node>::empty;
-    using std::unordered_map<int, Node>::size;
+    using IdMap<Node>::at;
+    using IdMap<Node>::begin;
+    using IdMap<Node>::cbegin;
+    using IdMap<Node>::end;
+    using IdMap<Node>::cend;
+    using IdMap<Node>::iterator;
+    using IdMap<Node>::const_iterator;
+    using IdMap<Node>::empty;
+    using IdMap<Node>::size;
 };
 
 } // evoplex
@@ -0,0 +1,86 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "prg.h"
+
+namespace evoplex {
+
+/**
+ * @brief A contiguous range of node ids handled by a single thread.
+ *
+ * The nodes' ids, from 0 to the largest one, are split into partitions
+ * whose boundaries are multiples of kAlignment. Thus, partitions never
+ * share the 64-bit words of a bool AttributeColumn, and each thread can
+ * write the attributes of its own nodes through an AttrHandle.
+ *
+ * Each partition has its own PRG stream, derived from the trial's seed
+ * and from the partition's index. Given the same seed and number of
+ * threads, the results are reproducible regardless of which thread
+ * handles which partition.
+ *
+ * @note The range may include the ids of removed nodes.
+ * @see AbstractModel::parallelFor()
+ * @ingroup PublicAPI
+ */
+class Partition
+{
+    friend class Trial;
+
+public:
+    //! The number of ids of which the boundaries are multiple.
+    static constexpr int kAlignment = 64;
+
+    /**
+     * @brief Gets the index of the partition, from 0 to count()-1.
+     */
+    inline int index() const { return m_index; }
+    /**
+     * @brief Gets the number of partitions in the current parallelFor().
+     */
+    inline int count() const { return m_count; }
+    /**
+     * @brief Gets the id of the first node in the partition.
+     */
+    inline int firstId() const { return m_firstId; }
+    /**
+     * @brief Gets the id after the last node in the partition.
+     */
+    inline int endId() const { return m_endId; }
+    /**
+     * @brief Gets the PRG stream of the partition.
+     * It must be used instead of AbstractPlugin::prg(), which is not
+     * thread-safe.
+     */
+    inline PRG* prg() const { return m_prg; }
+
+private:
+    int m_index;
+    int m_count;
+    int m_firstId;
+    int m_endId;
+    PRG* m_prg;
+
+    Partition(int index, int count, int firstId, int endId, PRG* prg)
+        : m_index(index), m_count(count), m_firstId(firstId),
+          m_endId(endId), m_prg(prg) {}
+};
+
+} // evoplex
+#endif // PARTITION_H
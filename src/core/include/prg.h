@@ -18,6 +18,7 @@
 #define PRG_H
 
 #include <random>
+#include <string>
 
 namespace evoplex {
 
@@ -41,6 +42,19 @@ public:
     inline unsigned int seed() const
     { return m_seed; }
 
+    /**
+     * @brief Gets the current state of the engine, e.g., to checkpoint it.
+     * @see setState()
+     */
+    std::string state() const;
+
+    /**
+     * @brief Restores a @p state got from state().
+     * The next numbers will be the same that would have followed it.
+     * @returns false if @p state is not valid; the PRG is not changed then.
+     */
+    bool setState(const std::string& state);
+
     /**
      * @brief Bernoulli distribution.
      * It generates a random boolean according to the discrete probability
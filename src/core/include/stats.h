@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "attributes.h"
+#include "attributestable.h"
 
 namespace evoplex {
 
@@ -55,10 +56,24 @@ public:
 
     //! @copydoc count()
     template<typename Container>
-    static std::vector<Value> count(Container entity, const int attrIdx, std::vector<Value> values)
+    static std::vector<Value> count(const Container& entity, const int attrIdx, std::vector<Value> values)
     {
         return count(entity.cbegin(), entity.cend(), attrIdx, values);
     }
+
+    /**
+     * @brief Count frequency of the header values in the valid rows of a table.
+     * It scans the column \p attrIdx linearly.
+     * @copydetails count()
+     */
+    static std::vector<Value> count(const AttributesTable& table, const int attrIdx,
+                                    const std::vector<Value>& header)
+    {
+        const AttributeColumn& col = table.column(attrIdx);
+        const bool allRows = table.size() == table.numRows();
+        const std::vector<int> freq = col.count(header, allRows ? std::vector<bool>() : table.validRows());
+        return std::vector<Value>(freq.begin(), freq.end());
+    }
 };
 
 }
@@ -21,6 +21,8 @@
 #include <vector>
 #include <QString>
 
+class QDataStream;
+
 namespace evoplex {
 
 class Value;
@@ -263,6 +265,18 @@ private:
     std::logic_error throwError() const;
 };
 
+/**
+ * @brief Writes the type and the data of \p value to the stream \p out.
+ */
+QDataStream& operator<<(QDataStream& out, const Value& value);
+
+/**
+ * @brief Reads a Value written by operator<<() from the stream \p in.
+ * If the data is corrupted, \p value is invalid and the status of
+ * the stream is set to QDataStream::ReadCorruptData.
+ */
+QDataStream& operator>>(QDataStream& in, Value& value);
+
 /************************************************************************
    Value: Inline member functions
  ************************************************************************/
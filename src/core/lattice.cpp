@@ -0,0 +1,65 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "lattice.h"
+
+namespace evoplex {
+
+Lattice::Lattice(int width, int height, std::vector<Offset> offsets,
+                 bool periodic, bool directed)
+    : m_width(width),
+      m_height(height),
+      m_offsets(std::move(offsets)),
+      m_periodic(periodic),
+      m_directed(directed),
+      m_numEdges(0)
+{
+    if (m_width < 1 || m_height < 1) {
+        throw std::invalid_argument("the lattice must have at least one node");
+    }
+    const size_t maxDegree = m_directed ? m_offsets.size() : 2 * m_offsets.size();
+    if (maxDegree > static_cast<size_t>(Neighbours::kMaxInline)) {
+        throw std::invalid_argument("too many neighbours per node");
+    }
+
+    if (m_periodic) {
+        m_numEdges = numNodes() * static_cast<int>(m_offsets.size());
+    } else {
+        forEachEdge([this](int, int) { ++m_numEdges; });
+    }
+}
+
+void Lattice::forEachEdge(const std::function<void(int, int)>& func,
+                          int firstRow, int lastRow) const
+{
+    firstRow = std::max(0, firstRow);
+    lastRow = std::min(m_height, lastRow);
+    int id = firstRow * m_width;
+    for (int row = firstRow; row < lastRow; ++row) {
+        for (int col = 0; col < m_width; ++col, ++id) {
+            for (const Offset& o : m_offsets) {
+                const int nId = neighbourId(row, col, o.first, o.second);
+                if (nId >= 0) {
+                    func(id, nId);
+                }
+            }
+        }
+    }
+}
+
+} // evoplex
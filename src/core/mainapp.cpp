@@ -47,7 +47,7 @@ const char* MainApp::kPluginExtension = ".so";
 
 MainApp::MainApp()
     : m_expMgr(new ExperimentsMgr()),
-      m_networkMgr(new QNetworkAccessManager())
+      m_networkMgr(nullptr) // created on the first checkForUpdates()
 {
     qRegisterMetaType<Status>("Status"); // makes it available for signals/slots
     qRegisterMetaType<Function>("Function");
@@ -58,6 +58,7 @@ MainApp::MainApp()
     resetSettingsToDefault();
     m_defaultStepDelay = static_cast<quint16>(m_userPrefs.value("settings/stepDelay", m_defaultStepDelay).toInt());
     m_stepsToFlush = m_userPrefs.value("settings/stepsToFlush", m_stepsToFlush).toInt();
+    m_stepsToCheckpoint = m_userPrefs.value("settings/stepsToCheckpoint", m_stepsToCheckpoint).toInt();
     m_checkUpdatesAtStart = m_userPrefs.value("settings/checkUpdatesAtStart", m_checkUpdatesAtStart).toBool();
 
     int id = 0;
@@ -73,7 +74,9 @@ MainApp::MainApp()
     addAttrScope(id, GENERAL_ATTR_MODELVS, QString("int[0,%1]").arg(UINT16_MAX));
     addAttrScope(id, GENERAL_ATTR_SEED, QString("int[0,%1]").arg(INT32_MAX));
     addAttrScope(id, GENERAL_ATTR_STOPAT, QString("int[1,%1]").arg(EVOPLEX_MAX_STEPS));
+    addAttrScope(id, GENERAL_ATTR_STOPWHEN, "string");
     addAttrScope(id, GENERAL_ATTR_TRIALS, QString("int[1,%1]").arg(EVOPLEX_MAX_TRIALS));
+    addAttrScope(id, GENERAL_ATTR_FORKAT, QString("int[0,%1]").arg(EVOPLEX_MAX_STEPS));
     addAttrScope(id, GENERAL_ATTR_AUTODELETE, "bool");
     addAttrScope(id, GENERAL_ATTR_GRAPHTYPE, "string");
     addAttrScope(id, GENERAL_ATTR_EDGEATTRS, "string");
@@ -109,6 +112,7 @@ void MainApp::resetSettingsToDefault()
 {
     m_defaultStepDelay = 0;
     m_stepsToFlush = 10000;
+    m_stepsToCheckpoint = 0;
     m_checkUpdatesAtStart = true;
 }
 
@@ -118,10 +122,18 @@ void MainApp::setDefaultStepDelay(quint16 msec)
     m_userPrefs.setValue("settings/stepDelay", m_defaultStepDelay);
 }
 
-void MainApp::setStepsToFlush(int steps)
+void MainApp::setStepsToFlush(int steps, bool persist)
 {
     m_stepsToFlush = steps;
-    m_userPrefs.setValue("settings/stepsToFlush", m_stepsToFlush);
+    if (persist) {
+        m_userPrefs.setValue("settings/stepsToFlush", m_stepsToFlush);
+    }
+}
+
+void MainApp::setStepsToCheckpoint(int steps)
+{
+    m_stepsToCheckpoint = steps;
+    m_userPrefs.setValue("settings/stepsToCheckpoint", m_stepsToCheckpoint);
 }
 
 void MainApp::setCheckUpdatesAtStart(bool b)
@@ -312,6 +324,10 @@ void MainApp::checkForUpdates()
     QUrl url = m_userPrefs.value("settings/releasesUrl",
             qApp->organizationDomain() + "/data/releases.txt").toUrl();
 
+    if (!m_networkMgr) {
+        m_networkMgr = new QNetworkAccessManager();
+    }
+
     QNetworkReply* reply = m_networkMgr->get(QNetworkRequest((QUrl(url))));
     connect(reply, &QNetworkReply::finished, [this, reply]() {
         finishedCheckingForUpdates(QJsonDocument::fromJson(reply->readAll()).object());
@@ -72,7 +72,12 @@ public:
     void setDefaultStepDelay(quint16 msec);
 
     inline int stepsToFlush() const;
-    void setStepsToFlush(int steps);
+    // the value is only kept for this session if 'persist' is false
+    void setStepsToFlush(int steps, bool persist=true);
+
+    // the trials write a checkpoint every N steps; 0 disables it
+    inline int stepsToCheckpoint() const;
+    void setStepsToCheckpoint(int steps);
 
     inline bool checkUpdatesAtStart() const;
     void setCheckUpdatesAtStart(bool b);
@@ -135,6 +140,7 @@ private:
     QSettings m_userPrefs;
     quint16 m_defaultStepDelay; // msec
     int m_stepsToFlush;
+    int m_stepsToCheckpoint;
     bool m_checkUpdatesAtStart;
 
     QNetworkAccessManager* m_networkMgr;
@@ -160,6 +166,9 @@ inline quint16 MainApp::defaultStepDelay() const
 inline int MainApp::stepsToFlush() const
 { return m_stepsToFlush; }
 
+inline int MainApp::stepsToCheckpoint() const
+{ return m_stepsToCheckpoint; }
+
 inline bool MainApp::checkUpdatesAtStart() const
 { return m_checkUpdatesAtStart; }
 
@@ -49,9 +49,6 @@ bool Node::operator==(const Node& n) const
 bool Node::operator!=(const Node& n) const
 { return m_ptr != n.m_ptr; }
 
-bool Node::isNull() const
-{ return m_ptr ? false : true; }
-
 NodePtr Node::clone() const
 { return m_ptr->clone(); }
 
@@ -64,10 +61,10 @@ float Node::x() const
 float Node::y() const
 { return m_ptr->y(); }
 
-const Attributes& Node::attrs() const
+Attributes Node::attrs() const
 { return m_ptr->attrs(); }
 
-const Value& Node::attr(int id) const
+Value Node::attr(int id) const
 { return m_ptr->attr(id); }
 
 Value Node::attr(const QString& name, Value defaultValue) const
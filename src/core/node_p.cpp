@@ -16,6 +16,7 @@
 
 #include "node_p.h"
 #include "node.h"
+#include "abstractgraph.h"
 
 // we need this cpp file to avoi weak-vtable issues
 namespace evoplex {
@@ -24,7 +25,8 @@ BaseNode::BaseNode(const constructor_key&, int id, const Attributes& attrs, floa
     : m_id(id),
       m_attrs(attrs),
       m_x(x),
-      m_y(y)
+      m_y(y),
+      m_lazyGraph(nullptr)
 {
 }
 
@@ -35,13 +37,38 @@ BaseNode::~BaseNode()
 {
 }
 
+void BaseNode::bindTo(const std::shared_ptr<AttributesTable>& table)
+{
+    Q_ASSERT(!m_table);
+    table->insertRow(static_cast<size_t>(m_id), m_attrs);
+    m_table = table;
+    m_attrs = Attributes();
+}
+
+void BaseNode::unbind()
+{
+    if (m_table) {
+        m_attrs = m_table->row(static_cast<size_t>(m_id));
+        m_table->removeRow(static_cast<size_t>(m_id));
+        m_table.reset();
+    }
+}
+
+void BaseNode::createGraphEdges() const
+{
+    const AbstractGraph* graph = m_lazyGraph;
+    if (graph) {
+        graph->ensureEdges();
+    }
+}
+
 Node BaseNode::randNeighbour(PRG* prg) const
 {
+    fetchEdges();
     if (m_outEdges.empty()) {
         return Node();
     }
-    auto i = prg->uniform(outDegree()-1);
-    return std::next(m_outEdges.cbegin(), i)->second.neighbour();
+    return m_outEdges.randElement([prg](size_t n) { return prg->uniform(static_cast<int>(n)); }).second.neighbour();
 }
 
 /*******************/
@@ -20,11 +20,13 @@
 #include <memory>
 
 #include "attributes.h"
+#include "attributestable.h"
 #include "edges.h"
 #include "prg.h"
 
 namespace evoplex {
 
+class AbstractGraph;
 class BaseNode;
 using NodePtr = std::shared_ptr<BaseNode>;
 
@@ -38,6 +40,7 @@ class NodeInterface
     friend class Nodes;
     friend class TestNode;
     friend class TestEdge;
+    friend class TestAdjacency;
 
 public:
     //! Destructor.
@@ -83,6 +86,8 @@ private:
     virtual void removeOutEdge(const int edgeId) = 0;
     virtual void clearInEdges() = 0;
     virtual void clearOutEdges() = 0;
+    virtual void reserveEdges(size_t numIn, size_t numOut) = 0;
+    virtual void squeezeEdges() = 0;
 };
 
 /**
@@ -99,14 +104,20 @@ class BaseNode : public NodeInterface
     friend class NodesPrivate;
     friend class TestNode;
     friend class TestEdge;
+    friend class TestAdjacency;
 
 public:
     /**
-     * @brief Gets all the node's Attributes.
+     * @brief Gets a copy of all the node's Attributes.
+     * @note The attributes are stored in the typed columns of the graph,
+     *       so they are returned by value rather than by reference.
      */
-    inline const Attributes& attrs() const;
-    //! @copydoc Attributes::value
-    inline const Value& attr(int id) const;
+    inline Attributes attrs() const;
+    /**
+     * @brief Gets a copy of the value of the attribute @p id.
+     * @note Use AbstractGraph::nodeAttrHandle() to read it without a copy.
+     */
+    inline Value attr(int id) const;
     //! @copydoc Attributes::value(const QString& name, Value defaultValue=Value()) const
     inline Value attr(const QString& name, Value defaultValue=Value()) const;
     //! @copydoc Attributes::setValue
@@ -156,11 +167,28 @@ protected:
     explicit BaseNode(const constructor_key& k, int id, const Attributes& attr);
     ~BaseNode() override;
 
+    // makes sure the edges of a shared topology have been created
+    inline void fetchEdges() const;
+
 private:
     const int m_id;
-    Attributes m_attrs;
+    Attributes m_attrs; // used while the node is not bound to a table
+    std::shared_ptr<AttributesTable> m_table;
     float m_x;
     float m_y;
+
+    // the graph holding the node's edges in a shared topology;
+    // it is null once the Edge objects have been created
+    const AbstractGraph* m_lazyGraph;
+    void createGraphEdges() const;
+
+    // creates a node with the same id and coordinates, but no attributes
+    virtual NodePtr emptyClone() const = 0;
+
+    // moves the attributes into the row 'm_id' of the table
+    void bindTo(const std::shared_ptr<AttributesTable>& table);
+    // copies the attributes back from the table
+    void unbind();
 };
 
 /**
@@ -182,12 +210,15 @@ public:
     inline int outDegree() const override;
 
 private:
+    inline NodePtr emptyClone() const override;
     inline void addInEdge(const Edge& inEdge) override;
     inline void addOutEdge(const Edge& outEdge) override;
     inline void removeInEdge(const int edgeId) override;
     inline void removeOutEdge(const int edgeId) override;
     inline void clearInEdges() override;
     inline void clearOutEdges() override;
+    inline void reserveEdges(size_t numIn, size_t numOut) override;
+    inline void squeezeEdges() override;
 };
 
 /**
@@ -211,29 +242,47 @@ public:
 private:
     Edges m_inEdges;
 
+    inline NodePtr emptyClone() const override;
     inline void addInEdge(const Edge& inEdge) override;
     inline void addOutEdge(const Edge& outEdge) override;
     inline void removeInEdge(const int edgeId) override;
     inline void removeOutEdge(const int edgeId) override;
     inline void clearInEdges() override;
     inline void clearOutEdges() override;
+    inline void reserveEdges(size_t numIn, size_t numOut) override;
+    inline void squeezeEdges() override;
 };
 
 /************************************************************************
    BaseNode: Inline member functions
  ************************************************************************/
 
-inline const Attributes& BaseNode::attrs() const
-{ return m_attrs; }
+inline Attributes BaseNode::attrs() const
+{ return m_table ? m_table->row(static_cast<size_t>(m_id)) : m_attrs; }
 
-inline const Value& BaseNode::attr(int id) const
-{ return m_attrs.value(id); }
+inline Value BaseNode::attr(int id) const
+{ return m_table ? m_table->value(static_cast<size_t>(m_id), id) : m_attrs.value(id); }
 
 inline Value BaseNode::attr(const QString& name, Value defaultValue) const
-{ return m_attrs.value(name, defaultValue); }
+{
+    if (m_table) {
+        const int col = m_table->indexOf(name);
+        return col < 0 ? defaultValue : m_table->value(static_cast<size_t>(m_id), col);
+    }
+    return m_attrs.value(name, defaultValue);
+}
 
 inline void BaseNode::setAttr(int id, const Value& value)
-{ m_attrs.setValue(id, value); }
+{
+    if (m_table) {
+        m_table->setValue(static_cast<size_t>(m_id), id, value);
+    } else {
+        m_attrs.setValue(id, value);
+    }
+}
+
+inline void BaseNode::fetchEdges() const
+{ if (m_lazyGraph) { createGraphEdges(); } }
 
 inline int BaseNode::id() const
 { return m_id; }
@@ -260,14 +309,17 @@ inline void BaseNode::setCoords(float x, float y)
 inline NodePtr UNode::clone() const
 { return std::make_shared<UNode>(constructor_key(), id(), attrs(), x(), y()); }
 
+inline NodePtr UNode::emptyClone() const
+{ return std::make_shared<UNode>(constructor_key(), id(), Attributes(), x(), y()); }
+
 inline const Edges& UNode::inEdges() const
-{ return m_outEdges; }
+{ fetchEdges(); return m_outEdges; }
 
 inline const Edges& UNode::outEdges() const
-{ return m_outEdges; }
+{ fetchEdges(); return m_outEdges; }
 
 inline int UNode::degree() const
-{ return static_cast<int>(m_outEdges.size()); }
+{ fetchEdges(); return static_cast<int>(m_outEdges.size()); }
 
 inline int UNode::inDegree() const
 { return degree(); }
@@ -293,6 +345,12 @@ inline void UNode::clearInEdges()
 inline void UNode::clearOutEdges()
 { m_outEdges.clear(); }
 
+inline void UNode::reserveEdges(size_t numIn, size_t numOut)
+{ m_outEdges.reserve(m_outEdges.numSlots() + numIn + numOut); }
+
+inline void UNode::squeezeEdges()
+{ m_outEdges.squeeze(); }
+
 /************************************************************************
    DNode: Inline member functions
  ************************************************************************/
@@ -300,20 +358,23 @@ inline void UNode::clearOutEdges()
 NodePtr DNode::clone() const
 { return std::make_shared<DNode>(constructor_key(), id(), attrs(), x(), y()); }
 
+inline NodePtr DNode::emptyClone() const
+{ return std::make_shared<DNode>(constructor_key(), id(), Attributes(), x(), y()); }
+
 inline const Edges& DNode::inEdges() const
-{ return m_inEdges; }
+{ fetchEdges(); return m_inEdges; }
 
 inline const Edges& DNode::outEdges() const
-{ return m_outEdges; }
+{ fetchEdges(); return m_outEdges; }
 
 inline int DNode::degree() const
 { return inDegree() + outDegree(); }
 
 inline int DNode::inDegree() const
-{ return static_cast<int>(m_inEdges.size()); }
+{ fetchEdges(); return static_cast<int>(m_inEdges.size()); }
 
 inline int DNode::outDegree() const
-{ return static_cast<int>(m_outEdges.size()); }
+{ fetchEdges(); return static_cast<int>(m_outEdges.size()); }
 
 inline void DNode::addInEdge(const Edge& inEdge)
 { m_inEdges.insert({inEdge.id(), inEdge}); }
@@ -333,5 +394,14 @@ inline void DNode::clearInEdges()
 inline void DNode::clearOutEdges()
 { m_outEdges.clear(); }
 
+inline void DNode::reserveEdges(size_t numIn, size_t numOut)
+{
+    m_inEdges.reserve(m_inEdges.numSlots() + numIn);
+    m_outEdges.reserve(m_outEdges.numSlots() + numOut);
+}
+
+inline void DNode::squeezeEdges()
+{ m_inEdges.squeeze(); m_outEdges.squeeze(); }
+
 } // evoplex
 #endif // NODE_P_H
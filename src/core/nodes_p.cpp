@@ -30,8 +30,34 @@ Nodes NodesPrivate::clone(const Nodes& nodes)
 {
     Nodes ret;
     ret.reserve(nodes.size());
+
+    // if all nodes are stored in the same table, the clones take a
+    // copy-on-write copy of it instead of copying their attributes
+    std::shared_ptr<AttributesTable> srcTable;
+    if (!nodes.empty()) {
+        srcTable = nodes.cbegin()->second.m_ptr->m_table;
+    }
+    if (srcTable && srcTable->size() == nodes.size()) {
+        for (auto const& pair : nodes) {
+            if (pair.second.m_ptr->m_table != srcTable) {
+                srcTable.reset();
+                break;
+            }
+        }
+    }
+
+    if (!srcTable || srcTable->size() != nodes.size()) {
+        for (auto const& pair : nodes) {
+            ret.insert({pair.first, pair.second.clone()});
+        }
+        return ret;
+    }
+
+    auto table = std::make_shared<AttributesTable>(*srcTable);
     for (auto const& pair : nodes) {
-        ret.insert({pair.first, pair.second.clone()});
+        NodePtr node = pair.second.m_ptr->emptyClone();
+        node->m_table = table; // the row 'id' holds its attributes
+        ret.insert({pair.first, Node(node)});
     }
     return ret;
 }
@@ -52,6 +78,7 @@ Nodes NodesPrivate::fromCmd(const QString& cmd, const AttributesScope& attrsScop
 
     BaseNode::constructor_key k;
     Nodes nodes;
+    nodes.reserve(setOfAttrs.size());
     int id = 0;
     if (graphType == GraphType::Directed) {
         for (Attributes attrs : setOfAttrs) {
@@ -100,11 +127,12 @@ Nodes NodesPrivate::fromFile(const QString& filePath, const AttributesScope& att
     }
 
     // create set of attributes
+    const AttributesSchemaPtr schema = AttributesSchema::fromScope(attrsScope);
     int row = 0;
     Nodes nodes;
     while (!in.atEnd()) {
         QStringList values = in.readLine().split(",");
-        Node node = readRow(row, header, values, attrsScope, isDirected, error);
+        Node node = readRow(row, header, values, attrsScope, schema, isDirected, error);
         if (node.isNull()) {
             qWarning() << error;
             return Nodes();
@@ -136,8 +164,8 @@ bool NodesPrivate::saveToFile(const Nodes& nodes, QString filePath, std::functio
     }
 
     QTextStream out(&file);
-    const std::vector<QString>& header = nodes.begin()->second.attrs().names();
-    for (const QString& col : header) {
+    const Attributes header = nodes.begin()->second.attrs();
+    for (const QString& col : header.names()) {
         out << col << ",";
     }
     out << "x,y\n";
@@ -150,7 +178,8 @@ bool NodesPrivate::saveToFile(const Nodes& nodes, QString filePath, std::functio
 
     for (const int id : orderedIds) {
         const Node& node = nodes.at(id);
-        for (const Value& value : node.attrs().values()) {
+        const Attributes attrs = node.attrs();
+        for (const Value& value : attrs.values()) {
             out << value.toQString() << ",";
         }
         out << node.x() << ",";
@@ -196,7 +225,8 @@ QStringList NodesPrivate::validateHeader(const QString& header,
 }
 
 Node NodesPrivate::readRow(const int row, const QStringList& header, const QStringList& values,
-        const AttributesScope& attrsScope, const bool isDirected, QString& error)
+        const AttributesScope& attrsScope, const AttributesSchemaPtr& schema,
+        const bool isDirected, QString& error)
 {
     if (values.size() != header.size()) {
         error += QString("the row %1 should have % columns!").arg(row).arg(header.size());
@@ -206,7 +236,7 @@ Node NodesPrivate::readRow(const int row, const QStringList& header, const QStri
     AttributeRangePtr attrRange;
     float coordX = 0.f;
     float coordY = row;
-    Attributes attrs(attrsScope.size());
+    Attributes attrs(schema);
     for (int col = 0; col < values.size(); ++col) {
         bool isValid = true;
         if (header.at(col) == "x") {
@@ -218,7 +248,7 @@ Node NodesPrivate::readRow(const int row, const QStringList& header, const QStri
             if (attrRange) { // is null if the column is not required
                 Value value = attrRange->validate(values.at(col));
                 if (value.isValid()) {
-                    attrs.replace(attrRange->id(), header.at(col), value);
+                    attrs.setValue(attrRange->id(), value);
                 } else {
                     isValid = false;
                 }
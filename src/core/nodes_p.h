@@ -62,9 +62,10 @@ private:
     static QStringList validateHeader(const QString& header,
             const AttributesScope& attrsScope, QString& error);
 
+    // all nodes share the 'schema' built from the attrsScope
     static Node readRow(const int row, const QStringList& header,
             const QStringList& values, const AttributesScope& attrsScope,
-            const bool isDirected, QString& error);
+            const AttributesSchemaPtr& schema, const bool isDirected, QString& error);
 };
 
 } // evoplex
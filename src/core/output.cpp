@@ -54,6 +54,13 @@ QString Cache::printableHeader(const char sep, const bool joinInputs) const
                                    m_inputs, sep, joinInputs);
 }
 
+void Cache::appendRow(const int trialId, const Row& row)
+{
+    Data& data = m_trials.at(trialId);
+    if (data.rows.empty()) data.last = data.rows.before_begin();
+    data.last = data.rows.emplace_after(data.last, row);
+}
+
 void Cache::flushAll()
 {
     for (auto& it : m_trials) {
@@ -86,7 +93,13 @@ void DefaultOutput::doOperation(const Trial* trial)
     switch (m_func) {
     case F_Count:
         if (m_entity == E_Nodes) {
-            allValues = Stats::count(trial->graph()->nodes(), m_attrRange->id(), m_allInputs);
+            const AbstractGraph* graph = trial->graph();
+            if (graph->nodeAttrsTable().size() == graph->nodes().size()) {
+                // all nodes are in the columnar store
+                allValues = Stats::count(graph->nodeAttrsTable(), m_attrRange->id(), m_allInputs);
+            } else {
+                allValues = Stats::count(graph->nodes(), m_attrRange->id(), m_allInputs);
+            }
         } else {
             allValues = Stats::count(trial->graph()->edges(), m_attrRange->id(), m_allInputs);
         }
@@ -53,7 +53,14 @@ public:
     inline OutputPtr output() const { return m_parent; }
     inline const Values& inputs() const { return m_inputs; }
     inline const Row& readFrontRow(const int trialId) const { return m_trials.at(trialId).rows.front(); }
+    // the newest row of a trial; it must not be empty
+    inline const Row& readBackRow(const int trialId) const { return *m_trials.at(trialId).last; }
     inline void flushFrontRow(const int trialId) { m_trials.at(trialId).rows.pop_front(); }
+
+    // the rows of a trial that were not flushed yet
+    inline const std::forward_list<Row>& rows(const int trialId) const { return m_trials.at(trialId).rows; }
+    // appends a row to the rows of a trial, e.g., when restoring a checkpoint
+    void appendRow(const int trialId, const Row& row);
     void flushAll();
 
 private:
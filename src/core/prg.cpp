@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <sstream>
+
 #include "prg.h"
 
 namespace evoplex {
@@ -26,4 +28,24 @@ PRG::PRG(unsigned int seed)
 {
 }
 
+std::string PRG::state() const
+{
+    // the distributions do not cache any value; the engine is all we need
+    std::ostringstream out;
+    out << m_mteng;
+    return out.str();
+}
+
+bool PRG::setState(const std::string& state)
+{
+    std::istringstream in(state);
+    std::mt19937 eng;
+    in >> eng;
+    if (in.fail()) {
+        return false;
+    }
+    m_mteng = eng;
+    return true;
+}
+
 } // evoplex
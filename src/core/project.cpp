@@ -72,10 +72,15 @@ void Project::playAll()
 {
     for (auto& i : m_experiments)
         i.second->play();
+    for (auto& s : m_sweeps)
+        s->play();
 }
 
 void Project::pauseAll()
 {
+    for (auto& s : m_sweeps) {
+        s->pause();
+    }
     for (auto& i : m_experiments) {
         if (i.second->expStatus() == Status::Running ||
                 i.second->expStatus() == Status::Queued) {
@@ -183,6 +188,20 @@ int Project::importExperiments(const QString& filePath, QString& error)
     while (!in.atEnd()) {
         const QStringList values = in.readLine().split(",");
         QString expErrorMsg;
+
+        // the experiments of a sweep are only created when they are run
+        SweepPtr sweep = Sweep::parse(m_mainApp, shared_from_this(), row, header, values, expErrorMsg);
+        if (sweep) {
+            m_sweeps.emplace_back(sweep);
+            ++row;
+            continue;
+        }
+        if (!expErrorMsg.isEmpty()) {
+            error += QString("Row %1 (skipped): Critical error: %2\n\n").arg(row).arg(expErrorMsg);
+            ++row;
+            continue;
+        }
+
         auto inputs = ExpInputs::parse(m_mainApp, header, values, expErrorMsg);
         if (!expErrorMsg.isEmpty()) {
             error += QString("Row %1 : Warning: %2\n\n").arg(row).arg(expErrorMsg);
@@ -25,6 +25,7 @@
 #include "abstractmodel.h"
 #include "experiment.h"
 #include "mainapp.h"
+#include "sweep.h"
 
 namespace evoplex {
 
@@ -55,7 +56,8 @@ public:
     bool editExperiment(int expId, ExpInputsPtr newInputs, QString& error);
 
     // Import a set of experiments from a csv file. It stops if an experiment fails.
-    // return the number of experiments imported.
+    // The rows holding ranges of values are imported as sweeps.
+    // return the number of experiments (and sweeps) imported.
     int importExperiments(const QString& filePath, QString& error);
 
     // Save project into the dest directory.
@@ -72,14 +74,15 @@ public:
     inline const QString& filepath() const;
     inline ExperimentPtr experiment(int expId) const;
     inline const Experiments& experiments() const;
+    inline const std::vector<SweepPtr>& sweeps() const;
     inline bool hasUnsavedChanges() const;
     inline bool isRunning() const;
 
 public slots:
-    // execute all experiments of this project
+    // execute all experiments and sweeps of this project
     void playAll();
 
-    // pause all experiments of this project
+    // pause all experiments and sweeps of this project
     void pauseAll();
 
 signals:
@@ -97,6 +100,8 @@ private:
     QString m_name;
     bool m_hasUnsavedChanges;
     Experiments m_experiments;
+    // the experiments of a sweep are added (and removed) as they run
+    std::vector<SweepPtr> m_sweeps;
 };
 
 inline const QString& Project::name() const
@@ -113,6 +118,9 @@ inline ExperimentPtr Project::experiment(int expId) const {
 inline const Experiments& Project::experiments() const
 { return m_experiments; }
 
+inline const std::vector<SweepPtr>& Project::sweeps() const
+{ return m_sweeps; }
+
 inline int Project::id() const
 { return m_id; }
 
@@ -127,6 +135,11 @@ inline bool Project::isRunning() const
             return true;
         }
     }
+    for (auto const& s : m_sweeps) {
+        if (s->isPlaying()) {
+            return true;
+        }
+    }
     return false;
 }
 
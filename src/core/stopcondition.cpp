@@ -0,0 +1,163 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QStringList>
+#include <algorithm>
+
+#include "stopcondition.h"
+
+namespace evoplex {
+
+StopCondition::StopCondition()
+    : m_type(Type::None),
+      m_window(0),
+      m_epsilon(0.)
+{
+}
+
+StopCondition StopCondition::parse(const QString& cmd, QString& error)
+{
+    StopCondition cond;
+    if (cmd.isEmpty()) {
+        return cond;
+    }
+
+    const QStringList args = cmd.split("_");
+    bool ok = false;
+    const int window = args.size() > 1 ? args.at(1).toInt(&ok) : 0;
+    if (!ok || window < 1) {
+        error = QString("the stop condition '%1' needs a number of steps greater than 0.").arg(cmd);
+        return cond;
+    }
+
+    if (args.first() == "unchanged" && args.size() == 2) {
+        cond.m_type = Type::Unchanged;
+        cond.m_window = window;
+    } else if (args.first() == "variance" && args.size() == 3) {
+        const double epsilon = args.at(2).toDouble(&ok);
+        if (!ok || epsilon < 0.) {
+            error = QString("the stop condition '%1' needs a non-negative epsilon.").arg(cmd);
+            return cond;
+        }
+        cond.m_type = Type::Variance;
+        cond.m_window = window;
+        cond.m_epsilon = epsilon;
+    } else {
+        error = QString("invalid stop condition '%1'. Expected 'unchanged_K' or "
+                        "'variance_W_eps'.").arg(cmd);
+    }
+    return cond;
+}
+
+/*******************************************************/
+/*******************************************************/
+
+ConvergenceMonitor::ConvergenceMonitor(const StopCondition& condition)
+    : m_condition(condition)
+{
+    reset();
+}
+
+void ConvergenceMonitor::reset()
+{
+    m_last.clear();
+    m_unchangedSteps = 0;
+    m_rows.clear();
+    m_shift.clear();
+    m_sum.clear();
+    m_sumSq.clear();
+    m_next = 0;
+    m_filled = 0;
+}
+
+bool ConvergenceMonitor::update(const Values& values)
+{
+    if (values.empty()) {
+        return false;
+    }
+
+    switch (m_condition.type()) {
+    case StopCondition::Type::Unchanged:
+        return updateUnchanged(values);
+    case StopCondition::Type::Variance:
+        return updateVariance(values);
+    default:
+        return false;
+    }
+}
+
+bool ConvergenceMonitor::updateUnchanged(const Values& values)
+{
+    if (values == m_last) {
+        ++m_unchangedSteps;
+    } else {
+        m_last = values;
+        m_unchangedSteps = 0;
+    }
+    return m_unchangedSteps >= m_condition.window();
+}
+
+bool ConvergenceMonitor::updateVariance(const Values& values)
+{
+    // only numbers have a variance
+    auto isNumber = [](const Value& v) { return v.isInt() || v.isDouble(); };
+    if (!std::all_of(values.cbegin(), values.cend(), isNumber)) {
+        return false;
+    }
+
+    const size_t numCols = values.size();
+    if (m_shift.size() != numCols) {
+        reset(); // the first step (or a different set of values)
+        m_shift.resize(numCols, 0.);
+        for (size_t c = 0; c < numCols; ++c) {
+            const Value& v = values[c];
+            m_shift[c] = v.isInt() ? v.toInt() : v.toDouble();
+        }
+        m_sum.assign(numCols, 0.);
+        m_sumSq.assign(numCols, 0.);
+        m_rows.assign(static_cast<size_t>(m_condition.window()), std::vector<double>(numCols, 0.));
+    }
+
+    std::vector<double>& row = m_rows[m_next];
+    for (size_t c = 0; c < numCols; ++c) {
+        const Value& v = values[c];
+        const double x = (v.isInt() ? v.toInt() : v.toDouble()) - m_shift[c];
+        if (m_filled == m_rows.size()) { // drops the oldest value
+            m_sum[c] -= row[c];
+            m_sumSq[c] -= row[c] * row[c];
+        }
+        row[c] = x;
+        m_sum[c] += x;
+        m_sumSq[c] += x * x;
+    }
+    m_next = (m_next + 1) % m_rows.size();
+    m_filled = std::min(m_filled + 1, m_rows.size());
+
+    if (m_filled < m_rows.size()) {
+        return false;
+    }
+
+    const double n = static_cast<double>(m_filled);
+    for (size_t c = 0; c < numCols; ++c) {
+        const double mean = m_sum[c] / n;
+        if (m_sumSq[c] / n - mean * mean > m_condition.epsilon()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // evoplex
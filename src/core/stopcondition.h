@@ -0,0 +1,100 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STOP_CONDITION_H
+#define STOP_CONDITION_H
+
+#include <vector>
+#include <QString>
+
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief A condition to stop a trial before the last step.
+ *
+ * It is evaluated on the values written to the outputs at each step.
+ * Expected commands:
+ *     - 'unchanged_K': none of the values has changed in the last K steps
+ *     - 'variance_W_eps': the variance of each value over the last W steps
+ *       is not greater than 'eps'; the values must be numbers
+ * An empty command means that the trials run until the last step.
+ */
+class StopCondition
+{
+public:
+    enum class Type {
+        None,
+        Unchanged,
+        Variance
+    };
+
+    // parses the command; returns a None condition if it is not valid
+    static StopCondition parse(const QString& cmd, QString& error);
+
+    StopCondition();
+
+    inline Type type() const { return m_type; }
+    inline int window() const { return m_window; }
+    inline double epsilon() const { return m_epsilon; }
+
+private:
+    Type m_type;
+    int m_window;      // the number of steps looked at
+    double m_epsilon;  // the max variance
+};
+
+/**
+ * @brief Tells when the outputs of a trial meet a StopCondition.
+ *
+ * It only keeps the last values; the variance over the window is
+ * updated incrementally, so each step costs O(number of values).
+ */
+class ConvergenceMonitor
+{
+public:
+    explicit ConvergenceMonitor(const StopCondition& condition);
+
+    // feeds the values of the current step;
+    // returns true once the condition is met
+    bool update(const Values& values);
+
+    // forgets the values seen so far
+    void reset();
+
+private:
+    const StopCondition m_condition;
+
+    // Unchanged: the previous values and for how long they have not changed
+    Values m_last;
+    int m_unchangedSteps;
+
+    // Variance: the values in the window (a ring buffer of rows) and their
+    // sums, shifted by the first value of each column to keep them small
+    std::vector<std::vector<double>> m_rows;
+    std::vector<double> m_shift;
+    std::vector<double> m_sum;
+    std::vector<double> m_sumSq;
+    size_t m_next;
+    size_t m_filled;
+
+    bool updateUnchanged(const Values& values);
+    bool updateVariance(const Values& values);
+};
+
+} // evoplex
+#endif // STOP_CONDITION_H
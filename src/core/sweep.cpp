@@ -0,0 +1,412 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QTextStream>
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+#include "sweep.h"
+#include "experiment.h"
+#include "experimentsmgr.h"
+#include "expinputs.h"
+#include "nodes_p.h"
+#include "project.h"
+
+namespace evoplex {
+
+// the double intervals are counted by visiting them; it avoids rounding
+// mismatches with next(), but it must be bounded
+static const qint64 kMaxDoubleSteps = 10000000;
+
+qint64 SweepSpace::count(const AttributeRangePtr& range)
+{
+    if (!range || range->max() < range->min()) {
+        return 0;
+    }
+
+    switch (range->type()) {
+    case AttributeRange::Int_Range:
+        return static_cast<qint64>(range->max().toInt()) - range->min().toInt() + 1;
+    case AttributeRange::Double_Range: {
+        qint64 n = 1;
+        for (Value v = range->next(range->min()); v != range->min(); v = range->next(v)) {
+            if (++n > kMaxDoubleSteps) {
+                return 0;
+            }
+        }
+        return n;
+    }
+    case AttributeRange::Int_Set:
+    case AttributeRange::Double_Set:
+    case AttributeRange::String_Set: {
+        // next() cannot tell repeated values apart
+        const Values& values = dynamic_cast<const SetOfValues*>(range.get())->values();
+        const std::set<Value> unique(values.cbegin(), values.cend());
+        return unique.size() == values.size() ? static_cast<qint64>(values.size()) : 0;
+    }
+    default:
+        return 0;
+    }
+}
+
+SweepSpace::SweepSpace(std::vector<AttributeRangePtr> ranges)
+    : m_ranges(std::move(ranges)),
+      m_size(m_ranges.empty() ? 0 : 1)
+{
+    for (auto const& range : m_ranges) {
+        auto set = dynamic_cast<const SetOfValues*>(range.get());
+        m_first.emplace_back(set ? set->values().front() : range->min());
+        m_size *= count(range);
+    }
+    m_point = m_first;
+}
+
+bool SweepSpace::next()
+{
+    // the ranges wrap around to their first value; it carries to the previous one
+    for (size_t i = m_ranges.size(); i-- > 0;) {
+        m_point[i] = m_ranges[i]->next(m_point[i]);
+        if (m_point[i] != m_first[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**********************************/
+
+Nodes SweepCache::nodes(const QString& key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return key == m_key ? NodesPrivate::clone(m_nodes) : Nodes();
+}
+
+void SweepCache::setNodes(const QString& key, const Nodes& nodes)
+{
+    QMutexLocker locker(&m_mutex);
+    setKey(key);
+    if (m_nodes.empty()) {
+        m_nodes = NodesPrivate::clone(nodes);
+    }
+}
+
+TopologyPtr SweepCache::topology(const QString& key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return key == m_key ? m_topology : nullptr;
+}
+
+void SweepCache::setTopology(const QString& key, TopologyPtr topology)
+{
+    QMutexLocker locker(&m_mutex);
+    setKey(key);
+    if (!m_topology) {
+        m_topology = std::move(topology);
+    }
+}
+
+void SweepCache::setKey(const QString& key)
+{
+    if (key != m_key) {
+        m_key = key;
+        m_nodes = Nodes();
+        m_topology.reset();
+    }
+}
+
+/**********************************/
+
+Sweep::Sweep(MainApp* mainApp, ProjectPtr project, int row, const QStringList& header,
+             const QStringList& values, std::vector<int> columns,
+             std::vector<AttributeRangePtr> ranges)
+    : QObject(),
+      m_mainApp(mainApp),
+      m_project(project),
+      m_row(row),
+      m_header(header),
+      m_values(values),
+      m_columns(std::move(columns)),
+      m_space(std::move(ranges)),
+      m_hasNext(true),
+      m_cache(std::make_shared<SweepCache>()),
+      m_playing(false),
+      m_numDone(0),
+      m_numFailed(0),
+      m_indexStarted(false)
+{
+}
+
+SweepPtr Sweep::parse(MainApp* mainApp, ProjectPtr project, int row,
+                      const QStringList& header, const QStringList& values, QString& error)
+{
+    const QRegExp rangeRx("(int|double)\\[.*\\]|(int|double|string)\\{.*\\}");
+
+    std::vector<int> columns;
+    std::vector<AttributeRangePtr> ranges;
+    for (int col = 0; col < values.size() && col < header.size(); ++col) {
+        QString cell = values.at(col).trimmed();
+        if (!rangeRx.exactMatch(cell)) {
+            continue;
+        }
+        auto range = AttributeRange::parse(col, header.at(col), cell.replace(';', ','));
+        if (SweepSpace::count(range) < 1) {
+            error = QString("the values of '%1' cannot be swept: '%2'")
+                    .arg(header.at(col), values.at(col));
+            return nullptr;
+        }
+        columns.emplace_back(col);
+        ranges.emplace_back(range);
+    }
+    if (columns.empty()) {
+        return nullptr; // it's a regular experiment
+    }
+    if (!header.contains(GENERAL_ATTR_EXPID)) {
+        error = QString("the sweep must have the '%1' column").arg(GENERAL_ATTR_EXPID);
+        return nullptr;
+    }
+
+    // the model's attributes only change the model; the other inputs
+    // (except the ones below) define the nodes and edges
+    static const QStringList runAttrs = {
+        GENERAL_ATTR_EXPID, GENERAL_ATTR_SEED, GENERAL_ATTR_STOPAT, GENERAL_ATTR_TRIALS,
+        GENERAL_ATTR_AUTODELETE, GENERAL_ATTR_FORKAT, GENERAL_ATTR_STOPWHEN,
+        OUTPUT_DIR, OUTPUT_HEADER, OUTPUT_AVGTRIALS, OUTPUT_SAVESTEPS
+    };
+    QStringList modelIds;
+    const int modelIdCol = header.indexOf(GENERAL_ATTR_MODELID);
+    if (modelIdCol >= 0 && modelIdCol < values.size()) {
+        auto it = std::find(columns.cbegin(), columns.cend(), modelIdCol);
+        if (it == columns.cend()) {
+            modelIds.append(values.at(modelIdCol));
+        } else {
+            auto set = dynamic_cast<const SetOfValues*>(ranges.at(it - columns.cbegin()).get());
+            for (const Value& v : set ? set->values() : Values()) {
+                modelIds.append(v.toQString());
+            }
+        }
+    }
+    auto isModelAttr = [&](const QString& name) {
+        if (mainApp->generalAttrsScope().contains(name)) {
+            return false;
+        }
+        for (const QString& modelId : modelIds) {
+            if (name.startsWith(modelId + "_")) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<bool> isStructure;
+    for (const QString& name : header) {
+        isStructure.emplace_back(!runAttrs.contains(name) && !isModelAttr(name));
+    }
+
+    // the model's attributes vary faster, so consecutive points are more
+    // likely to share their nodes and edges
+    std::vector<size_t> order(columns.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_partition(order.begin(), order.end(),
+            [&](size_t i) { return !isModelAttr(header.at(columns.at(i))); });
+    std::vector<int> orderedColumns;
+    std::vector<AttributeRangePtr> orderedRanges;
+    for (size_t i : order) {
+        orderedColumns.emplace_back(columns.at(i));
+        orderedRanges.emplace_back(ranges.at(i));
+    }
+
+    SweepPtr sweep(new Sweep(mainApp, project, row, header, values,
+                             std::move(orderedColumns), std::move(orderedRanges)));
+    sweep->m_isStructure = std::move(isStructure);
+
+    // the first point tells if the other inputs are valid
+    const QStringList first = sweep->pointValues(project->generateExpId());
+    QString inputsError;
+    if (!ExpInputs::parse(mainApp, header, first, inputsError)) {
+        error = inputsError;
+        return nullptr;
+    }
+
+    const int outDirCol = header.indexOf(OUTPUT_DIR);
+    if (outDirCol >= 0 && outDirCol < first.size() && !first.at(outDirCol).isEmpty()) {
+        sweep->m_indexPath = QString("%1/%2_sweep%3.csv")
+                .arg(first.at(outDirCol), project->name()).arg(row);
+    }
+
+    return sweep;
+}
+
+QStringList Sweep::pointValues(int expId) const
+{
+    QStringList values = m_values;
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        values[m_columns.at(i)] = m_space.point().at(i).toQString();
+    }
+    values[m_header.indexOf(GENERAL_ATTR_EXPID)] = QString::number(expId);
+    return values;
+}
+
+QString Sweep::structureKey(const QStringList& values) const
+{
+    QStringList key;
+    const int numCols = std::min(values.size(), static_cast<int>(m_isStructure.size()));
+    for (int col = 0; col < numCols; ++col) {
+        if (m_isStructure.at(static_cast<size_t>(col))) {
+            key.append(values.at(col));
+        }
+    }
+    return key.join(",");
+}
+
+void Sweep::play()
+{
+    if (m_playing || isDone()) {
+        return;
+    }
+    m_playing = true;
+    for (const ExperimentPtr& exp : m_alive) {
+        exp->play();
+    }
+    checkExperiments();
+}
+
+void Sweep::pause()
+{
+    m_playing = false;
+    for (const ExperimentPtr& exp : m_alive) {
+        if (exp->expStatus() == Status::Running || exp->expStatus() == Status::Queued) {
+            exp->pause();
+        }
+    }
+}
+
+void Sweep::checkExperiments()
+{
+    ProjectPtr project = m_project.lock();
+    for (auto it = m_alive.begin(); it != m_alive.end();) {
+        const ExperimentPtr exp = *it;
+        if (!exp->hasEnded()) {
+            ++it;
+            continue;
+        }
+        if (exp->expStatus() == Status::Invalid) {
+            ++m_numFailed;
+        }
+        it = m_alive.erase(it);
+        ++m_numDone;
+        // its outputs are in the files; let's release the memory
+        disconnect(exp.get(), nullptr, this, nullptr);
+        QString error;
+        if (project) {
+            project->removeExperiment(exp->id(), error);
+        }
+        emit (pointDone());
+    }
+
+    const size_t maxAlive = static_cast<size_t>(std::max(1, m_mainApp->expMgr()->maxThreadsCount()));
+    while (m_playing && m_hasNext && m_alive.size() < maxAlive) {
+        ExperimentPtr exp = createExperiment();
+        if (!exp) {
+            ++m_numFailed;
+            ++m_numDone;
+            emit (pointDone());
+            continue;
+        }
+        // the status changes in the workers; let's handle it in this thread
+        connect(exp.get(), SIGNAL(statusChanged(Status)),
+                SLOT(checkExperiments()), Qt::QueuedConnection);
+        m_alive.emplace_back(exp);
+        exp->play();
+    }
+
+    if (m_playing && isDone()) {
+        m_playing = false;
+        emit (finished());
+    }
+}
+
+ExperimentPtr Sweep::createExperiment()
+{
+    ProjectPtr project = m_project.lock();
+    if (!project) {
+        m_hasNext = false;
+        return nullptr;
+    }
+
+    QStringList values;
+    if (!takePoint(project->generateExpId(), values)) {
+        return nullptr;
+    }
+
+    QString error;
+    ExperimentPtr exp;
+    auto inputs = ExpInputs::parse(m_mainApp, m_header, values, error);
+    if (inputs) {
+        exp = project->newExperiment(std::move(inputs), error);
+    }
+    if (!exp || exp->expStatus() == Status::Invalid) {
+        qWarning() << QString("[sweep %1] unable to create the point:").arg(m_row)
+                   << values.join(",") << error;
+        if (exp) {
+            project->removeExperiment(exp->id(), error);
+        }
+        return nullptr;
+    }
+
+    exp->m_sweepCache = m_cache;
+    exp->m_sweepKey = structureKey(values);
+    return exp;
+}
+
+bool Sweep::takePoint(int expId, QStringList& values)
+{
+    if (!m_hasNext) {
+        return false;
+    }
+    values = pointValues(expId);
+    m_hasNext = m_space.next();
+    writeIndex(values);
+    return true;
+}
+
+void Sweep::writeIndex(const QStringList& values)
+{
+    if (m_indexPath.isEmpty()) {
+        return;
+    }
+
+    QFile file(m_indexPath);
+    const QFile::OpenMode mode = m_indexStarted ? QFile::Append : QFile::Truncate;
+    if (!file.open(QFile::WriteOnly | QFile::Text | mode)) {
+        qWarning() << "unable to list the points of the sweep in" << m_indexPath;
+        m_indexPath.clear();
+        return;
+    }
+
+    QTextStream stream(&file);
+    if (!m_indexStarted) {
+        stream << m_header.join(",") << "\n";
+        m_indexStarted = true;
+    }
+    stream << values.join(",") << "\n";
+}
+
+} // evoplex
@@ -0,0 +1,189 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+
+#include "attributerange.h"
+#include "mainapp.h"
+#include "nodes.h"
+#include "topology_p.h"
+
+namespace evoplex {
+
+class Experiment;
+class Sweep;
+class SweepCache;
+using ExperimentPtr = std::shared_ptr<Experiment>;
+using SweepPtr = std::shared_ptr<Sweep>;
+using SweepCachePtr = std::shared_ptr<SweepCache>;
+
+/**
+ * @brief The cartesian product of a set of attribute ranges.
+ *
+ * The points are visited in order with AttributeRange::next(), starting
+ * from the first value of each range; the last range varies fastest.
+ * Note that the intervals are visited in steps of 1, e.g., 'double[0,2.5]'
+ * gives {0, 1, 2, 2.5}; sets of values should be used for finer steps.
+ */
+class SweepSpace
+{
+public:
+    // the number of values visited in the range;
+    // it is 0 if the range cannot be swept or if a set has repeated values
+    static qint64 count(const AttributeRangePtr& range);
+
+    explicit SweepSpace(std::vector<AttributeRangePtr> ranges);
+
+    // moves to the next point; returns false after the last one
+    bool next();
+
+    inline qint64 size() const { return m_size; }
+    inline const Values& point() const { return m_point; }
+
+private:
+    std::vector<AttributeRangePtr> m_ranges;
+    Values m_first;
+    Values m_point;
+    qint64 m_size;
+};
+
+/**
+ * @brief The nodes and topology shared by the points of a sweep.
+ *
+ * The points which only differ in the model's attributes have the same
+ * graph inputs (identified by a key), so they can start from the same
+ * nodes and, if the graph is deterministic, from the same edges. It only
+ * keeps the structure of the last key, as the points are visited in order.
+ * This class IS thread-safe.
+ */
+class SweepCache
+{
+public:
+    // a copy-on-write clone of the nodes; empty if there are none for 'key'
+    Nodes nodes(const QString& key) const;
+    // keeps a clone of 'nodes', unless the nodes of 'key' are already known
+    void setNodes(const QString& key, const Nodes& nodes);
+
+    TopologyPtr topology(const QString& key) const;
+    void setTopology(const QString& key, TopologyPtr topology);
+
+private:
+    mutable QMutex m_mutex;
+    QString m_key;
+    Nodes m_nodes;
+    TopologyPtr m_topology;
+
+    // forgets the structure of the previous key; the mutex must be locked
+    void setKey(const QString& key);
+};
+
+/**
+ * @brief Expands a row of ranges into experiments, on demand.
+ *
+ * A row of a project whose cells hold attribute ranges (e.g.,
+ * 'int[1;10]' or 'double{0.1;0.2}'; the values are separated by ';'
+ * as the rows are comma separated) describes one experiment for each
+ * point of their SweepSpace. Instead of creating all of them upfront,
+ * the sweep keeps at most one experiment per thread alive: once one is
+ * done, it is removed from the project and the next point is created.
+ * The points are listed in '<outputDirectory>/<project>_sweep<row>.csv'.
+ */
+class Sweep : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Returns nullptr if none of the values is a range, or if the sweep
+    // is not valid; the latter fills the error message.
+    static SweepPtr parse(MainApp* mainApp, ProjectPtr project, int row,
+                          const QStringList& header, const QStringList& values,
+                          QString& error);
+
+    // the row of the next point, with the given experiment id; the point
+    // is also added to the list of points. Returns false if none is left.
+    // It is meant for those who run the points by themselves.
+    bool takePoint(int expId, QStringList& values);
+
+    inline int row() const { return m_row; }
+    inline const QStringList& header() const { return m_header; }
+    inline qint64 size() const { return m_space.size(); }
+    inline qint64 numDone() const { return m_numDone; }
+    inline int numFailed() const { return m_numFailed; }
+    inline bool isDone() const { return !m_hasNext && m_alive.empty(); }
+    inline bool isPlaying() const { return m_playing; }
+
+public slots:
+    // creates and plays the experiments of the next points
+    void play();
+
+    // pauses the alive experiments and stops creating new ones
+    void pause();
+
+signals:
+    void pointDone();
+    void finished();
+
+private slots:
+    // removes the experiments which are done and creates the next ones
+    void checkExperiments();
+
+private:
+    MainApp* m_mainApp;
+    ProjectWPtr m_project;
+    const int m_row;
+    const QStringList m_header;
+    const QStringList m_values;
+    std::vector<int> m_columns; // the columns of each range, in order
+    std::vector<bool> m_isStructure; // the columns in the cache key
+    SweepSpace m_space;
+    bool m_hasNext;
+
+    SweepCachePtr m_cache;
+    std::vector<ExperimentPtr> m_alive;
+    bool m_playing;
+    qint64 m_numDone;
+    int m_numFailed;
+    QString m_indexPath; // the list of points; empty if not written
+    bool m_indexStarted;
+
+    explicit Sweep(MainApp* mainApp, ProjectPtr project, int row,
+                   const QStringList& header, const QStringList& values,
+                   std::vector<int> columns, std::vector<AttributeRangePtr> ranges);
+
+    // the row of the current point, with the given experiment id
+    QStringList pointValues(int expId) const;
+
+    // the values of the columns which define the nodes and edges
+    QString structureKey(const QStringList& values) const;
+
+    // creates the experiment of the current point and moves to the next one
+    // returns nullptr if the point is not valid
+    ExperimentPtr createExperiment();
+
+    // appends a point to the list of points
+    void writeIndex(const QStringList& values);
+};
+
+} // evoplex
+#endif // SWEEP_H
@@ -0,0 +1,61 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtGlobal>
+
+#include "topology_p.h"
+
+namespace evoplex {
+
+Topology::Topology(std::vector<EdgeEntry> edges, std::vector<Attributes> edgeAttrs,
+                   AdjacencyPtr outAdj, AdjacencyPtr inAdj, int numNodes, int lastEdgeId)
+    : m_edges(std::move(edges)),
+      m_edgeAttrs(std::move(edgeAttrs)),
+      m_outAdj(std::move(outAdj)),
+      m_inAdj(std::move(inAdj)),
+      m_numNodes(numNodes),
+      m_lastEdgeId(lastEdgeId)
+{
+    Q_ASSERT(m_edgeAttrs.empty() || m_edgeAttrs.size() == m_edges.size());
+}
+
+static size_t adjacencyMemoryUsage(const Adjacency& adj)
+{
+    return sizeof(Adjacency) + sizeof(int) * (adj.offsets().capacity()
+            + adj.neighbourIds().capacity() + adj.edgeIds().capacity());
+}
+
+size_t Topology::memoryUsage() const
+{
+    size_t bytes = sizeof(Topology) + m_edges.capacity() * sizeof(EdgeEntry);
+    AttributesSchemaPtr lastSchema;
+    for (const Attributes& attrs : m_edgeAttrs) {
+        bytes += attrs.memoryUsage();
+        // the edges usually share a single schema
+        if (attrs.schema() && attrs.schema() != lastSchema) {
+            lastSchema = attrs.schema();
+            bytes += lastSchema->memoryUsage();
+        }
+    }
+    bytes += adjacencyMemoryUsage(*m_outAdj);
+    if (m_inAdj != m_outAdj) {
+        bytes += adjacencyMemoryUsage(*m_inAdj);
+    }
+    return bytes;
+}
+
+} // evoplex
@@ -0,0 +1,87 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TOPOLOGY_P_H
+#define TOPOLOGY_P_H
+
+#include <memory>
+#include <vector>
+
+#include "adjacency.h"
+#include "attributes.h"
+
+namespace evoplex {
+
+class Topology;
+using TopologyPtr = std::shared_ptr<const Topology>;
+
+/**
+ * @brief An immutable snapshot of the edges of a graph.
+ *
+ * Deterministic graph generators build the very same edges for all the
+ * trials of an experiment. So, the first trial takes a snapshot of its
+ * edges and the graphs of the other trials share it: they use its CSR
+ * adjacency straight away and create their own Edge objects only when
+ * they are needed (i.e., copy-on-write).
+ * @see AbstractGraph::shareTopology(), AbstractGraph::adoptTopology()
+ */
+class Topology
+{
+public:
+    //! An edge described by the ids of its nodes.
+    struct EdgeEntry
+    {
+        int id;
+        int originId;
+        int neighbourId;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param edges The edges sorted by id.
+     * @param edgeAttrs The edges' attributes, in the same order of @p edges.
+     * @param outAdj,inAdj The CSR snapshots of the graph.
+     * @param numNodes The number of nodes in the graph.
+     * @param lastEdgeId The last edge id used by the graph.
+     */
+    Topology(std::vector<EdgeEntry> edges, std::vector<Attributes> edgeAttrs,
+             AdjacencyPtr outAdj, AdjacencyPtr inAdj, int numNodes, int lastEdgeId);
+
+    inline const std::vector<EdgeEntry>& edges() const { return m_edges; }
+    inline const std::vector<Attributes>& edgeAttrs() const { return m_edgeAttrs; }
+    inline const AdjacencyPtr& outAdjacency() const { return m_outAdj; }
+    inline const AdjacencyPtr& inAdjacency() const { return m_inAdj; }
+    inline int numNodes() const { return m_numNodes; }
+    inline int numEdges() const { return static_cast<int>(m_edges.size()); }
+    inline int lastEdgeId() const { return m_lastEdgeId; }
+
+    /**
+     * @brief Estimates the memory used by the snapshot, in bytes.
+     */
+    size_t memoryUsage() const;
+
+private:
+    const std::vector<EdgeEntry> m_edges;
+    const std::vector<Attributes> m_edgeAttrs;
+    const AdjacencyPtr m_outAdj;
+    const AdjacencyPtr m_inAdj; // same as m_outAdj for undirected graphs
+    const int m_numNodes;
+    const int m_lastEdgeId;
+};
+
+} // evoplex
+#endif // TOPOLOGY_P_H
@@ -14,28 +14,106 @@
  * limitations under the License.
  */
 
+#include <QDataStream>
 #include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
-#include <QThread>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
 
 #include "abstractgraph.h"
 #include "abstractmodel.h"
+#include "experimentsmgr.h"
+#include "mainapp.h"
 #include "nodes_p.h"
 #include "trial.h"
 #include "project.h"
+#include "sweep.h"
 #include "utils.h"
 
 namespace evoplex {
 
+// partitions per thread; a few more partitions than threads balance
+// the load when some nodes take longer than others
+static const int kPartitionsPerThread = 4;
+
+// identifies the checkpoint files and the layout of their content
+static const quint32 kCheckpointMagic = 0x45564350; // "EVCP"
+static const quint16 kCheckpointVersion = 1;
+
+// the seed of a forked trial is derived with an index that is never
+// used by a partition, so their streams do not overlap
+static const int kForkStream = -1;
+
+namespace {
+
+// the partitions not taken yet; both the calling thread and the
+// helper threads take them one at a time until none is left
+struct PartitionQueue
+{
+    const std::vector<Partition>& parts;
+    const std::function<void(const Partition&)>& func;
+    std::atomic<size_t> next;
+    QSemaphore finished;
+
+    PartitionQueue(const std::vector<Partition>& p, const std::function<void(const Partition&)>& f)
+        : parts(p), func(f), next(0) {}
+
+    void drain() {
+        for (size_t i = next++; i < parts.size(); i = next++) {
+            func(parts[i]);
+        }
+    }
+};
+
+class PartitionWorker : public QRunnable
+{
+public:
+    explicit PartitionWorker(PartitionQueue* queue) : m_queue(queue) {}
+    void run() override { m_queue->drain(); m_queue->finished.release(); }
+private:
+    PartitionQueue* m_queue;
+};
+
+// derives the seed of another stream from the trial's seed (splitmix64);
+// the partitions use their index, the forked trials use kForkStream
+unsigned int deriveSeed(unsigned int trialSeed, int index)
+{
+    quint64 z = (quint64(trialSeed) << 32) + static_cast<quint64>(index) + 1;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<unsigned int>(z ^ (z >> 31));
+}
+
+// runs in the background; the previous checkpoint is only
+// replaced once the new one is completely written
+bool writeCheckpoint(const QString& path, const QByteArray& data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "unable to write the checkpoint" << path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
 Trial::Trial(const quint16 id, ExperimentPtr exp)
     : m_id(id),
       m_exp(exp),
       m_step(-1), // important! a trial starts from -1
       m_status(Status::Disabled),
+      m_converged(false),
+      m_yielded(false),
       m_prg(nullptr),
       m_graph(nullptr),
-      m_model(nullptr)
+      m_model(nullptr),
+      m_reservedMemory(0)
 {
     Q_ASSERT_X(exp, "Trial", "a trial must belong to a valid experiment");
     // important! Trials are deleted by the Experiment class,
@@ -45,9 +123,17 @@ Trial::Trial(const quint16 id, ExperimentPtr exp)
 
 Trial::~Trial()
 {
+    m_checkpointWriter.waitForFinished();
     delete m_graph;
     delete m_model;
     delete m_prg;
+    ExperimentsMgr* expMgr = m_exp->m_mainApp->expMgr();
+    if (expMgr) {
+        expMgr->removeDelayedTrial(this);
+        if (m_reservedMemory > 0) {
+            expMgr->releaseMemory(m_reservedMemory);
+        }
+    }
 }
 
 const QString& Trial::graphId() const
@@ -66,7 +152,9 @@ bool Trial::init()
         return false;
     }
 
-    Nodes nodes = m_exp->cloneCachedNodes(m_id);
+    // the forked trials take (copy-on-write) the nodes of trial 0
+    const Experiment::ForkPoint* forkPoint = m_id > 0 ? m_exp->m_forkPoint.get() : nullptr;
+    Nodes nodes = forkPoint ? NodesPrivate::clone(forkPoint->nodes) : m_exp->cloneCachedNodes(m_id);
     if (nodes.empty()) {
         nodes = m_exp->createNodes();
         if (nodes.empty()) {
@@ -84,7 +172,8 @@ bool Trial::init()
     }
 
     const quint32 seed = m_exp->inputs()->general(GENERAL_ATTR_SEED).toUInt();
-    m_prg = new PRG(seed + m_id);
+    const bool forking = m_exp->m_forkAt > 0 && m_id > 0;
+    m_prg = new PRG(forking ? deriveSeed(seed + m_id, kForkStream) : seed + m_id);
 
     m_graph = dynamic_cast<AbstractGraph*>(m_exp->graphPlugin()->create());
     if (!m_graph || !m_graph->setup(*this, std::move(edgeAttrsGen),
@@ -95,6 +184,22 @@ bool Trial::init()
         return false;
     }
 
+    // the nodes are now stored in the graph's table; the next points
+    // of the sweep can take a copy-on-write clone of them
+    if (!forkPoint && m_exp->m_sweepCache) {
+        m_exp->m_sweepCache->setNodes(m_exp->m_sweepKey, nodes);
+    }
+
+    // a resumed trial takes its graph, PRGs and outputs from the checkpoint
+    QByteArray modelState;
+    const bool resumed = m_exp->m_resumeTrials && restoreCheckpoint(modelState);
+    // otherwise, a forked trial takes the model's state of trial 0
+    const bool forked = !resumed && forkPoint;
+    if (forked) {
+        modelState = forkPoint->modelState;
+        m_step = forkPoint->step;
+    }
+
     m_model = dynamic_cast<AbstractModel*>(m_exp->modelPlugin()->create());
     if (!m_model || !m_model->setup(*this, *m_exp->inputs()->model())) {
         qWarning() << "unable to create the trials."
@@ -103,7 +208,28 @@ bool Trial::init()
         return false;
     }
 
-    if (!m_exp->inputs()->fileCaches().empty()) {
+    if (resumed || forked) {
+        QDataStream in(modelState);
+        in.setVersion(QDataStream::Qt_5_8);
+        if (!m_model->restoreState(in)) {
+            qWarning() << "unable to resume the trials."
+                       << "The model could not restore its state."
+                       << "Experiment:" << m_exp->id();
+            return false;
+        }
+    }
+
+    // a forked trial takes the edges of trial 0 before its fork point is
+    // written; they are only created when they are needed
+    if (forked && (forkPoint->lattice ? !m_graph->setLattice(*forkPoint->lattice)
+                                      : !m_graph->adoptTopology(forkPoint->topology))) {
+        qWarning() << "unable to fork the trials."
+                   << "The graph could not take the edges of trial 0."
+                   << "Experiment:" << m_exp->id();
+        return false;
+    }
+
+    if (!resumed && !m_exp->inputs()->fileCaches().empty()) {
         const QString fpath = m_exp->m_filePathPrefix + QString("%4.csv").arg(m_id);
         QFile file(fpath);
         if (file.open(QFile::WriteOnly | QFile::Truncate)) {
@@ -115,26 +241,68 @@ bool Trial::init()
             return false;
         }
 
-        // write this initial step to file
+        // write this initial step (or the fork point) to file
         for (auto const& output : m_exp->m_outputs) {
             output->doOperation(this);
         }
         writeCachedSteps(m_exp.get());
     }
 
-    // make the set of nodes available for other trials
-    if (m_exp->numTrials() > 1 && m_exp->m_clonableNodes.empty()) {
+    if (resumed || forked) {
+        m_exp->m_stepsDone += m_step; // counts the progress made before
+    } else {
+        m_step = 0; // important!
+    }
+
+    // the last forked trial has been set up; let's release the fork point
+    if (forkPoint && --m_exp->m_pendingForks == 0) {
+        m_exp->m_forkPoint.reset();
+    }
+
+    if (!forked && !resumed && !m_graph->adoptTopology(m_exp->sharedTopology())) {
+        // set-up the edges for the first time; the topology of deterministic
+        // graphs is built only once and shared by all trials (and points)
+        if (!m_graph->reset()) {
+            qWarning() << "unable to create the trials."
+                       << "The graph could not be initialized."
+                       << "Experiment:" << m_exp->id();
+            return false;
+        }
+        if ((m_exp->numTrials() > 1 || m_exp->m_sweepCache) && m_exp->m_forkAt == 0 &&
+                m_exp->graphPlugin()->isDeterministic()) {
+            m_exp->m_sharedTopology = m_graph->shareTopology();
+            if (m_exp->m_sweepCache) {
+                m_exp->m_sweepCache->setTopology(m_exp->m_sweepKey, m_exp->m_sharedTopology);
+            }
+        }
+    }
+
+    // make the set of nodes available for other trials, unless they
+    // are forked; note that the graph may have changed the nodes' coordinates
+    if (m_exp->numTrials() > 1 && m_exp->m_forkAt == 0 && m_exp->m_clonableNodes.empty()) {
         m_exp->m_clonableNodes = NodesPrivate::clone(nodes);
     }
 
-    m_step = 0; // important!
+    // the last trial has taken the cached nodes; let's release the topology
+    if (m_exp->m_clonableNodes.empty()) {
+        m_exp->m_sharedTopology.reset();
+    }
 
-    // set-up the edges for the first time
-    if (!m_graph->reset()) {
-        qWarning() << "unable to create the trials."
-                   << "The graph could not be initialized."
-                   << "Experiment:" << m_exp->id();
-        return false;
+    if (m_exp->stopCondition().type() != StopCondition::Type::None) {
+        m_convergence.reset(new ConvergenceMonitor(m_exp->stopCondition()));
+    }
+
+    // builds the neighbourhood snapshot before the first step; a lattice
+    // computes the neighbours on the fly instead
+    if (!m_graph->lattice()) {
+        m_graph->updateAdjacency();
+    }
+
+    // all trials have similar graphs; measure the footprint only once and
+    // use it in place of the estimate for the next trials
+    if (m_id == 0) {
+        m_exp->m_mainApp->expMgr()->calibrateMemory(this, static_cast<qint64>(
+                m_graph->nodesMemoryUsage() + m_graph->edgesMemoryUsage()));
     }
 
     return true;
@@ -166,14 +334,31 @@ void Trial::run()
     }
 
     m_status = Status::Running;
-    emit (m_exp->trialCreated(m_id));
+    const bool resumed = m_yielded;
+    if (!resumed) {
+        emit (m_exp->trialCreated(m_id));
+    }
+    m_yielded = false;
 
-    if (!runSteps() || m_step >= m_exp->stopAt()) {
+    if (!runSteps(resumed) || m_step >= m_exp->stopAt()) {
         if (writeCachedSteps(m_exp.get())) {
             m_status = Status::Finished;
         } else {
             m_status = Status::Invalid;
         }
+        // the trial is over; there is nothing to resume
+        m_checkpointWriter.waitForFinished();
+        const QString path = m_exp->checkpointPath(m_id);
+        if (!path.isEmpty()) {
+            QFile::remove(path);
+        }
+    } else if (m_step < m_exp->pauseAt()) {
+        // it has given way to the waiting trials, or it waits for the
+        // experiment's delay; see runSteps()
+        m_status = Status::Queued;
+        m_yielded = true;
+        m_exp->m_mainApp->expMgr()->requeueTrial(this, m_exp->delay());
+        return;
     } else {
         m_status = Status::Paused;
     }
@@ -181,34 +366,84 @@ void Trial::run()
     m_exp->trialFinished(this);
 }
 
-bool Trial::runSteps()
+bool Trial::runSteps(bool resumed)
 {
     const Experiment* exp = m_exp.get();
 
     QElapsedTimer t;
     t.start();
 
-    m_model->beforeLoop();
+    const ExperimentsMgr* expMgr = exp->m_mainApp->expMgr();
+    const int stepsToCheckpoint = exp->m_mainApp->stepsToCheckpoint();
+    bool checkpoints = stepsToCheckpoint > 0 && !exp->checkpointPath(m_id).isEmpty();
+
+    // trial 0 may have been paused (or resumed) at the fork point
+    const bool forks = m_id == 0 && exp->m_forkAt > 0 && !exp->m_forked;
+    if (forks && m_step >= exp->m_forkAt) {
+        fork();
+    }
+
+    // the loop goes on across the requeues; see run()
+    if (!resumed) {
+        m_model->beforeLoop();
+    }
 
     bool hasNext = true;
     while (m_step < exp->pauseAt() && hasNext) {
         hasNext = m_model->algorithmStep();
+        m_graph->m_nodeAttrs->swapBuffers(); // the next values become current
         ++m_step;
+        m_exp->stepDone();
+
+        // models rewiring the graph leave tombstones behind; once they
+        // outnumber the live nodes or edges, it is cheaper to drop them
+        if (m_graph->fragmentation() > 0.5) {
+            m_graph->squeeze();
+        }
 
         for (const OutputPtr& output : exp->m_outputs) {
             output->doOperation(this);
         }
 
+        // the outputs have settled down; the remaining steps are counted as done
+        if (m_convergence && hasConverged()) {
+            m_converged = true;
+            hasNext = false;
+            m_exp->stepDone(exp->stopAt() - m_step);
+        }
+
         if (m_step % exp->m_mainApp->stepsToFlush() == 0 && !writeCachedSteps(exp)) {
             m_status = Status::Invalid;
+            if (forks && !exp->m_forked) {
+                fork(); // the forked trials are dropped with the experiment
+            }
             return false;
         }
 
-        if (exp->delay() > 0) {
-            QThread::msleep(exp->delay());
+        if (forks && m_step == exp->m_forkAt) {
+            fork();
+        }
+
+        if (checkpoints && m_step % stepsToCheckpoint == 0 && !saveCheckpoint()) {
+            qWarning() << QString("[E%1:T%2] the model could not save its state;"
+                                  " no more checkpoints will be written.").arg(exp->id()).arg(m_id);
+            checkpoints = false;
+        }
+
+        // the delay is waited out of the worker, and other trials may be
+        // waiting for their turn; the loop is resumed once it is queued again
+        if (hasNext && m_step < exp->pauseAt() &&
+                (exp->delay() > 0 || expMgr->timeSliceExpired(t.elapsed()))) {
+            return true;
         }
     }
 
+    // trial 0 has ended before the fork point, e.g., it has converged or
+    // it has been stopped; the forked trials must not wait for it
+    if (forks && !exp->m_forked && (!hasNext || m_step >= exp->stopAt())) {
+        fork();
+    }
+
     m_model->afterLoop();
 
     qDebug() << QString("[E%1:T%2] %3s").arg(exp->id())
@@ -217,6 +452,72 @@ bool Trial::runSteps()
     return hasNext;
 }
 
+void Trial::parallelFor(const std::function<void(const Partition&)>& func)
+{
+    QThreadPool* pool = m_exp->m_mainApp->expMgr()->threadPool();
+    const int maxThreads = std::max(1, pool->maxThreadCount());
+
+    // the partitions are made of whole blocks of 'kAlignment' ids
+    const int numBlocks = (m_graph->m_lastNodeId + Partition::kAlignment) / Partition::kAlignment;
+    const int blocksPerPart = std::max(1, (numBlocks + kPartitionsPerThread * maxThreads - 1)
+                                       / (kPartitionsPerThread * maxThreads));
+    const int numParts = std::max(1, (numBlocks + blocksPerPart - 1) / blocksPerPart);
+
+    if (m_partitionPrgs.size() != static_cast<size_t>(numParts)) {
+        m_partitionPrgs.clear();
+        for (int i = 0; i < numParts; ++i) {
+            m_partitionPrgs.emplace_back(new PRG(deriveSeed(m_prg->seed(), i)));
+        }
+    }
+
+    const int endId = m_graph->m_lastNodeId + 1;
+    const int partSize = blocksPerPart * Partition::kAlignment;
+    std::vector<Partition> parts;
+    parts.reserve(static_cast<size_t>(numParts));
+    for (int i = 0; i < numParts; ++i) {
+        parts.push_back(Partition(i, numParts, std::min(endId, i * partSize),
+                                  std::min(endId, (i + 1) * partSize),
+                                  m_partitionPrgs[static_cast<size_t>(i)].get()));
+    }
+
+    // the partitions may write to the nodes' attributes; the shared
+    // columns are copied here, as it is not thread-safe to do it on write
+    m_graph->m_nodeAttrs->detachAll();
+
+    // the helpers only take the idle threads of the pool; if there is
+    // none, all partitions run in this thread
+    PartitionQueue queue(parts, func);
+    int numHelpers = 0;
+    for (int i = 1; i < std::min(numParts, maxThreads); ++i) {
+        PartitionWorker* worker = new PartitionWorker(&queue);
+        if (!pool->tryStart(worker)) {
+            delete worker;
+            break;
+        }
+        ++numHelpers;
+    }
+    try {
+        queue.drain();
+    } catch (...) {
+        queue.next = parts.size(); // the helpers must not outlive the queue
+        queue.finished.acquire(numHelpers);
+        throw;
+    }
+    queue.finished.acquire(numHelpers);
+}
+
+bool Trial::hasConverged()
+{
+    Values values;
+    for (const Cache* cache : m_exp->inputs()->fileCaches()) {
+        if (!cache->isEmpty(m_id)) {
+            const Values& row = cache->readBackRow(m_id).second;
+            values.insert(values.end(), row.cbegin(), row.cend());
+        }
+    }
+    return m_convergence->update(values);
+}
+
 bool Trial::writeCachedSteps(const Experiment* exp) const
 {
     if (exp->inputs()->fileCaches().empty() ||
@@ -252,4 +553,219 @@ bool Trial::writeCachedSteps(const Experiment* exp) const
     return true;
 }
 
+Values Trial::checkpointInputs() const
+{
+    // the trials can be resumed with a different stop criterion
+    Values inputs = m_exp->inputs()->exportAttrValues();
+    const int stopAt = m_exp->inputs()->general()->indexOf(GENERAL_ATTR_STOPAT);
+    if (stopAt >= 0) {
+        inputs[static_cast<size_t>(stopAt)] = Value();
+    }
+    return inputs;
+}
+
+bool Trial::saveCheckpoint()
+{
+    QByteArray modelState;
+    QDataStream ms(&modelState, QIODevice::WriteOnly);
+    ms.setVersion(QDataStream::Qt_5_8);
+    if (!m_model->saveState(ms)) {
+        return false;
+    }
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_8);
+    out << kCheckpointMagic << kCheckpointVersion;
+
+    const Values inputs = checkpointInputs();
+    out << static_cast<quint32>(inputs.size());
+    for (const Value& v : inputs) {
+        out << v;
+    }
+
+    out << static_cast<qint32>(m_step);
+    out << QByteArray::fromStdString(m_prg->state());
+    out << static_cast<quint32>(m_partitionPrgs.size());
+    for (auto const& prg : m_partitionPrgs) {
+        out << QByteArray::fromStdString(prg->state());
+    }
+
+    // the rows written to the csv file are kept; the ones in the caches are saved
+    const Experiment* exp = m_exp.get();
+    const QString csvPath = exp->m_filePathPrefix + QString("%1.csv").arg(m_id);
+    out << static_cast<qint64>(exp->inputs()->fileCaches().empty() ? 0 : QFileInfo(csvPath).size());
+    for (const Cache* cache : exp->inputs()->fileCaches()) {
+        const auto& rows = cache->rows(m_id);
+        out << static_cast<quint32>(std::distance(rows.begin(), rows.end()));
+        for (const Cache::Row& row : rows) {
+            out << static_cast<qint32>(row.first) << static_cast<quint32>(row.second.size());
+            for (const Value& v : row.second) {
+                out << v;
+            }
+        }
+    }
+
+    out << modelState;
+    m_graph->saveState(out);
+
+    // the previous checkpoint must be written before it is replaced
+    m_checkpointWriter.waitForFinished();
+    m_checkpointWriter = QtConcurrent::run(writeCheckpoint, exp->checkpointPath(m_id), data);
+    return true;
+}
+
+bool Trial::restoreCheckpoint(QByteArray& modelState)
+{
+    const Experiment* exp = m_exp.get();
+    QFile file(exp->checkpointPath(m_id));
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_8);
+    quint32 magic;
+    quint16 version;
+    in >> magic >> version;
+    if (magic != kCheckpointMagic || version != kCheckpointVersion) {
+        qWarning() << "ignoring an invalid checkpoint:" << file.fileName();
+        return false;
+    }
+
+    quint32 numInputs;
+    in >> numInputs;
+    Values inputs;
+    for (quint32 i = 0; i < numInputs && in.status() == QDataStream::Ok; ++i) {
+        Value v;
+        in >> v;
+        inputs.emplace_back(v);
+    }
+    if (inputs != checkpointInputs()) {
+        qWarning() << "ignoring a checkpoint of different inputs:" << file.fileName();
+        return false;
+    }
+
+    qint32 step;
+    QByteArray prgState;
+    quint32 numPartitionPrgs;
+    in >> step >> prgState >> numPartitionPrgs;
+    std::vector<QByteArray> partitionPrgStates;
+    for (quint32 i = 0; i < numPartitionPrgs && in.status() == QDataStream::Ok; ++i) {
+        QByteArray state;
+        in >> state;
+        partitionPrgStates.emplace_back(state);
+    }
+
+    qint64 csvSize;
+    in >> csvSize;
+    std::vector<std::vector<Cache::Row>> cachedRows;
+    for (size_t c = 0; c < exp->inputs()->fileCaches().size() && in.status() == QDataStream::Ok; ++c) {
+        quint32 numRows;
+        in >> numRows;
+        std::vector<Cache::Row> rows;
+        for (quint32 r = 0; r < numRows && in.status() == QDataStream::Ok; ++r) {
+            qint32 rowNumber;
+            quint32 numValues;
+            in >> rowNumber >> numValues;
+            Values values;
+            for (quint32 i = 0; i < numValues && in.status() == QDataStream::Ok; ++i) {
+                Value v;
+                in >> v;
+                values.emplace_back(v);
+            }
+            rows.emplace_back(rowNumber, values);
+        }
+        cachedRows.emplace_back(std::move(rows));
+    }
+    in >> modelState;
+
+    // the csv file must still hold the rows flushed before the checkpoint
+    QFile csv(exp->m_filePathPrefix + QString("%1.csv").arg(m_id));
+    const bool hasCsv = !exp->inputs()->fileCaches().empty();
+    if (in.status() != QDataStream::Ok || step < 0 ||
+            !PRG(m_prg->seed()).setState(prgState.toStdString()) ||
+            (hasCsv && csv.size() < csvSize) || !m_graph->restoreState(in)) {
+        qWarning() << "ignoring a corrupted checkpoint:" << file.fileName();
+        return false;
+    }
+
+    // the graph has been restored; from now on, nothing can fail
+    m_step = step;
+    m_prg->setState(prgState.toStdString());
+    m_partitionPrgs.clear();
+    for (size_t i = 0; i < partitionPrgStates.size(); ++i) {
+        m_partitionPrgs.emplace_back(new PRG(deriveSeed(m_prg->seed(), static_cast<int>(i))));
+        m_partitionPrgs.back()->setState(partitionPrgStates[i].toStdString());
+    }
+
+    if (hasCsv) {
+        csv.resize(csvSize); // drops the rows written after the checkpoint
+        for (size_t c = 0; c < cachedRows.size(); ++c) {
+            Cache* cache = exp->inputs()->fileCaches()[c];
+            while (!cache->isEmpty(m_id)) {
+                cache->flushFrontRow(m_id);
+            }
+            for (const Cache::Row& row : cachedRows[c]) {
+                cache->appendRow(m_id, row);
+            }
+        }
+    }
+
+    qDebug() << QString("[E%1:T%2] resumed at step %3").arg(exp->id()).arg(m_id).arg(m_step);
+    return true;
+}
+
+void Trial::fork()
+{
+    Experiment* exp = m_exp.get();
+
+    std::unique_ptr<Experiment::ForkPoint> point;
+    if (m_step == exp->m_forkAt) {
+        point.reset(new Experiment::ForkPoint);
+        point->step = m_step;
+        QDataStream out(&point->modelState, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_8);
+        if (m_model->saveState(out)) {
+            // both are shared (copy-on-write) with the forked graphs
+            point->nodes = NodesPrivate::clone(m_graph->nodes());
+            if (m_graph->lattice()) {
+                point->lattice.reset(new Lattice(*m_graph->lattice()));
+            } else {
+                point->topology = m_graph->shareTopology();
+            }
+            qDebug() << QString("[E%1:T%2] forking the trials at step %3")
+                        .arg(exp->id()).arg(m_id).arg(m_step);
+        } else {
+            qWarning() << QString("[E%1:T%2] the model could not save its state;"
+                                  " the other trials will start from scratch.").arg(exp->id()).arg(m_id);
+            point.reset();
+        }
+    } else if (m_step < exp->m_forkAt) {
+        qWarning() << QString("[E%1:T%2] ended before the fork point;"
+                              " the other trials will start from scratch.").arg(exp->id()).arg(m_id);
+    } else {
+        qWarning() << QString("[E%1:T%2] resumed after the fork point;"
+                              " the other trials will start from scratch.").arg(exp->id()).arg(m_id);
+    }
+
+    exp->m_mutex.lock();
+    if (point) {
+        // the trials queued by playForks(); each one takes the point once
+        exp->m_pendingForks = 0;
+        for (auto const& it : exp->m_trials) {
+            if (it.first != 0 && it.second->status() == Status::Disabled) {
+                ++exp->m_pendingForks;
+            }
+        }
+    }
+    exp->m_forkPoint = std::move(point);
+    exp->m_forked = true;
+    exp->m_mutex.unlock();
+
+    exp->m_mainApp->expMgr()->playForks(m_exp);
+}
+
 } // evoplex
@@ -17,11 +17,17 @@
 #ifndef TRIAL_H
 #define TRIAL_H
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
+#include <QByteArray>
+#include <QFuture>
 #include <QRunnable>
 
 #include "enum.h"
 #include "experiment.h"
+#include "partition.h"
 
 namespace evoplex {
 
@@ -34,6 +40,23 @@ namespace evoplex {
  * is incremented by 1 from the root seed. For exemple, if an experiment
  * seeded with '111' has 3 trials, the seeds of the trials will be '111',
  * '112' and '113'.
+ *
+ * If MainApp::stepsToCheckpoint() is set, a trial saves its state every N
+ * steps next to its csv output file. An experiment played again after
+ * Evoplex is restarted resumes its trials from there (Experiment::resume()).
+ *
+ * If the experiment has a fork point (GENERAL_ATTR_FORKAT), only trial 0
+ * runs the first steps. The other trials start from its state at that step,
+ * each one with a fresh seed derived from its usual one. If trial 0 ends
+ * before that step, they start from scratch instead.
+ *
+ * If the experiment has a StopCondition (GENERAL_ATTR_STOPWHEN), a trial
+ * also stops once its outputs meet it, e.g., when they do not change.
+ *
+ * If ExperimentsMgr::timeSlice() is set, a trial which has run for that
+ * long while other trials are waiting is queued again, with its state intact.
+ * Likewise, the trials of an experiment with a delay run one step at a time
+ * and are queued again once the delay is over, so they do not hold a worker.
  */
 class Trial : public QRunnable
 {
@@ -55,32 +78,78 @@ public:
     inline Status status() const;
     inline int step() const;
     inline int stopAt() const;
+    // true if the trial has stopped as its outputs met the stop condition
+    inline bool converged() const;
 
     inline PRG* prg() const;
     inline const AbstractModel* model() const;
     inline AbstractGraph* graph() const;
 
+    // Runs 'func' for each partition of the nodes' ids, in parallel.
+    // The number of partitions depends on the number of nodes and on the
+    // max number of threads, and each one has its own PRG stream.
+    void parallelFor(const std::function<void(const Partition&)>& func);
+
 private:
     const quint16 m_id;
     ExperimentPtr m_exp;
     int m_step;
     Status m_status;
+    bool m_converged;
+    bool m_yielded; // it has been queued again while running; see run()
 
     PRG* m_prg;
     AbstractGraph* m_graph;
     AbstractModel* m_model;
 
+    // the PRG streams of the partitions; kept across the steps
+    std::vector<std::unique_ptr<PRG>> m_partitionPrgs;
+
+    // tells when the outputs meet the experiment's stop condition
+    std::unique_ptr<ConvergenceMonitor> m_convergence;
+
+    // writes the latest checkpoint in the background
+    QFuture<bool> m_checkpointWriter;
+
+    // the bytes reserved in the ExperimentsMgr's memory budget
+    qint64 m_reservedMemory;
+
     // We can safely consider that all parameters are valid at this point.
     // However, some things might fail (eg, missing nodes, broken graph etc),
     // and, in that case, false is returned.
     bool init();
 
     // The main loop for calling the model steps
-    // Returns true if it has a next step
-    bool runSteps();
+    // Returns true if it has a next step; it also returns early (true) if
+    // the time slice is over or after each step of a delayed experiment.
+    // An early return leaves the loop open, i.e., afterLoop() is not called,
+    // and 'resumed' is true when the loop is picked up again.
+    bool runSteps(bool resumed);
+
+    // Feeds the outputs of the current step to 'm_convergence'.
+    // Returns true if the trial has converged.
+    bool hasConverged();
 
     // If any file output is set, it'll write the cached steps to file.
     bool writeCachedSteps(const Experiment* exp) const;
+
+    // Takes a snapshot of the graph, the PRGs, the step, the model's state
+    // and the outputs not flushed yet, and writes it in the background.
+    // Returns false if the model cannot save its state.
+    bool saveCheckpoint();
+
+    // Restores the snapshot taken by saveCheckpoint() into the graph set
+    // up by init(). The model's state is returned, as it can only be
+    // restored after the model's init(). Returns false (and changes
+    // nothing) if there is no valid checkpoint for the current inputs.
+    bool restoreCheckpoint(QByteArray& modelState);
+
+    // The inputs that must not change for a checkpoint to be resumed.
+    Values checkpointInputs() const;
+
+    // Called by trial 0 once it reaches the fork point, or once it ends
+    // before it. It shares its state with the other trials and queues them.
+    void fork();
 };
 
 /************************************************************************
@@ -96,6 +165,9 @@ inline int Trial::step() const
 inline int Trial::stopAt() const
 { return m_exp->stopAt(); }
 
+inline bool Trial::converged() const
+{ return m_converged; }
+
 inline Status Trial::status() const
 { return m_status; }
 
@@ -0,0 +1,221 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QRunnable>
+#include <algorithm>
+
+#include "trialscheduler.h"
+
+namespace evoplex {
+
+class TrialScheduler::WorkerTask : public QRunnable
+{
+public:
+    WorkerTask(TrialScheduler* scheduler, size_t w)
+        : m_scheduler(scheduler), m_w(w) {}
+    void run() override { m_scheduler->work(m_w); }
+
+private:
+    TrialScheduler* m_scheduler;
+    const size_t m_w;
+};
+
+TrialScheduler::TrialScheduler(QThreadPool* pool, int numWorkers, RunFunc run, AdmitFunc admit)
+    : m_pool(pool),
+      m_run(std::move(run)),
+      m_admit(std::move(admit)),
+      m_nextWorker(0),
+      m_numQueued(0),
+      m_numRunning(0),
+      m_epoch(0)
+{
+    Q_ASSERT_X(m_pool, "TrialScheduler", "the pool must be valid");
+    setNumWorkers(numWorkers);
+}
+
+TrialScheduler::~TrialScheduler()
+{
+    remove([](Trial*) { return true; });
+    m_pool->waitForDone();
+}
+
+void TrialScheduler::setNumWorkers(int numWorkers)
+{
+    Q_ASSERT_X(m_numQueued == 0, "TrialScheduler", "there are queued trials");
+    m_pool->waitForDone(); // the current workers are about to exit
+    m_workers.clear();
+    for (int w = 0; w < std::max(1, numWorkers); ++w) {
+        m_workers.emplace_back(new Worker());
+    }
+}
+
+void TrialScheduler::enqueue(const std::vector<Trial*>& trials)
+{
+    // counted first, so that a worker never exits with trials in its deque
+    m_numQueued += static_cast<int>(trials.size());
+    const size_t first = m_nextWorker.fetch_add(trials.size());
+    for (size_t i = 0; i < trials.size(); ++i) {
+        Worker* worker = m_workers[(first + i) % m_workers.size()].get();
+        QMutexLocker locker(&worker->mutex);
+        worker->trials.push_back(trials[i]);
+    }
+    ++m_epoch;
+
+    for (size_t i = 0; i < std::min(trials.size(), m_workers.size()); ++i) {
+        wake((first + i) % m_workers.size());
+    }
+}
+
+void TrialScheduler::requeue(Trial* trial)
+{
+    ++m_numQueued;
+    QMutexLocker locker(&m_yieldedMutex);
+    m_yielded.push_back(trial);
+    locker.unlock();
+    ++m_epoch;
+
+    // its own worker takes a trial right after; this one covers the others
+    wake(m_nextWorker++ % m_workers.size());
+}
+
+int TrialScheduler::remove(const std::function<bool(Trial*)>& pred)
+{
+    int numRemoved = 0;
+    for (auto& worker : m_workers) {
+        QMutexLocker locker(&worker->mutex);
+        auto it = worker->trials.begin();
+        while (it != worker->trials.end()) {
+            if (pred(*it)) {
+                it = worker->trials.erase(it);
+                ++numRemoved;
+            } else {
+                ++it;
+            }
+        }
+    }
+    QMutexLocker locker(&m_yieldedMutex);
+    auto it = std::remove_if(m_yielded.begin(), m_yielded.end(), pred);
+    numRemoved += static_cast<int>(m_yielded.end() - it);
+    m_yielded.erase(it, m_yielded.end());
+    locker.unlock();
+    m_numQueued -= numRemoved;
+    return numRemoved;
+}
+
+bool TrialScheduler::anyQueued(const std::function<bool(Trial*)>& pred) const
+{
+    for (auto const& worker : m_workers) {
+        QMutexLocker locker(&worker->mutex);
+        if (std::any_of(worker->trials.cbegin(), worker->trials.cend(), pred)) {
+            return true;
+        }
+    }
+    QMutexLocker locker(&m_yieldedMutex);
+    return std::any_of(m_yielded.cbegin(), m_yielded.cend(), pred);
+}
+
+void TrialScheduler::retry()
+{
+    ++m_epoch;
+    if (m_numQueued > 0) {
+        for (size_t w = 0; w < m_workers.size(); ++w) {
+            wake(w);
+        }
+    }
+}
+
+void TrialScheduler::wake(size_t w)
+{
+    bool expected = false;
+    if (m_workers[w]->active.compare_exchange_strong(expected, true)) {
+        m_pool->start(new WorkerTask(this, w));
+    }
+}
+
+void TrialScheduler::work(size_t w)
+{
+    Worker* self = m_workers[w].get();
+    while (true) {
+        const unsigned epoch = m_epoch;
+        while (Trial* trial = take(w)) { // counted as running by take()
+            m_run(trial);
+            --m_numRunning;
+        }
+        self->active = false;
+        // a trial may have been queued (or become admissible) after the last take()
+        bool expected = false;
+        if (m_epoch == epoch || !self->active.compare_exchange_strong(expected, true)) {
+            return;
+        }
+    }
+}
+
+Trial* TrialScheduler::take(size_t w)
+{
+    // the trial is counted as running before it is admitted; thus, the
+    // other workers do not force one in while it is being admitted
+    ++m_numRunning;
+    if (Trial* trial = takeFirst(w, false)) {
+        return trial;
+    }
+    --m_numRunning;
+
+    // none is admitted; if nothing is running, the first one is forced in.
+    // Checking and counting it in one step lets a single worker force one
+    int numRunning = 0;
+    if (!m_admit || !m_numRunning.compare_exchange_strong(numRunning, 1)) {
+        return nullptr;
+    }
+    if (Trial* trial = takeFirst(w, true)) {
+        return trial;
+    }
+    --m_numRunning;
+    return nullptr;
+}
+
+Trial* TrialScheduler::takeFirst(size_t w, bool force)
+{
+    // its own trials first, then the ones of the next workers; the trials
+    // which are not admitted are left in their place
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        Worker* worker = m_workers[(w + i) % m_workers.size()].get();
+        QMutexLocker locker(&worker->mutex);
+        for (auto it = worker->trials.begin(); it != worker->trials.end(); ++it) {
+            Trial* trial = *it;
+            if (!m_admit || m_admit(trial, force)) {
+                worker->trials.erase(it);
+                --m_numQueued;
+                return trial;
+            }
+        }
+    }
+
+    // the trials which have given way go last, so they do not take
+    // their worker again while the others wait
+    QMutexLocker locker(&m_yieldedMutex);
+    for (auto it = m_yielded.begin(); it != m_yielded.end(); ++it) {
+        Trial* trial = *it;
+        if (!m_admit || m_admit(trial, force)) {
+            m_yielded.erase(it);
+            --m_numQueued;
+            return trial;
+        }
+    }
+    return nullptr;
+}
+
+} // evoplex
@@ -0,0 +1,153 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TRIAL_SCHEDULER_H
+#define TRIAL_SCHEDULER_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+#include <QThreadPool>
+
+namespace evoplex {
+
+class Trial;
+
+/**
+ * @brief A work-stealing scheduler of trials.
+ *
+ * Each worker has its own deque of trials. The queued trials are spread
+ * over the deques in a round-robin fashion and each worker runs its own
+ * trials in FIFO order; once its deque is empty, it steals the oldest
+ * trial of the other workers. Thus, the trials start roughly in the
+ * order they were queued, regardless of their experiment.
+ *
+ * The workers run on the threads of a QThreadPool and return them to
+ * the pool when there is nothing left to do, so that the idle threads
+ * can be used by the trials' parallel steps.
+ *
+ * A trial is only started if the admission function lets it, e.g., if
+ * there is enough memory for it. Otherwise, it is left in its place and
+ * taken again after retry() is called; the trials behind it may start.
+ *
+ * A running trial may also give way to the queued ones with requeue()
+ * (see ExperimentsMgr::setTimeSlice()). It waits in a separate queue,
+ * which is only taken from when no other trial can be started.
+ */
+class TrialScheduler
+{
+public:
+    //! Called by a worker to run each trial.
+    using RunFunc = std::function<void(Trial*)>;
+    //! Tells if a trial can be started; 'force' is true if no trial is running.
+    using AdmitFunc = std::function<bool(Trial*, bool force)>;
+
+    /**
+     * @brief Constructor.
+     * @param pool The pool providing the threads.
+     * @param numWorkers The max number of trials running at the same time.
+     * @param run The function which runs a trial.
+     * @param admit The function which admits a trial; all are admitted if null.
+     */
+    TrialScheduler(QThreadPool* pool, int numWorkers, RunFunc run, AdmitFunc admit = AdmitFunc());
+    ~TrialScheduler();
+
+    /**
+     * @brief Gets the max number of trials running at the same time.
+     */
+    inline int numWorkers() const { return static_cast<int>(m_workers.size()); }
+
+    /**
+     * @brief Sets the max number of trials running at the same time.
+     * @warning It must not be called while there are trials in the queue.
+     */
+    void setNumWorkers(int numWorkers);
+
+    /**
+     * @brief Queues the \p trials, which are started in the same order.
+     */
+    void enqueue(const std::vector<Trial*>& trials);
+
+    /**
+     * @brief Queues again a \p trial which gives way to the others.
+     * It is started again once none of the other queued trials can be,
+     * after the trials which have given way before it.
+     */
+    void requeue(Trial* trial);
+
+    /**
+     * @brief Removes the queued trials for which \p pred returns true.
+     * @returns The number of trials removed.
+     */
+    int remove(const std::function<bool(Trial*)>& pred);
+
+    /**
+     * @brief Gets the number of trials waiting to be started.
+     */
+    inline int numQueued() const { return m_numQueued; }
+
+    /**
+     * @brief Checks if \p pred returns true for any of the queued trials.
+     */
+    bool anyQueued(const std::function<bool(Trial*)>& pred) const;
+
+    /**
+     * @brief Takes the trials which were not admitted again.
+     * It should be called when they are more likely to be admitted.
+     */
+    void retry();
+
+private:
+    struct Worker {
+        QMutex mutex;
+        std::deque<Trial*> trials;
+        std::atomic<bool> active;
+        Worker() : active(false) {}
+    };
+    class WorkerTask;
+
+    QThreadPool* m_pool;
+    const RunFunc m_run;
+    const AdmitFunc m_admit;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    // the trials which have given way to the others, in FIFO order
+    mutable QMutex m_yieldedMutex;
+    std::deque<Trial*> m_yielded;
+    std::atomic<size_t> m_nextWorker; // round-robin
+    std::atomic<int> m_numQueued;
+    std::atomic<int> m_numRunning; // including the trials being admitted
+    // changes whenever there might be new trials to take
+    std::atomic<unsigned> m_epoch;
+
+    // starts the worker 'w' if it is not running yet
+    void wake(size_t w);
+    // the main loop of the worker 'w'
+    void work(size_t w);
+    // takes a trial from the worker's own deque or steals one from the others;
+    // it is counted as running
+    Trial* take(size_t w);
+    // takes the first trial admitted (or forced in) from the deques,
+    // then from the trials which have given way
+    Trial* takeFirst(size_t w, bool force);
+};
+
+} // evoplex
+#endif // TRIAL_SCHEDULER_H
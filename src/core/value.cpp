@@ -15,6 +15,7 @@
  */
 
 #include <stdexcept>
+#include <QDataStream>
 #include <QString>
 #include "value.h"
 
@@ -209,6 +210,38 @@ bool Value::operator>=(const Value& v) const
     }
 }
 
+QDataStream& operator<<(QDataStream& out, const Value& value)
+{
+    out << static_cast<quint8>(value.type());
+    switch (value.type()) {
+    case Value::BOOL: out << value.toBool(); break;
+    case Value::CHAR: out << static_cast<qint8>(value.toChar()); break;
+    case Value::DOUBLE: out << value.toDouble(); break;
+    case Value::INT: out << static_cast<qint32>(value.toInt()); break;
+    case Value::STRING: out << QByteArray(value.toString()); break;
+    case Value::INVALID: break;
+    }
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, Value& value)
+{
+    quint8 type;
+    in >> type;
+    switch (type) {
+    case Value::BOOL: { bool b; in >> b; value = Value(b); break; }
+    case Value::CHAR: { qint8 c; in >> c; value = Value(static_cast<char>(c)); break; }
+    case Value::DOUBLE: { double d; in >> d; value = Value(d); break; }
+    case Value::INT: { qint32 i; in >> i; value = Value(static_cast<int>(i)); break; }
+    case Value::STRING: { QByteArray s; in >> s; value = Value(s.constData()); break; }
+    case Value::INVALID: value = Value(); break;
+    default:
+        value = Value();
+        in.setStatus(QDataStream::ReadCorruptData);
+    }
+    return in;
+}
+
 std::logic_error Value::throwError() const
 {
     switch (m_type) {
@@ -0,0 +1,333 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <algorithm>
+
+#include "workerpool.h"
+#include "experiment.h"
+#include "experimentsmgr.h"
+#include "expinputs.h"
+#include "project.h"
+
+namespace evoplex {
+
+// the time (ms) a worker waits for the pool to accept its connection
+static const int kConnectTimeout = 30000;
+// the times in a row a worker is restarted if it dies before saying hello
+static const int kMaxFailedStarts = 3;
+
+WorkerPool::WorkerPool(int numWorkers, const QStringList& workerArgs,
+                       JobSource source, QObject* parent)
+    : QObject(parent),
+      m_workerArgs(workerArgs),
+      m_source(source),
+      m_hasJobs(true),
+      m_finished(false),
+      m_workers(static_cast<size_t>(std::max(1, numWorkers)))
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    for (Worker& w : m_workers) {
+        if (w.process) {
+            w.process->disconnect(this);
+            w.process->kill();
+            w.process->waitForFinished();
+        }
+    }
+    m_server.close();
+}
+
+bool WorkerPool::start(QString& error)
+{
+    const QString name = QString("evoplex-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name); // it might be left by a crashed run
+    if (!m_server.listen(name)) {
+        error = QString("unable to listen for the workers: %1").arg(m_server.errorString());
+        return false;
+    }
+    connect(&m_server, SIGNAL(newConnection()), SLOT(workerConnected()));
+
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        spawn(i);
+    }
+    return true;
+}
+
+void WorkerPool::spawn(size_t index)
+{
+    Worker& w = m_workers.at(index);
+    w.process = new QProcess(this);
+    // the workers only talk through the socket; their warnings go to stderr
+    w.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(w.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            [this, index]() { workerExited(index); });
+    connect(w.process, &QProcess::errorOccurred, [this, index](QProcess::ProcessError e) {
+        if (e == QProcess::FailedToStart) workerExited(index);
+    });
+
+    QStringList args = { "-no-gui", "-worker", m_server.serverName(),
+                         "-workerIndex", QString::number(index) };
+    w.process->start(QCoreApplication::applicationFilePath(), args + m_workerArgs);
+}
+
+void WorkerPool::workerConnected()
+{
+    while (m_server.hasPendingConnections()) {
+        QLocalSocket* socket = m_server.nextPendingConnection();
+        connect(socket, &QLocalSocket::readyRead, [this, socket]() { readMessages(socket); });
+    }
+}
+
+void WorkerPool::readMessages(QLocalSocket* socket)
+{
+    while (socket->canReadLine()) {
+        const QString line = QString::fromUtf8(socket->readLine()).trimmed();
+        const QStringList msg = line.split(" ");
+
+        if (msg.first() == "hello" && msg.size() == 3) {
+            const size_t index = msg.at(1).toUInt();
+            if (index < m_workers.size() && m_workers.at(index).process && !m_workers.at(index).socket) {
+                Worker& w = m_workers.at(index);
+                w.socket = socket;
+                w.capacity = static_cast<size_t>(std::max(1, msg.at(2).toInt()));
+                w.failedStarts = 0;
+                dispatch(index);
+            } else {
+                qWarning() << "[WorkerPool] unknown worker:" << line;
+                socket->disconnectFromServer();
+                return;
+            }
+            continue;
+        }
+
+        size_t index = 0;
+        while (index < m_workers.size() && m_workers.at(index).socket != socket) {
+            ++index;
+        }
+        if (index == m_workers.size() || msg.size() != 3) {
+            qWarning() << "[WorkerPool] unexpected message:" << line;
+            continue;
+        }
+
+        const int expId = msg.at(1).toInt();
+        if (msg.first() == "progress") {
+            emit (progressUpdated(expId, msg.at(2).toInt()));
+        } else if (msg.first() == "done") {
+            std::vector<int>& expIds = m_workers.at(index).expIds;
+            auto it = std::find(expIds.begin(), expIds.end(), expId);
+            if (it == expIds.end()) {
+                qWarning() << "[WorkerPool] unknown experiment:" << line;
+                continue;
+            }
+            expIds.erase(it);
+            emit (jobDone(expId, msg.at(2) == "1"));
+            dispatch(index);
+        }
+    }
+}
+
+void WorkerPool::dispatch(size_t index)
+{
+    Worker& w = m_workers.at(index);
+    Job job;
+    while (m_hasJobs && w.expIds.size() < w.capacity) {
+        if (!m_source(job)) {
+            m_hasJobs = false;
+            break;
+        }
+        w.expIds.emplace_back(job.expId);
+        w.socket->write(QString("header %1\n").arg(job.header.join(",")).toUtf8());
+        w.socket->write(QString("run %1 %2\n").arg(job.expId).arg(job.values.join(",")).toUtf8());
+    }
+    // the worker quits once its last experiment is done
+    if (!m_hasJobs && w.expIds.empty()) {
+        w.socket->write("quit\n");
+    }
+    w.socket->flush();
+}
+
+void WorkerPool::workerExited(size_t index)
+{
+    Worker& w = m_workers.at(index);
+    if (!w.process) {
+        return; // both signals were emitted
+    }
+
+    const std::vector<int> expIds = std::move(w.expIds);
+    const bool saidHello = w.socket != nullptr;
+    w.expIds.clear();
+    w.process->deleteLater();
+    w.process = nullptr;
+    if (w.socket) {
+        w.socket->deleteLater();
+        w.socket = nullptr;
+    }
+
+    // an experiment has taken the worker down; the others go on
+    for (int expId : expIds) {
+        qWarning() << QString("[WorkerPool] the worker %1 died while running the experiment %2")
+                      .arg(index).arg(expId);
+        emit (jobDone(expId, false));
+    }
+
+    if (m_hasJobs) {
+        if (saidHello) {
+            if (!expIds.empty()) {
+                spawn(index);
+                return;
+            }
+        } else if (++w.failedStarts <= kMaxFailedStarts) {
+            qWarning() << QString("[WorkerPool] the worker %1 died before connecting; restarting it")
+                          .arg(index);
+            spawn(index);
+            return;
+        }
+    }
+    checkFinished();
+}
+
+void WorkerPool::checkFinished()
+{
+    for (const Worker& w : m_workers) {
+        if (w.process) {
+            return;
+        }
+    }
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    // the workers could not even start; nobody will run the remaining jobs
+    Job job;
+    while (m_hasJobs && m_source(job)) {
+        qWarning() << "[WorkerPool] no workers left to run the experiment" << job.expId;
+        emit (jobDone(job.expId, false));
+    }
+    m_hasJobs = false;
+    emit (finished());
+}
+
+/**********************************/
+
+WorkerClient::WorkerClient(MainApp* mainApp, ProjectPtr project)
+    : QObject(),
+      m_mainApp(mainApp),
+      m_project(project)
+{
+}
+
+bool WorkerClient::connectTo(const QString& serverName, int index, QString& error)
+{
+    m_socket.connectToServer(serverName);
+    if (!m_socket.waitForConnected(kConnectTimeout)) {
+        error = QString("unable to connect to '%1': %2").arg(serverName, m_socket.errorString());
+        return false;
+    }
+
+    connect(&m_socket, SIGNAL(readyRead()), SLOT(readMessages()));
+    // the pool is gone; there's no one to report to
+    connect(&m_socket, &QLocalSocket::disconnected, []() { QCoreApplication::exit(1); });
+    connect(m_mainApp->expMgr(), SIGNAL(progressUpdated()),
+            SLOT(sendProgress()), Qt::QueuedConnection);
+
+    send(QString("hello %1 %2").arg(index).arg(m_mainApp->expMgr()->maxThreadsCount()));
+    return true;
+}
+
+void WorkerClient::readMessages()
+{
+    while (m_socket.canReadLine()) {
+        const QString line = QString::fromUtf8(m_socket.readLine()).trimmed();
+        const QString cmd = line.section(' ', 0, 0);
+        const QString arg = line.section(' ', 1);
+        if (cmd == "header") {
+            m_header = arg.split(",");
+        } else if (cmd == "run") {
+            run(arg.section(' ', 0, 0).toInt(), arg.section(' ', 1).split(","));
+        } else if (cmd == "quit") {
+            QCoreApplication::exit(0);
+        } else {
+            qWarning() << "[WorkerClient] unexpected message:" << line;
+        }
+    }
+}
+
+void WorkerClient::run(int expId, const QStringList& values)
+{
+    QString error;
+    ExperimentPtr exp;
+    auto inputs = ExpInputs::parse(m_mainApp, m_header, values, error);
+    if (inputs) {
+        exp = m_project->newExperiment(std::move(inputs), error);
+    }
+    if (!exp || exp->expStatus() == Status::Invalid) {
+        qWarning() << QString("[WorkerClient] unable to create the experiment %1:").arg(expId) << error;
+        if (exp) {
+            m_project->removeExperiment(exp->id(), error);
+        }
+        send(QString("done %1 0").arg(expId));
+        return;
+    }
+
+    // the status changes in the workers; let's handle it in this thread
+    connect(exp.get(), SIGNAL(statusChanged(Status)), SLOT(checkStatus()), Qt::QueuedConnection);
+    m_exps.emplace_back(exp);
+    m_sentProgress[exp->id()] = -1;
+    exp->play();
+}
+
+void WorkerClient::sendProgress()
+{
+    for (const ExperimentPtr& exp : m_exps) {
+        const int percentage = exp->progress() * 100 / 360;
+        int& sent = m_sentProgress[exp->id()];
+        if (percentage != sent) {
+            sent = percentage;
+            send(QString("progress %1 %2").arg(exp->id()).arg(percentage));
+        }
+    }
+}
+
+void WorkerClient::checkStatus()
+{
+    for (auto it = m_exps.begin(); it != m_exps.end();) {
+        const ExperimentPtr exp = *it;
+        if (!exp->hasEnded()) {
+            ++it;
+            continue;
+        }
+        it = m_exps.erase(it);
+        m_sentProgress.erase(exp->id());
+        disconnect(exp.get(), nullptr, this, nullptr);
+        send(QString("done %1 %2").arg(exp->id()).arg(exp->expStatus() == Status::Invalid ? 0 : 1));
+        // its outputs are in the files; let's release the memory
+        QString error;
+        m_project->removeExperiment(exp->id(), error);
+    }
+}
+
+void WorkerClient::send(const QString& msg)
+{
+    m_socket.write((msg + "\n").toUtf8());
+    m_socket.flush();
+}
+
+} // evoplex
@@ -0,0 +1,150 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+#include "mainapp.h"
+
+namespace evoplex {
+
+class Experiment;
+using ExperimentPtr = std::shared_ptr<Experiment>;
+
+/**
+ * @brief Runs the experiments in worker processes on this host.
+ *
+ * Each worker is this application started with '-no-gui -worker <server>'.
+ * It connects to the pool through a QLocalSocket and runs as many
+ * experiments (rows of a project) at a time as it has threads. If a worker
+ * dies, e.g., because of a crashing plugin, its experiments fail and another
+ * worker takes its place. A worker which dies before saying hello is also
+ * restarted, but only a few times in a row.
+ * The experiments write their outputs to their own files, so the outputs
+ * of all workers end up in the output directories of the project.
+ *
+ * The messages are lines of text:
+ *     worker -> pool: 'hello <workerIndex> <threads>',
+ *                     'progress <expId> <percentage>'
+ *                     and 'done <expId> <1 if finished, 0 if failed>'
+ *     pool -> worker: 'header <csv header>', 'run <expId> <csv row>' and 'quit'
+ */
+class WorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    // a row of a project to be run by a worker
+    struct Job
+    {
+        int expId;
+        QStringList header;
+        QStringList values;
+    };
+    // gives the next job; returns false if there are none left
+    using JobSource = std::function<bool(Job&)>;
+
+    // 'workerArgs' are passed on to each worker, e.g., '-threads 2'
+    explicit WorkerPool(int numWorkers, const QStringList& workerArgs,
+                        JobSource source, QObject* parent = nullptr);
+    ~WorkerPool();
+
+    // listens for the workers and spawns them
+    bool start(QString& error);
+
+signals:
+    void progressUpdated(int expId, int percentage);
+    void jobDone(int expId, bool ok);
+    // all jobs are done and the workers have exited
+    void finished();
+
+private slots:
+    void workerConnected();
+
+private:
+    struct Worker
+    {
+        QProcess* process = nullptr;
+        QLocalSocket* socket = nullptr;
+        std::vector<int> expIds; // the jobs being run
+        size_t capacity = 1;     // the jobs it may run at once, i.e., its threads
+        int failedStarts = 0;    // the times it has died before saying hello
+    };
+
+    const QStringList m_workerArgs;
+    JobSource m_source;
+    bool m_hasJobs;
+    bool m_finished;
+    QLocalServer m_server;
+    std::vector<Worker> m_workers;
+
+    void spawn(size_t index);
+    void readMessages(QLocalSocket* socket);
+    // sends jobs to the worker until it is busy, or tells it to quit
+    void dispatch(size_t index);
+    void workerExited(size_t index);
+    // emits finished() once all workers have exited
+    void checkFinished();
+};
+
+/**
+ * @brief The worker side of a WorkerPool.
+ *
+ * It runs the rows sent by the pool in its own (empty) project and
+ * reports their progress. The application exits once the pool says so
+ * or if the connection is lost.
+ */
+class WorkerClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorkerClient(MainApp* mainApp, ProjectPtr project);
+
+    // connects to the pool; returns false if it is not listening
+    bool connectTo(const QString& serverName, int index, QString& error);
+
+private slots:
+    void readMessages();
+    void sendProgress();
+    // reports and removes the experiments which are done
+    void checkStatus();
+
+private:
+    MainApp* m_mainApp;
+    ProjectPtr m_project;
+    QLocalSocket m_socket;
+    QStringList m_header;
+    std::vector<ExperimentPtr> m_exps;
+    std::map<int, int> m_sentProgress; // <expId, percentage>
+
+    void run(int expId, const QStringList& values);
+    void send(const QString& msg);
+};
+
+} // evoplex
+#endif // WORKER_POOL_H
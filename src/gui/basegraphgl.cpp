@@ -44,6 +44,7 @@ BaseGraphGL::BaseGraphGL(ExperimentPtr exp, GraphWidget* parent)
       m_nodeRadius(m_nodeScale),
       m_origin(m_nodeScale, m_nodeScale),
       m_cacheStatus(CacheStatus::Ready),
+      m_cacheRevision(0),
       m_posEntered(0,0),
       m_currTrialId(0)
 {
@@ -218,6 +219,7 @@ void BaseGraphGL::updateCache(bool force)
 
     m_mutex.lock();
     m_cacheStatus = CacheStatus::Updating;
+    m_cacheRevision = m_trial && m_trial->graph() ? m_trial->graph()->revision() : 0;
     QFuture<CacheStatus> future = QtConcurrent::run(this, &BaseGraphGL::refreshCache);
     QFutureWatcher<CacheStatus>* watcher = new QFutureWatcher<CacheStatus>;
     connect(watcher, &QFutureWatcher<int>::finished, [this, watcher]() {
@@ -361,7 +363,7 @@ void BaseGraphGL::mouseReleaseEvent(QMouseEvent *e)
                m_trial->status() != Status::Running) {
         Node node = selectNode(e->localPos(), false);
         if (!node.isNull()) {
-            const QString& attrName = node.attrs().name(m_nodeAttr);
+            const QString attrName = node.attrs().name(m_nodeAttr);
             auto attrRange = m_exp->modelPlugin()->nodeAttrRange(attrName);
             node.setAttr(m_nodeAttr, attrRange->next(node.attr(m_nodeAttr)));
             clearSelection();
@@ -408,7 +410,7 @@ void BaseGraphGL::keyReleaseEvent(QKeyEvent* e)
         if (e->key() == Qt::Key_Space) {
             Node node = selectedNode();
             if (!node.isNull()) {
-                const QString& attrName = node.attrs().name(m_nodeAttr);
+                const QString attrName = node.attrs().name(m_nodeAttr);
                 auto attrRange = m_exp->modelPlugin()->nodeAttrRange(attrName);
                 node.setAttr(m_nodeAttr, attrRange->next(node.attr(m_nodeAttr)));
                 updateInspector(node);
@@ -458,7 +460,16 @@ void BaseGraphGL::updateView(bool forceUpdate)
     }
     m_currStep = m_trial->step();
     m_ui->currStep->setText(QString::number(m_currStep));
-    update();
+    if (isCacheCurrent()) {
+        update();
+    } else {
+        updateCache(); // nodes or edges were added or removed
+    }
+}
+
+bool BaseGraphGL::isCacheCurrent() const
+{
+    return !m_trial || !m_trial->graph() || m_trial->graph()->revision() == m_cacheRevision;
 }
 
 void BaseGraphGL::clearSelection()
@@ -91,6 +91,10 @@ protected:
     QPointF m_origin;
 
     CacheStatus m_cacheStatus;
+    size_t m_cacheRevision; // graph revision the cache was built from
+
+    // true if the Edge objects in the cache are still valid
+    bool isCacheCurrent() const;
 
     CacheStatus refreshCache() override { return CacheStatus::Ready; }
 
@@ -121,8 +121,12 @@ ExperimentDesigner::ExperimentDesigner(MainApp* mainApp, QWidget *parent)
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_SEED)->setValue(100);
     // --  stop at
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_STOPAT)->setValue(1000);
+    // --  stop when (eg, unchanged_100)
+    addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_STOPWHEN);
     // --  trials
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_TRIALS);
+    // --  fork at
+    addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_FORKAT)->setValue(0);
     // --  auto delete
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_AUTODELETE);
 
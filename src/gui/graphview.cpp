@@ -225,7 +225,7 @@ void GraphView::drawEdges(QPainter& painter) const
         return;
     }
     painter.save();
-    if (m_edgeAttr >= 0 && m_edgeCMap) {
+    if (m_edgeAttr >= 0 && m_edgeCMap && isCacheCurrent()) {
         QPen pen = m_edgePen;
         for (const Star& star : m_cache) {
             for (auto const& ep : star.edges) {
@@ -66,6 +66,7 @@ private:
     QPen m_nodePen;
     void updateNodePen();
 
+    // the Edge objects are only valid while isCacheCurrent()
     struct Star {
         Node node;
         QPointF xy;
@@ -70,6 +70,11 @@ SettingsPage::SettingsPage(MainGUI* mainGUI)
     connect(m_ui->stepsToFlush, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
         [mainGUI](int v) { mainGUI->mainApp()->setStepsToFlush(v); });
 
+    m_ui->stepsToCheckpoint->setMinimum(0);
+    m_ui->stepsToCheckpoint->setMaximum(EVOPLEX_MAX_STEPS);
+    connect(m_ui->stepsToCheckpoint, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+        [mainGUI](int v) { mainGUI->mainApp()->setStepsToCheckpoint(v); });
+
     connect(m_ui->checkUpdates, &QCheckBox::toggled, [mainGUI](bool b) {
         mainGUI->mainApp()->setCheckUpdatesAtStart(b);
     });
@@ -96,6 +101,7 @@ void SettingsPage::refreshFields()
     m_ui->delay->setValue(m_mainGUI->mainApp()->defaultStepDelay());
 
     m_ui->stepsToFlush->setValue(m_mainGUI->mainApp()->stepsToFlush());
+    m_ui->stepsToCheckpoint->setValue(m_mainGUI->mainApp()->stepsToCheckpoint());
 
     m_ui->checkUpdates->setChecked(m_mainGUI->mainApp()->checkUpdatesAtStart());
 
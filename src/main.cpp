@@ -28,8 +28,10 @@
 #include <QStringBuilder>
 #include <QSplashScreen>
 #include <QStyleFactory>
+#include <QTimer>
 
 #include "config.h"
+#include "core/batchrunner.h"
 #include "core/logger.h"
 #include "core/mainapp.h"
 #include "gui/maingui.h"
@@ -137,7 +139,15 @@ int main(int argc, char* argv[])
         result = app->exec();
     } else {
         // start console application
-        // TODO: handle args
+        evoplex::BatchRunner runner(&mainApp);
+        QString error;
+        if (runner.init(coreApp->arguments(), error)) {
+            QTimer::singleShot(0, &runner, SLOT(start()));
+            result = coreApp->exec();
+        } else {
+            fprintf(stderr, "%s\n", qPrintable(error));
+            result = evoplex::BatchRunner::InvalidArgs;
+        }
     }
 
     evoplex::Logger::instance()->destroy();
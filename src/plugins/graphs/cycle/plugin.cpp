@@ -39,20 +39,20 @@ bool CycleGraph::reset()
     // at this point, it is safe to iterate by node ids,
     // which will always start from 0 and end at size-1
     if (m_edgeAttrsGen) {
+        reserveEdges(numNodes());
         auto soa = m_edgeAttrsGen->create(numNodes());
         for (int nodeId = 0; nodeId < lastId; ++nodeId) {
             fixCoords(node(nodeId), radius, dTheta);
-            addEdge(nodeId, nodeId+1, new Attributes(soa.at(nodeId)));
+            addEdge(nodeId, nodeId+1, soa.at(nodeId));
         }
         fixCoords(node(lastId), radius, dTheta);
-        addEdge(lastId, 0, new Attributes(soa.at(lastId)));
+        addEdge(lastId, 0, soa.at(lastId));
     } else {
-        for (int nodeId = 0; nodeId < lastId; ++nodeId) {
+        // without edges' attributes, the neighbours can be computed on the fly
+        for (int nodeId = 0; nodeId <= lastId; ++nodeId) {
             fixCoords(node(nodeId), radius, dTheta);
-            addEdge(nodeId, nodeId+1, new Attributes());
         }
-        fixCoords(node(lastId), radius, dTheta);
-        addEdge(lastId, 0, new Attributes());
+        return setLattice(Lattice(numNodes(), 1, {{0, 1}}, true, isDirected()));
     }
 
     return true;
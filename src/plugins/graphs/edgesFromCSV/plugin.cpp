@@ -19,6 +19,7 @@
  */
 
 #include <QFile>
+#include <algorithm>
 
 #include "plugin.h"
 
@@ -52,19 +53,37 @@ bool EdgesFromCSV::reset()
         return false;
     }
 
-    // create edges
-    int row = 0;
+    // all edges share the same attributes' names
+    m_edgeSchema = nullptr;
+    if (m_edgeAttrsGen) {
+        m_edgeSchema = AttributesSchema::fromScope(m_edgeAttrsGen->attrsScope());
+    }
+
+    QStringList lines;
     while (!in.atEnd()) {
-        QStringList values = in.readLine().split(",");
-        if (!readRow(++row, header, values)) {
-            file.close();
-            removeAllEdges();
-            return false;
-        }
+        lines.append(in.readLine());
     }
     file.close();
 
-    return true;
+    // create edges; each chunk of rows is parsed by a different thread
+    EdgeBuilder builder(this);
+    builder.reserve(lines.size());
+    std::vector<char> valid(static_cast<size_t>(builder.numBuffers()), true);
+    builder.run([this, &lines, &header, &valid](int chunk, int numChunks, EdgeBuffer& buffer) {
+        const int first = static_cast<int>(qint64(chunk) * lines.size() / numChunks);
+        const int last = static_cast<int>(qint64(chunk + 1) * lines.size() / numChunks);
+        for (int i = first; i < last; ++i) {
+            if (!readRow(i + 1, header, lines.at(i).split(","), buffer)) {
+                valid[static_cast<size_t>(chunk)] = false;
+                return;
+            }
+        }
+    });
+
+    if (std::find(valid.begin(), valid.end(), false) != valid.end()) {
+        return false; // no edge has been added
+    }
+    return builder.commit();
 }
 
 bool EdgesFromCSV::validateHeader(const QStringList& header) const
@@ -107,7 +126,8 @@ bool EdgesFromCSV::validateHeader(const QStringList& header) const
     return true;
 }
 
-bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList& values)
+bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList& values,
+                           EdgeBuffer& buffer) const
 {
     if (values.size() != header.size()) {
         qWarning() << "rows must have the same number of columns!"
@@ -124,10 +144,9 @@ bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList
         return false;
     }
 
-    Attributes* attrs = new Attributes();
-    if (m_edgeAttrsGen) {
+    Attributes attrs(m_edgeSchema); // empty if there is no schema
+    if (m_edgeSchema) {
         auto const& ascope = m_edgeAttrsGen->attrsScope();
-        attrs->resize(ascope.size());
         for (int col = 2; col < values.size(); ++col) {
             auto const& attrRange = ascope.value(header.at(col), nullptr);
             if (!attrRange) { // is null if the column is not required
@@ -136,21 +155,21 @@ bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList
 
             Value value = attrRange->validate(values.at(col));
             if (value.isValid()) {
-                attrs->replace(attrRange->id(), header.at(col), value);
+                attrs.setValue(attrRange->id(), value);
             } else {
                 qWarning() << QString("invalid value at column %1 ('%2') row %3!\n"
                                       "Expected: %4; Actual: %5")
                               .arg(col).arg(header.at(col)).arg(row)
                               .arg(attrRange ? attrRange->attrRangeStr() : "a number")
                               .arg(values.at(col));
-                delete attrs;
                 return false;
             }
         }
     }
 
     try {
-        addEdge(originId, targetId, attrs);
+        node(originId);
+        node(targetId);
     } catch (std::out_of_range) {
         qWarning() << QString("'origin'(%1) or 'target'(%2) are not"
                       " in the set of nodes. Check the row %3 (%4)")
@@ -158,6 +177,7 @@ bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList
         return false;
     }
 
+    buffer.add(originId, targetId, std::move(attrs));
     return true;
 }
 
@@ -37,9 +37,12 @@ private:
     // graph parameters
     enum GraphAttr { FilePath };
     QString m_filePath;
+    AttributesSchemaPtr m_edgeSchema;
 
     bool validateHeader(const QStringList &header) const;
-    bool readRow(int row, const QStringList& header, const QStringList& values);
+    // parses the row into the buffer; it is called by several threads
+    bool readRow(int row, const QStringList& header, const QStringList& values,
+                 EdgeBuffer& buffer) const;
 };
 }
 
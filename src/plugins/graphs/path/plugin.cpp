@@ -54,20 +54,24 @@ bool PathGraph::reset()
     // at this point, it is safe to iterate by node ids,
     // which will always start from 0 and end at size-1
     if (m_edgeAttrsGen) {
+        reserveEdges(numEdges);
         auto soa = m_edgeAttrsGen->create(numEdges);
         for (int nodeId = 0; nodeId < numEdges; ++nodeId) {
             fixCoords(node(nodeId));
-            addEdge(nodeId, nodeId+1, new Attributes(soa.at(nodeId)));
+            addEdge(nodeId, nodeId+1, soa.at(nodeId));
         }
     } else {
         for (int nodeId = 0; nodeId < numEdges; ++nodeId) {
             fixCoords(node(nodeId));
-            addEdge(nodeId, nodeId+1, new Attributes());
         }
     }
     // last node
     fixCoords(node(numNodes() - 1));
 
+    // without edges' attributes, the neighbours can be computed on the fly
+    if (!m_edgeAttrsGen) {
+        return setLattice(Lattice(numNodes(), 1, {{0, 1}}, false, isDirected()));
+    }
     return true;
 }
 
@@ -20,6 +20,7 @@
 
 #include <QtDebug>
 #include <QtMath>
+#include <numeric>
 
 #include "plugin.h"
 
@@ -51,136 +52,73 @@ bool SquareGrid::reset()
 {
     removeAllEdges();
 
-    int numEdges = numNodes() * m_numNeighbours;
-    edgesFunc func;
-    if (isDirected()) {
-        func = m_numNeighbours == 4 ? directed4Edges : directed8Edges;
-    } else {
-        func = m_numNeighbours == 4 ? undirected4Edges : undirected8Edges;
-        numEdges /= 2;
+    for (Node node : m_nodes) {
+        int x, y;
+        ind2sub(node.id(), m_width, y, x);
+        node.setCoords(x, y);
     }
 
-    int edgeId = 0;
-    SetOfAttributes soa;
-    if (m_edgeAttrsGen) {
-        soa = m_edgeAttrsGen->create(numEdges);
-    }
+    const Lattice lattice(m_width, m_height, offsets(), m_periodic, isDirected());
 
-    if (m_periodic) {
-        for (Node node : m_nodes) {
-            int x, y;
-            ind2sub(node.id(), m_width, y, x);
-            node.setCoords(x, y);
-            createPeriodicEdges(node.id(), func, soa, edgeId);
-        }
-    } else {
-        for (Node node : m_nodes) {
-            int x, y;
-            ind2sub(node.id(), m_width, y, x);
-            node.setCoords(x, y);
-            createFixedEdges(node.id(), func, soa, edgeId);
-        }
+    // without edges' attributes, the neighbours can be computed on the fly
+    if (!m_edgeAttrsGen) {
+        return setLattice(lattice);
     }
 
-    return true;
+    SetOfAttributes soa = m_edgeAttrsGen->create(lattice.numEdges());
+
+    // each chunk of rows is filled by a different thread; the attributes
+    // follow the lattice order, so they do not depend on the number of chunks
+    EdgeBuilder builder(this);
+    std::vector<int> firstEdge(static_cast<size_t>(builder.numBuffers()) + 1, 0);
+    builder.run([this, &lattice, &firstEdge](int chunk, int numChunks, EdgeBuffer&) {
+        int count = 0;
+        lattice.forEachEdge([&count](int, int) { ++count; },
+                            chunk * m_height / numChunks, (chunk + 1) * m_height / numChunks);
+        firstEdge[static_cast<size_t>(chunk) + 1] = count;
+    });
+    std::partial_sum(firstEdge.begin(), firstEdge.end(), firstEdge.begin());
+
+    builder.run([this, &lattice, &firstEdge, &soa](int chunk, int numChunks, EdgeBuffer& buffer) {
+        int edgeId = firstEdge[static_cast<size_t>(chunk)];
+        buffer.reserve(static_cast<size_t>(firstEdge[static_cast<size_t>(chunk) + 1] - edgeId));
+        lattice.forEachEdge([&buffer, &soa, &edgeId](int originId, int neighbourId) {
+            buffer.add(originId, neighbourId, std::move(soa[static_cast<size_t>(edgeId)]));
+            ++edgeId;
+        }, chunk * m_height / numChunks, (chunk + 1) * m_height / numChunks);
+    });
+
+    return builder.commit();
 }
 
-void SquareGrid::createPeriodicEdges(const int id, const edgesFunc& func,
-                                     const SetOfAttributes& soa, int& edgeId)
+std::vector<Lattice::Offset> SquareGrid::offsets() const
 {
-    edges2d neighbors = func(id, m_width);
-    for (std::pair<int,int> neighbor : neighbors) {
-        if (neighbor.first < 0) {
-            neighbor.first = m_height - 1;
-        } else if (neighbor.first >= m_height) {
-            neighbor.first = 0;
-        }
-
-        if (neighbor.second < 0) {
-            neighbor.second = m_width - 1;
-        } else if (neighbor.second >= m_width) {
-            neighbor.second = 0;
+    // undirected edges are created only once, from the south-east node
+    if (m_numNeighbours == 4) {
+        if (isUndirected()) {
+            return { {-1,  0},  // n
+                     { 0, -1} };// w
         }
-
-        int nId = linearIdx(neighbor, m_width);
-        Q_ASSERT_X(nId < numNodes(), "SquareGrid::createEdges", "neighbor must exist");
-
-        auto attrs = soa.empty() ? new Attributes() : new Attributes(soa.at(edgeId));
-        addEdge(id, nId, attrs);
-        ++edgeId;
+        return { {-1,  0},  // n
+                 { 0, -1},  // w
+                 { 0,  1},  // e
+                 { 1,  0} };// s
     }
-}
-
-void SquareGrid::createFixedEdges(const int id, const edgesFunc& func,
-                                  const SetOfAttributes& soa, int& edgeId)
-{
-    edges2d neighbors = func(id, m_width);
-    for (std::pair<int,int> neighbor : neighbors) {
-        if (neighbor.first < 0 || neighbor.first >= m_height ||
-            neighbor.second < 0 || neighbor.second >= m_width) {
-            continue;
-        }
-        int nId = linearIdx(neighbor, m_width);
-        Q_ASSERT_X(nId < numNodes(), "SquareGrid::createEdges", "neighbor must exist");
 
-        auto attrs = soa.empty() ? new Attributes() : new Attributes(soa.at(edgeId));
-        addEdge(id, nId, attrs);
-        ++edgeId;
+    if (isUndirected()) {
+        return { {-1, -1},  // nw
+                 {-1,  0},  // n
+                 {-1,  1},  // ne
+                 { 0, -1} };// w
     }
-}
-
-SquareGrid::edges2d SquareGrid::directed4Edges(const int id, const int width)
-{
-    int row, col;
-    ind2sub(id, width, row, col);
-    edges2d neighbors {
-        std::make_pair(row-1, col  ), // n
-        std::make_pair(row  , col-1), // w
-        std::make_pair(row  , col+1), // e
-        std::make_pair(row+1, col  ), // s
-    };
-    return neighbors;
-}
-
-SquareGrid::edges2d SquareGrid::undirected4Edges(const int id, const int width)
-{
-    int row, col;
-    ind2sub(id, width, row, col);
-    edges2d neighbors {
-        std::make_pair(row-1, col  ), // n
-        std::make_pair(row  , col-1), // w
-    };
-    return neighbors;
-}
-
-SquareGrid::edges2d SquareGrid::directed8Edges(const int id, const int width)
-{
-    int row, col;
-    ind2sub(id, width, row, col);
-    edges2d neighbors {
-        std::make_pair(row-1, col-1), // nw
-        std::make_pair(row-1, col  ), // n
-        std::make_pair(row-1, col+1), // ne
-        std::make_pair(row  , col-1), // w
-        std::make_pair(row  , col+1), // e
-        std::make_pair(row+1, col-1), // sw
-        std::make_pair(row+1, col  ), // s
-        std::make_pair(row+1, col+1), // se
-    };
-    return neighbors;
-}
-
-SquareGrid::edges2d SquareGrid::undirected8Edges(const int id, const int width)
-{
-    int row, col;
-    ind2sub(id, width, row, col);
-    edges2d neighbors {
-        std::make_pair(row-1, col-1), // nw
-        std::make_pair(row-1, col  ), // n
-        std::make_pair(row-1, col+1), // ne
-        std::make_pair(row  , col-1), // w
-    };
-    return neighbors;
+    return { {-1, -1},  // nw
+             {-1,  0},  // n
+             {-1,  1},  // ne
+             { 0, -1},  // w
+             { 0,  1},  // e
+             { 1, -1},  // sw
+             { 1,  0},  // s
+             { 1,  1} };// se
 }
 
 } // evoplex
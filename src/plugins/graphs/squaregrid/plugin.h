@@ -21,7 +21,6 @@
 #ifndef SQUARE_GRID_H
 #define SQUARE_GRID_H
 
-#include <functional>
 #include <vector>
 
 #include <plugininterface.h>
@@ -39,40 +38,15 @@ private:
     int m_height;
     int m_width;
 
-    typedef std::pair<int,int> rowCol;
-    typedef std::vector<rowCol> edges2d;
-    typedef std::function<edges2d(const int, const int)> edgesFunc;
-
-    // create edges with fixed boundary conditions
-    void createFixedEdges(const int id, const edgesFunc& func,
-                          const SetOfAttributes& soa, int& edgeId);
-
-    // create edges with periodic boundary conditions (i.e., a toroid)
-    void createPeriodicEdges(const int id, const edgesFunc& func,
-                             const SetOfAttributes& soa, int& edgeId);
-
-    static edges2d directed4Edges(const int id, const int width);
-    static edges2d directed8Edges(const int id, const int width);
-
-    static edges2d undirected4Edges(const int id, const int width);
-    static edges2d undirected8Edges(const int id, const int width);
+    // the displacements from a node to its neighbours
+    std::vector<Lattice::Offset> offsets() const;
 
     // convert a linear index to row and column
     static inline void ind2sub(const int ind, const int cols, int &row, int &col);
-
-    // return the linear index of an element in a matrix.
-    static inline int linearIdx(const int row, const int col, const int cols);
-    static inline int linearIdx(std::pair<int,int> rowCol, const int cols);
 };
 
 inline void SquareGrid::ind2sub(const int ind, const int cols, int &row, int &col)
 { row = ind / cols; col = ind % cols; }
 
-inline int SquareGrid::linearIdx(const int row, const int col, const int cols)
-{ return row * cols + col; }
-
-inline int SquareGrid::linearIdx(std::pair<int,int> rowCol, const int cols)
-{ return linearIdx(rowCol.first, rowCol.second, cols); }
-
 } // evoplex
 #endif // SQUARE_GRID_H
@@ -33,6 +33,7 @@ bool StarGraph::reset()
     removeAllEdges();
 
     const int nNodes = numNodes();
+    reserveEdges(nNodes - 1);
     double radius = (nNodes - 1) / (2. * M_PI);
     double dTheta = 1. / radius;
     if (radius < 2.0) {
@@ -47,12 +48,12 @@ bool StarGraph::reset()
         auto soa = m_edgeAttrsGen->create(nNodes - 1);
         for (int nodeId = 1; nodeId < nNodes; ++nodeId) {
             fixCoords(node(nodeId), radius, dTheta);
-            addEdge(0, nodeId, new Attributes(soa.at(nodeId)));
+            addEdge(0, nodeId, soa.at(nodeId));
         }
     } else {
         for (int nodeId = 1; nodeId < nNodes; ++nodeId) {
             fixCoords(node(nodeId), radius, dTheta);
-            addEdge(0, nodeId, new Attributes());
+            addEdge(0, nodeId);
         }
     }
 
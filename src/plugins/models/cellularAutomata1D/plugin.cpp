@@ -33,37 +33,38 @@ bool CellularAutomata1D::init()
         return false;
     }
 
-    // gets the id of the `state` node's attribute, which is the same for all nodes
-    m_stateAttrId = node(0).attrs().indexOf("state");
+    // resolves the `state` node's attribute, which is the same for all nodes
+    m_state = nodeAttrHandle<bool>("state");
 
     // determines which rule to use
     m_rule = attr("rule").toInt();
 
-    return m_stateAttrId >= 0;
+    return m_state.isValid();
 }
 
 bool CellularAutomata1D::algorithmStep()
 {
+    // the ids of the nodes in a `squareGrid` are their linear indices
     // 1. gets first node in the current row
-    Node first = node(linearIdx(m_currRow, 0));
+    const int first = linearIdx(m_currRow, 0);
 
     // 2. for each node (starting from the second),
     int lastColumn = m_width - 1;
     for (int col = 1; col < lastColumn; ++col) {
-        Node central = node(first.id() + col);
+        const int central = first + col;
         // a. compute the next state based on its neighbours on the left and right
-        Value state = nextState(node(central.id()-1), central, node(central.id()+1));
+        bool state = nextState(central-1, central, central+1);
         // b. assign the next state to the node below the current node
-        node(central.id()+m_width).setAttr(m_stateAttrId, state);
+        m_state.set(central+m_width, state);
     }
 
     // 3. edge case: if the graph is a toroid, we compute the state for the last column
     if (m_toroidal) {
-        Node last = node(linearIdx(m_currRow, lastColumn));
+        const int last = linearIdx(m_currRow, lastColumn);
         // a. compute the next state based on its left neighbour and the first node in the row
-        Value state = nextState(node(last.id()-1), last, first);
+        bool state = nextState(last-1, last, first);
         // b. assign the next state to the first node of the next row
-        node(first.id()+m_width).setAttr(m_stateAttrId, state);
+        m_state.set(first+m_width, state);
     }
 
     ++m_currRow;
@@ -74,11 +75,11 @@ bool CellularAutomata1D::algorithmStep()
     return true;
 }
 
-Value CellularAutomata1D::nextState(const Node& leftNode, const Node& node, const Node& rightNode) const
+bool CellularAutomata1D::nextState(int leftId, int nodeId, int rightId) const
 {
-    bool left = leftNode.attr(m_stateAttrId).toBool();
-    bool center = node.attr(m_stateAttrId).toBool();
-    bool right = rightNode.attr(m_stateAttrId).toBool();
+    bool left = m_state.get(leftId);
+    bool center = m_state.get(nodeId);
+    bool right = m_state.get(rightId);
 
     bool r = false;
     if (m_rule == 30) {
@@ -92,7 +93,7 @@ Value CellularAutomata1D::nextState(const Node& leftNode, const Node& node, cons
     } else {
         qFatal("invalid rule");
     }
-    return Value(r);
+    return r;
 }
 
 int CellularAutomata1D::linearIdx(int row, int col) const
@@ -21,7 +21,7 @@ public:
 private:
     int m_currRow;
 
-    int m_stateAttrId;  // the id of the `state` node attribute
+    AttrHandle<bool> m_state; // the `state` node attribute
     int m_rule;         // model attribute: cellular automaton rule
 
     bool m_toroidal;    // true if the graph is a toroid
@@ -30,7 +30,7 @@ private:
 
     // returns the next state of a node based on the state
     // of itself and its neighbours on the left and right
-    Value nextState(const Node& leftNode, const Node& node, const Node& rightNode) const;
+    bool nextState(int leftId, int nodeId, int rightId) const;
 
     // return the linear index of an element in a matrix.
     int linearIdx(int row, int col) const;
@@ -6,51 +6,50 @@
  * the LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include "plugin.h"
 
 namespace evoplex {
 
 bool GameOfLife::init()
 {
-    // gets the id of the `live` node's attribute, which is the same for all nodes
-    m_liveAttrId = node(0).attrs().indexOf("live");
-    return m_liveAttrId >= 0;
+    // resolves the `live` node's attribute, which is the same for all nodes
+    // it is double-buffered, so the next states are written aside
+    m_live = nodeAttrBuffer<bool>("live");
+    if (!m_live.isValid()) {
+        return false;
+    }
+    // the partitions cover the ids 0..n-1, so they must all be valid
+    const int numNodes = static_cast<int>(nodes().size());
+    return std::all_of(nodes().begin(), nodes().end(),
+                       [numNodes](const std::pair<const int, Node>& np) { return np.first < numNodes; });
 }
 
 bool GameOfLife::algorithmStep()
 {
-    std::vector<Value> nextStates;
-    nextStates.reserve(nodes().size());
-
-    for (Node node : nodes()) {
-        int liveNeighbourCount = 0;
-        for (Node neighbour : node.outEdges()){
-            if (neighbour.attr(m_liveAttrId).toBool()) {
-                ++liveNeighbourCount;
+    // the nodes of a grid are 0..n-1; each partition handles a range of them
+    parallelFor([this](const Partition& p) {
+        for (int id = p.firstId(); id < p.endId(); ++id) {
+            int liveNeighbourCount = 0;
+            for (int nbId : graph()->outNeighbours(id)) {
+                if (m_live.get(nbId)) {
+                    ++liveNeighbourCount;
+                }
             }
-        }
 
-        if (node.attr(m_liveAttrId).toBool()) {
-            if (liveNeighbourCount < 2) { // Dies due to underpopulation
-                nextStates.emplace_back(false);
-            } else if (liveNeighbourCount < 4) { // Lives to next state
-                nextStates.emplace_back(true);
-            }  else { // Dies due to overpopulation
-                nextStates.emplace_back(false);
+            if (m_live.get(id)) {
+                // Dies due to underpopulation (< 2) or overpopulation (> 3)
+                m_live.setNext(id, liveNeighbourCount == 2 || liveNeighbourCount == 3);
+            } else {
+                // Any dead node with exactly three live neighbors
+                // becomes a live node, as if by reproduction.
+                m_live.setNext(id, liveNeighbourCount == 3);
             }
-        } else {
-            // Any dead node with exactly three live neighbors
-            // becomes a live node, as if by reproduction.
-            nextStates.emplace_back(liveNeighbourCount == 3);
         }
-    }
+    });
 
-    // For each node, load the next state into the current state
-    size_t i = 0;
-    for (Node node : nodes()) {
-        node.setAttr(m_liveAttrId, nextStates.at(i));
-        ++i;
-    }
+    // the next states become the current ones at the end of the step
     return true;
 }
 
@@ -19,7 +19,7 @@ public:
     bool algorithmStep() override;
 
 private:
-    int m_liveAttrId;  // the id of the 'live' node's attribute
+    AttrBuffer<bool> m_live;  // the 'live' node's attribute
 };
 } // evoplex
 #endif // GAME_OF_LIFEL_H
@@ -12,49 +12,42 @@ namespace evoplex {
 
 bool PopulationGrowth::init()
 {
-    // gets the id of the `infected` node's attribute, which is the same for all nodes
-    m_infectedAttrId = node(0).attrs().indexOf("infected");
+    // resolves the `infected` node's attribute, which is the same for all nodes
+    // it is double-buffered, so the next states are written aside
+    m_infected = nodeAttrBuffer<bool>("infected");
     // initializing model attribute, which is constant throughout the simulation
     m_prob = attr("prob").toDouble();
 
-    return m_infectedAttrId >= 0;
+    return m_infected.isValid();
 }
 
 bool PopulationGrowth::algorithmStep()
 {
-    std::vector<Value> nextInfectedStates;
-    nextInfectedStates.reserve(nodes().size());
-
     for (Node node : nodes()) {
-        if (node.attr(m_infectedAttrId).toBool()) {
-            nextInfectedStates.emplace_back(true);
+        if (m_infected.get(node)) {
+            m_infected.setNext(node, true);
             continue; // the node is already infected; skip
         }
 
-        if (node.outDegree() < 1) {
-            nextInfectedStates.emplace_back(false);
+        const Neighbours nbs = graph()->outNeighbours(node.id());
+        if (nbs.empty()) {
+            m_infected.setNext(node, false);
             continue; // the node does not have neighbours; skip
         }
 
         // Select a random neighbour
-        auto neighbour = node.randNeighbour(prg());
+        const int neighbourId = nbs[prg()->uniform(nbs.size()-1)];
 
         // and check if the neighbour is currently infected
-        if (neighbour.attr(m_infectedAttrId).toBool()) {
+        if (m_infected.get(neighbourId)) {
             // if so, the current node will become infected with a given probability
-            nextInfectedStates.emplace_back(m_prob > prg()->uniform());
+            m_infected.setNext(node, m_prob > prg()->uniform());
         } else {
-            nextInfectedStates.emplace_back(false);
+            m_infected.setNext(node, false);
         }
     }
 
-    // For each node, load the next state into the current state
-    size_t i = 0;
-    for (Node node : nodes()) {
-        node.setAttr(m_infectedAttrId, nextInfectedStates.at(i));
-        ++i;
-    }
-
+    // the next states become the current ones at the end of the step
     return true;
 }
 } // evoplex
@@ -19,7 +19,7 @@ public:
     bool algorithmStep() override;
 
 private:
-    int m_infectedAttrId;   // the id of the 'infected' node's attribute
+    AttrBuffer<bool> m_infected; // the 'infected' node's attribute
     double m_prob;          // probability of a node becoming infected
 };
 } // evoplex
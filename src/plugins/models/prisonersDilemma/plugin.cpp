@@ -12,7 +12,10 @@ namespace evoplex {
 bool PDGame::init()
 {
     m_temptation = attr("temptation", -1.0).toDouble();
-    return m_temptation >=1.0 && m_temptation <= 2.0;
+    m_strategy = nodeAttrBuffer<int>("strategy");
+    m_score = nodeAttrHandle<double>("score");
+    return m_temptation >=1.0 && m_temptation <= 2.0
+            && m_strategy.isValid() && m_score.isValid();
 }
 
 bool PDGame::algorithmStep()
@@ -20,38 +23,30 @@ bool PDGame::algorithmStep()
     // 1. each agent accumulates the payoff obtained by playing
     //    the game with all its neighbours and itself
     for (Node node : nodes()) {
-        const int sX = node.attr(STRATEGY).toInt();
+        const int sX = m_strategy.get(node);
         double score = playGame(sX, sX);
-        for (const Node& neighbour : node.outEdges()) {
-            score += playGame(sX, neighbour.attr(STRATEGY).toInt());
+        for (int nbId : graph()->outNeighbours(node.id())) {
+            score += playGame(sX, m_strategy.get(nbId));
         }
-        node.setAttr(SCORE, score);
+        m_score.set(node, score);
     }
 
-    std::vector<char> bestStrategies;
-    bestStrategies.reserve(nodes().size());
-
     // 2. the best agent in the neighbourhood is selected to reproduce
     for (const Node& node : nodes()) {
-        int bestStrategy = node.attr(STRATEGY).toInt();
-        double highestScore = node.attr(SCORE).toDouble();
-        for (const Node& neighbour : node.outEdges()) {
-            const double neighbourScore = neighbour.attr(SCORE).toDouble();
+        int bestStrategy = m_strategy.get(node);
+        double highestScore = m_score.get(node);
+        for (int nbId : graph()->outNeighbours(node.id())) {
+            const double neighbourScore = m_score.get(nbId);
             if (neighbourScore > highestScore) {
                 highestScore = neighbourScore;
-                bestStrategy = neighbour.attr(STRATEGY).toInt();
+                bestStrategy = m_strategy.get(nbId);
             }
         }
-        bestStrategies.emplace_back(binarize(bestStrategy));
-    }
+        bestStrategy = binarize(bestStrategy);
 
-    // 3. prepare the next generation
-    size_t i = 0;
-    for (Node node : nodes()) {
-        int s = binarize(node.attr(STRATEGY).toInt());
-        s = (s == bestStrategies.at(i)) ? s : bestStrategies.at(i) + 2;
-        node.setAttr(STRATEGY, s);
-        ++i;
+        // 3. prepare the next generation; it becomes current at the end of the step
+        const int s = binarize(m_strategy.get(node));
+        m_strategy.setNext(node, s == bestStrategy ? s : bestStrategy + 2);
     }
 
     return true;
@@ -18,7 +18,8 @@ public:
     bool algorithmStep() override;
 
 private:
-    enum NodeAttr { STRATEGY, SCORE };
+    AttrBuffer<int> m_strategy;  // the 'strategy' node's attribute
+    AttrHandle<double> m_score;  // the 'score' node's attribute
 
     double m_temptation;
 
@@ -0,0 +1,73 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_UTILS_H
+#define BATCH_UTILS_H
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QTimer>
+#include <cstdio>
+
+#include <core/batchrunner.h>
+
+#include "testutils.h"
+
+// helpers for the tests which run this test binary as 'evoplex -no-gui';
+// the test's main() must call runBatch() when it gets '-no-gui'
+namespace evoplex {
+namespace TestUtils {
+
+// runs the command line as 'evoplex -no-gui' does, with the built-in plugins
+inline int runBatch(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    MainApp mainApp;
+    loadPlugins(&mainApp);
+    BatchRunner runner(&mainApp);
+    QString error;
+    if (!runner.init(app.arguments(), error)) {
+        fprintf(stderr, "%s\n", qPrintable(error));
+        return BatchRunner::InvalidArgs;
+    }
+    QTimer::singleShot(0, &runner, SLOT(start()));
+    return app.exec();
+}
+
+// runs this test binary with '-no-gui <args>' and returns its exit code;
+// 'output' gets what it has printed; -1 if it has not exited in time
+inline int runCli(const QStringList& args, QString& output, int timeout=30000)
+{
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(QCoreApplication::applicationFilePath(), QStringList("-no-gui") + args);
+    if (!process.waitForFinished(timeout)) {
+        process.kill();
+        process.waitForFinished();
+        return -1;
+    }
+    output = QString::fromUtf8(process.readAll());
+    return process.exitStatus() == QProcess::NormalExit ? process.exitCode() : -1;
+}
+
+} // TestUtils
+} // evoplex
+#endif // BATCH_UTILS_H
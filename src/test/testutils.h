@@ -0,0 +1,129 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <QDir>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <algorithm>
+
+#include <core/experiment.h>
+#include <core/expinputs.h>
+#include <core/mainapp.h>
+#include <core/project.h>
+#include <core/trial.h>
+
+// helpers for the tests which run experiments of the built-in plugins
+namespace evoplex {
+namespace TestUtils {
+
+// loads the built-in plugins; the directory is defined by CMake
+inline void loadPlugins(MainApp* mainApp)
+{
+    QDir dir(EVOPLEX_PLUGINS_DIR);
+    const QStringList nameFilter(QString("*%1").arg(MainApp::kPluginExtension));
+    for (const QString& fileName : dir.entryList(nameFilter, QDir::Files)) {
+        QString error;
+        mainApp->loadPlugin(dir.absoluteFilePath(fileName), error, false);
+    }
+}
+
+// the general attributes of a small experiment; the model's and the
+// graph's attributes (e.g., 'squareGrid_width') must be added to them
+inline QMap<QString, QString> generalAttrs(int expId, const QString& modelId,
+                                           const QString& graphId)
+{
+    return {
+        { GENERAL_ATTR_EXPID, QString::number(expId) },
+        { GENERAL_ATTR_NODES, "*100;min" },
+        { GENERAL_ATTR_GRAPHID, graphId },
+        { GENERAL_ATTR_MODELID, modelId },
+        { GENERAL_ATTR_SEED, "0" },
+        { GENERAL_ATTR_STOPAT, "10" },
+        { GENERAL_ATTR_TRIALS, "1" },
+        { GENERAL_ATTR_AUTODELETE, "false" },
+        { GENERAL_ATTR_GRAPHTYPE, "undirected" },
+        { GENERAL_ATTR_EDGEATTRS, "" },
+        { OUTPUT_DIR, "" },
+        { OUTPUT_HEADER, "" }
+    };
+}
+
+// sets the newest version of the plugins in 'attrs'
+inline QMap<QString, QString> withVersions(const MainApp* mainApp, QMap<QString, QString> attrs)
+{
+    auto newest = [](const QList<quint16>& versions) {
+        return versions.isEmpty() ? QString() : QString::number(
+                    *std::max_element(versions.cbegin(), versions.cend()));
+    };
+    attrs.insert(GENERAL_ATTR_GRAPHVS, newest(mainApp->graphs().values(attrs.value(GENERAL_ATTR_GRAPHID))));
+    attrs.insert(GENERAL_ATTR_MODELVS, newest(mainApp->models().values(attrs.value(GENERAL_ATTR_MODELID))));
+    return attrs;
+}
+
+// creates an experiment in 'project' with the newest version of the plugins;
+// it is null if the inputs are invalid
+inline ExperimentPtr newExperiment(MainApp* mainApp, const ProjectPtr& project,
+                                   QMap<QString, QString> attrs)
+{
+    attrs = withVersions(mainApp, attrs);
+
+    QString error;
+    ExpInputsPtr inputs = ExpInputs::parse(mainApp, attrs.keys(), attrs.values(), error);
+    if (!inputs || !error.isEmpty()) {
+        qWarning() << error;
+        return nullptr;
+    }
+    ExperimentPtr exp = project->newExperiment(std::move(inputs), error);
+    return exp && exp->expStatus() != Status::Invalid ? exp : nullptr;
+}
+
+// creates the trials of 'exp' and plays them until 'pauseAt'; the trials
+// are created here, so they can be read while they run
+inline bool play(const ExperimentPtr& exp, int pauseAt)
+{
+    if (!exp || !exp->reset()) {
+        return false;
+    }
+    exp->setPauseAt(pauseAt);
+    exp->play();
+    return true;
+}
+
+// checks if the experiment and all its trials are paused at 'step'
+inline bool isPaused(const ExperimentPtr& exp, int step)
+{
+    for (quint16 id = 0; id < exp->numTrials(); ++id) {
+        const Trial* trial = exp->trial(id);
+        if (trial->status() != Status::Paused || trial->step() != step) {
+            return false;
+        }
+    }
+    // the pause point is reset once the experiment has taken the trials back
+    return exp->expStatus() == Status::Paused && exp->pauseAt() == exp->stopAt();
+}
+
+} // TestUtils
+} // evoplex
+#endif // TEST_UTILS_H
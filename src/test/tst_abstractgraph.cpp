@@ -0,0 +1,272 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/include/abstractgraph.h>
+
+#include "testutils.h"
+
+namespace evoplex {
+class TestAbstractGraph: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    // the trials adopting a shared topology do not create its edges
+    void tst_sharedTopology();
+    // the trials of a lattice compute the neighbours without edges
+    void tst_lattice();
+    // looks up the edges by their pair of nodes
+    void tst_edgeDirected();
+    void tst_edgeUndirected();
+    // drops the tombstones left by the removed nodes
+    void tst_squeeze();
+
+private:
+    static const int kTimeout = 10000; // msec
+
+    MainApp* m_mainApp;
+    ProjectPtr m_project;
+    int m_lastExpId;
+
+    // creates the trials of a new experiment and plays them until 'pauseAt'
+    ExperimentPtr _play(QMap<QString, QString> attrs, int pauseAt);
+    // a single trial of 'numNodes' nodes without edges
+    QMap<QString, QString> _zeroEdges(int numNodes, const QString& graphType) const;
+};
+
+void TestAbstractGraph::initTestCase()
+{
+    m_mainApp = new MainApp();
+    TestUtils::loadPlugins(m_mainApp);
+    QString error;
+    m_project = m_mainApp->newProject(error);
+    QVERIFY2(m_project, qPrintable(error));
+    m_lastExpId = -1;
+}
+
+void TestAbstractGraph::cleanupTestCase()
+{
+    m_project.reset();
+    delete m_mainApp;
+}
+
+ExperimentPtr TestAbstractGraph::_play(QMap<QString, QString> attrs, int pauseAt)
+{
+    attrs.insert(GENERAL_ATTR_EXPID, QString::number(++m_lastExpId));
+    ExperimentPtr exp = TestUtils::newExperiment(m_mainApp, m_project, attrs);
+    return TestUtils::play(exp, pauseAt) ? exp : nullptr;
+}
+
+QMap<QString, QString> TestAbstractGraph::_zeroEdges(int numNodes, const QString& graphType) const
+{
+    auto attrs = TestUtils::generalAttrs(0, "populationGrowth", "zeroEdges");
+    attrs.insert(GENERAL_ATTR_NODES, QString("*%1;min").arg(numNodes));
+    attrs.insert(GENERAL_ATTR_GRAPHTYPE, graphType);
+    attrs.insert("populationGrowth_prob", "0.1");
+    return attrs;
+}
+
+void TestAbstractGraph::tst_sharedTopology()
+{
+    auto attrs = TestUtils::generalAttrs(0, "populationGrowth", "star");
+    attrs.insert(GENERAL_ATTR_TRIALS, "3");
+    attrs.insert("populationGrowth_prob", "0.1");
+    ExperimentPtr exp = _play(attrs, 0);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 0), kTimeout);
+
+    // the first trial to be set up builds the edges; the others share them
+    const AbstractGraph* builder = nullptr;
+    for (quint16 id = 0; id < 3; ++id) {
+        const AbstractGraph* graph = exp->trial(id)->graph();
+        if (!graph->hasPendingEdges()) {
+            QVERIFY(!builder);
+            builder = graph;
+        }
+    }
+    QVERIFY(builder);
+    QCOMPARE(builder->numEdges(), 99);
+
+    for (quint16 id = 0; id < 3; ++id) {
+        const AbstractGraph* graph = exp->trial(id)->graph();
+        if (graph == builder) {
+            continue;
+        }
+        // the neighbours are read from the shared snapshot
+        QCOMPARE(graph->numEdges(), builder->numEdges());
+        QVERIFY(&graph->outAdjacency() == &builder->outAdjacency());
+        QCOMPARE(graph->outNeighbours(0).size(), 99);
+        QVERIFY(graph->hasPendingEdges());
+
+        // the Edge objects are only created on demand
+        QCOMPARE(static_cast<int>(graph->edges().size()), builder->numEdges());
+        QVERIFY(!graph->hasPendingEdges());
+        QVERIFY(&graph->outAdjacency() == &builder->outAdjacency());
+    }
+}
+
+void TestAbstractGraph::tst_lattice()
+{
+    auto attrs = TestUtils::generalAttrs(0, "gameOfLife", "squareGrid");
+    attrs.insert(GENERAL_ATTR_TRIALS, "2");
+    attrs.insert("squareGrid_neighbours", "8");
+    attrs.insert("squareGrid_height", "10");
+    attrs.insert("squareGrid_width", "10");
+    attrs.insert("squareGrid_boundary", "periodic");
+    ExperimentPtr exp = _play(attrs, 0);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 0), kTimeout);
+
+    for (quint16 id = 0; id < 2; ++id) {
+        const AbstractGraph* graph = exp->trial(id)->graph();
+        QVERIFY(graph->lattice());
+        QVERIFY(graph->hasPendingEdges());
+        QCOMPARE(graph->numEdges(), 400);
+        QCOMPARE(graph->outNeighbours(0).size(), 8);
+        QVERIFY(graph->hasPendingEdges());
+    }
+
+    // the model reads the neighbours only, so the steps do not create the edges
+    exp->setPauseAt(3);
+    exp->play();
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 3), kTimeout);
+    for (quint16 id = 0; id < 2; ++id) {
+        QVERIFY(exp->trial(id)->graph()->hasPendingEdges());
+    }
+
+    // the Edge objects are only created on demand
+    const AbstractGraph* graph = exp->trial(0)->graph();
+    QCOMPARE(static_cast<int>(graph->edges().size()), 400);
+    QVERIFY(!graph->hasPendingEdges());
+}
+
+void TestAbstractGraph::tst_edgeDirected()
+{
+    ExperimentPtr exp = _play(_zeroEdges(4, "directed"), 0);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 0), kTimeout);
+    AbstractGraph* graph = exp->trial(0)->graph();
+
+    // the index is built by the first lookup
+    const size_t revision = graph->revision();
+    const int e01 = graph->addEdge(0, 1).id();
+    QVERIFY(graph->revision() != revision);
+    QCOMPARE(graph->edge(0, 1).id(), e01);
+    QCOMPARE(graph->edge(0, 1).origin().id(), 0);
+    QVERIFY_EXCEPTION_THROWN(graph->edge(1, 0), std::out_of_range);
+    QVERIFY_EXCEPTION_THROWN(graph->edge(0, 2), std::out_of_range);
+
+    // and then updated along with the edges
+    const int e10 = graph->addEdge(1, 0).id();
+    QCOMPARE(graph->edge(1, 0).id(), e10);
+    QCOMPARE(graph->edge(1, 0).origin().id(), 1);
+    QCOMPARE(graph->edge(0, 1).id(), e01);
+
+    // the Edge objects are invalidated by a new revision
+    const size_t beforeRemoval = graph->revision();
+    QCOMPARE(graph->edge(1, 0).id(), e10); // lookups do not change it
+    QCOMPARE(graph->revision(), beforeRemoval);
+    graph->removeEdge(graph->edge(0, 1));
+    QVERIFY(graph->revision() != beforeRemoval);
+    QVERIFY_EXCEPTION_THROWN(graph->edge(0, 1), std::out_of_range);
+    QCOMPARE(graph->edge(1, 0).id(), e10);
+}
+
+void TestAbstractGraph::tst_edgeUndirected()
+{
+    ExperimentPtr exp = _play(_zeroEdges(4, "undirected"), 0);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 0), kTimeout);
+    AbstractGraph* graph = exp->trial(0)->graph();
+
+    // the nodes can be given in any order; the origin is the first one
+    const int e01 = graph->addEdge(0, 1).id();
+    const int e21 = graph->addEdge(2, 1).id();
+    QCOMPARE(graph->edge(0, 1).id(), e01);
+    QCOMPARE(graph->edge(1, 0).id(), e01);
+    QCOMPARE(graph->edge(1, 0).origin().id(), 1);
+    QCOMPARE(graph->edge(1, 0).neighbour().id(), 0);
+    QCOMPARE(graph->edge(1, 2).id(), e21);
+    QVERIFY_EXCEPTION_THROWN(graph->edge(0, 2), std::out_of_range);
+
+    // any of the parallel edges is returned, until both are removed
+    const int e10 = graph->addEdge(1, 0).id();
+    const int found = graph->edge(0, 1).id();
+    QVERIFY(found == e01 || found == e10);
+    graph->removeEdge(graph->edge(0, 1));
+    QCOMPARE(graph->edge(1, 0).id(), found == e01 ? e10 : e01);
+    graph->removeEdge(graph->edge(1, 0));
+    QVERIFY_EXCEPTION_THROWN(graph->edge(0, 1), std::out_of_range);
+    QCOMPARE(graph->edge(2, 1).id(), e21);
+
+    // the index is kept up to date after all edges are removed
+    graph->removeAllEdges();
+    QVERIFY_EXCEPTION_THROWN(graph->edge(2, 1), std::out_of_range);
+    const int e32 = graph->addEdge(3, 2).id();
+    QCOMPARE(graph->edge(2, 3).id(), e32);
+}
+
+void TestAbstractGraph::tst_squeeze()
+{
+    ExperimentPtr exp = _play(_zeroEdges(20, "undirected"), 0);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 0), kTimeout);
+    AbstractGraph* graph = exp->trial(0)->graph();
+    QCOMPARE(graph->fragmentation(), 0.0);
+
+    for (int id = 0; id < 15; ++id) {
+        graph->removeNode(graph->node(id));
+    }
+    QCOMPARE(graph->numNodes(), 5);
+    QCOMPARE(graph->fragmentation(), 0.75);
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(graph->randNode().id() >= 15);
+    }
+
+    graph->squeeze();
+    QCOMPARE(graph->fragmentation(), 0.0);
+    QCOMPARE(graph->nodeAttrsTable().numRows(), size_t(20)); // rows are node ids
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(graph->randNode().id() >= 15);
+    }
+
+    // only the rows after the last node are dropped
+    graph->removeNode(graph->node(18));
+    graph->removeNode(graph->node(19));
+    graph->squeeze();
+    QCOMPARE(graph->nodeAttrsTable().numRows(), size_t(18));
+    QCOMPARE(graph->nodeAttrsTable().size(), size_t(3));
+    QCOMPARE(graph->node(17).id(), 17);
+    QVERIFY_EXCEPTION_THROWN(graph->node(18), std::out_of_range);
+
+    // the new nodes get new rows
+    const Node node = graph->addNode(graph->node(17).attrs());
+    QCOMPARE(node.id(), 20);
+    QCOMPARE(graph->nodeAttrsTable().numRows(), size_t(21));
+    QCOMPARE(graph->node(20).attrs().values(), graph->node(17).attrs().values());
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestAbstractGraph)
+#include "tst_abstractgraph.moc"
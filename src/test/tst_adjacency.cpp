@@ -0,0 +1,177 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/include/adjacency.h>
+#include <core/include/edge.h>
+#include <core/include/nodes.h>
+#include <core/edge_p.h>
+#include <core/node_p.h>
+
+namespace evoplex {
+class TestAdjacency: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void cleanup();
+    void tst_empty();
+    void tst_directed();
+    void tst_undirected();
+
+private:
+    // creates 'numNodes' nodes with ids 0..numNodes-1
+    template <class T>
+    void _addNodes(Nodes& nodes, int numNodes);
+    void _addEdge(Nodes& nodes, int edgeId, int originId, int neighbourId);
+    // checks if the adjacency matches the edges of each node
+    void _compare(const Adjacency& adj, const Nodes& nodes, bool outward);
+
+    EdgeArena m_arena;
+    std::vector<BaseEdge*> m_records;
+};
+
+void TestAdjacency::cleanup()
+{
+    for (BaseEdge* e : m_records) {
+        m_arena.destroy(e);
+    }
+    m_records.clear();
+}
+
+template <class T>
+void TestAdjacency::_addNodes(Nodes& nodes, int numNodes)
+{
+    BaseNode::constructor_key key;
+    for (int id = 0; id < numNodes; ++id) {
+        nodes.insert({id, Node(std::make_shared<T>(key, id, Attributes()))});
+    }
+}
+
+void TestAdjacency::_addEdge(Nodes& nodes, int edgeId, int originId, int neighbourId)
+{
+    const Node& origin = nodes.at(originId);
+    const Node& neighbour = nodes.at(neighbourId);
+    BaseEdge* e = m_arena.create(edgeId, origin, neighbour, Attributes());
+    m_records.emplace_back(e);
+    origin.m_ptr->addOutEdge(Edge(e));
+    neighbour.m_ptr->addInEdge(Edge(e, true));
+}
+
+void TestAdjacency::_compare(const Adjacency& adj, const Nodes& nodes, bool outward)
+{
+    QCOMPARE(adj.numSlots(), static_cast<int>(nodes.size()));
+    for (auto const& np : nodes) {
+        const Edges& edges = outward ? np.second.outEdges() : np.second.inEdges();
+        const Neighbours nbs = adj.neighbours(np.first);
+        QCOMPARE(nbs.size(), static_cast<int>(edges.size()));
+        QCOMPARE(adj.degree(np.first), nbs.size());
+
+        // must follow the same order of the edges container
+        int i = 0;
+        for (auto const& ep : edges) {
+            QCOMPARE(nbs[i], ep.second.neighbour().id());
+            QCOMPARE(nbs.edgeId(i), ep.first);
+            ++i;
+        }
+    }
+}
+
+void TestAdjacency::tst_empty()
+{
+    Adjacency adj;
+    QCOMPARE(adj.numSlots(), 0);
+    QVERIFY_EXCEPTION_THROWN(adj.neighbours(0), std::out_of_range);
+
+    Nodes nodes;
+    adj.build(nodes, true);
+    QCOMPARE(adj.numSlots(), 0);
+    QVERIFY(adj.neighbourIds().empty());
+
+    // nodes without edges
+    _addNodes<DNode>(nodes, 3);
+    adj.build(nodes, true);
+    QCOMPARE(adj.numSlots(), 3);
+    for (int id = 0; id < 3; ++id) {
+        QVERIFY(adj.neighbours(id).empty());
+        QVERIFY(adj.neighbours(id).begin() == adj.neighbours(id).end());
+    }
+    QVERIFY_EXCEPTION_THROWN(adj.neighbours(-1), std::out_of_range);
+    QVERIFY_EXCEPTION_THROWN(adj.degree(3), std::out_of_range);
+
+    adj.clear();
+    QCOMPARE(adj.numSlots(), 0);
+}
+
+void TestAdjacency::tst_directed()
+{
+    Nodes nodes;
+    _addNodes<DNode>(nodes, 4);
+    _addEdge(nodes, 0, 0, 1);
+    _addEdge(nodes, 1, 0, 2);
+    _addEdge(nodes, 2, 0, 3);
+    _addEdge(nodes, 3, 2, 0);
+    _addEdge(nodes, 4, 3, 3);
+
+    Adjacency out;
+    out.build(nodes, true);
+    _compare(out, nodes, true);
+    QCOMPARE(out.degree(0), 3);
+    QCOMPARE(out.degree(1), 0);
+    QCOMPARE(out.neighbours(2)[0], 0);
+    QCOMPARE(out.neighbours(3)[0], 3);
+    QCOMPARE(out.neighbourIds().size(), size_t(5));
+
+    Adjacency in;
+    in.build(nodes, false);
+    _compare(in, nodes, false);
+    QCOMPARE(in.degree(0), 1);
+    QCOMPARE(in.degree(3), 2);
+
+    // range-based loop
+    int sum = 0;
+    for (int nbId : out.neighbours(0)) {
+        sum += nbId;
+    }
+    QCOMPARE(sum, 6);
+}
+
+void TestAdjacency::tst_undirected()
+{
+    Nodes nodes;
+    _addNodes<UNode>(nodes, 3);
+    _addEdge(nodes, 0, 0, 1);
+    _addEdge(nodes, 1, 1, 2);
+
+    Adjacency adj;
+    adj.build(nodes, true);
+    _compare(adj, nodes, true);
+    QCOMPARE(adj.degree(0), 1);
+    QCOMPARE(adj.degree(1), 2);
+    QCOMPARE(adj.degree(2), 1);
+    QCOMPARE(adj.neighbours(2)[0], 1);
+    QCOMPARE(adj.neighbours(2).edgeId(0), 1);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestAdjacency)
+#include "tst_adjacency.moc"
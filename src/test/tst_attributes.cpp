@@ -36,6 +36,7 @@ private slots:
     void tst_replace();
     void tst_push_back();
     void tst_setValue();
+    void tst_schema();
 
 private: // auxiliary functions
     void _tst_empty(Attributes a);
@@ -364,5 +365,67 @@ void TestAttributes::tst_setValue()
     _tst_empty(a5);
 }
 
+// Tests if the names are shared between copies until one of them changes.
+void TestAttributes::tst_schema()
+{
+    auto schema = std::make_shared<AttributesSchema>(
+                std::vector<QString>({"a", "b"}),
+                std::vector<Value::Type>({Value::INT}));
+    QCOMPARE(schema->size(), 2);
+    QCOMPARE(schema->indexOf("b"), 1);
+    QCOMPARE(schema->type(0), Value::INT);
+    QCOMPARE(schema->type(1), Value::INVALID);
+    QVERIFY_EXCEPTION_THROWN(schema->name(2), std::out_of_range);
+
+    Attributes a1(schema);
+    QCOMPARE(a1.size(), 2);
+    QCOMPARE(a1.names(), schema->names());
+    QVERIFY(!a1.value(0).isValid());
+
+    // copies and value changes keep the same schema
+    Attributes a2 = a1;
+    a2.setValue(0, Value(1));
+    a2.replace(1, "b", Value(2));
+    QCOMPARE(a2.schema(), a1.schema());
+    QVERIFY(!a1.value(0).isValid());
+
+    // changing a name detaches the schema
+    a2.replace(1, "c", Value(3));
+    QVERIFY(a2.schema() != a1.schema());
+    QCOMPARE(a1.name(1), QString("b"));
+    QCOMPARE(a2.name(1), QString("c"));
+    QCOMPARE(schema->name(1), QString("b"));
+
+    a1.push_back("d", Value(4));
+    QCOMPARE(a1.indexOf("d"), 2);
+    QCOMPARE(schema->size(), 2);
+
+    // the schema is not counted
+    Attributes a3(schema);
+    QCOMPARE(a3.memoryUsage(), sizeof(Attributes) + 2 * sizeof(Value));
+
+    // a schema received from outside is never changed in place,
+    // even if the container holds the only reference to it
+    AttributesSchemaPtr external = std::make_shared<const AttributesSchema>(
+                std::vector<QString>({"x"}));
+    std::weak_ptr<const AttributesSchema> weak = external;
+    Attributes a4(std::move(external));
+    a4.push_back("y", Value(5));
+    QVERIFY(weak.expired());
+    QCOMPARE(a4.names(), std::vector<QString>({"x", "y"}));
+
+    // but the container's own schema is, when it is not shared
+    Attributes a5;
+    a5.push_back("x", Value(1));
+    const AttributesSchema* own = a5.schema().get();
+    a5.push_back("y", Value(2));
+    QVERIFY(a5.schema().get() == own);
+
+    // a moved-from container does not touch the schema it has given away
+    Attributes a6(std::move(a5));
+    a5.push_back("z", Value(3));
+    QCOMPARE(a6.names(), std::vector<QString>({"x", "y"}));
+}
+
 QTEST_MAIN(TestAttributes)
 #include "tst_attributes.moc"
@@ -0,0 +1,350 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/include/attributestable.h>
+#include <core/include/stats.h>
+
+namespace evoplex {
+class TestAttributesTable: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    void tst_typedColumns();
+    void tst_typedSetters();
+    void tst_genericFallback();
+    void tst_copyOnWrite();
+    void tst_backBuffers();
+    void tst_dataStream();
+    void tst_rows();
+    void tst_count();
+
+private:
+    Attributes m_sample;
+    // fills a table with 'numRows' rows
+    AttributesTable _createTable(int numRows);
+};
+
+void TestAttributesTable::initTestCase()
+{
+    m_sample.push_back("bool", Value(true));
+    m_sample.push_back("int", Value(1));
+    m_sample.push_back("double", Value(1.5));
+    m_sample.push_back("char", Value('a'));
+    m_sample.push_back("string", Value("abc"));
+}
+
+AttributesTable TestAttributesTable::_createTable(int numRows)
+{
+    AttributesTable table(m_sample);
+    for (int row = 0; row < numRows; ++row) {
+        Attributes attrs = m_sample;
+        attrs.setValue(0, row % 3 == 0);
+        attrs.setValue(1, row % 5);
+        attrs.setValue(2, row * 0.5);
+        attrs.setValue(4, row % 2 ? "odd" : "even");
+        table.insertRow(static_cast<size_t>(row), attrs);
+    }
+    return table;
+}
+
+void TestAttributesTable::tst_typedColumns()
+{
+    AttributesTable table = _createTable(130);
+    QCOMPARE(table.numColumns(), 5);
+    QCOMPARE(table.names(), m_sample.names());
+    QCOMPARE(table.indexOf("double"), 2);
+    QCOMPARE(table.indexOf("invalid"), -1);
+    QCOMPARE(table.size(), size_t(130));
+    QCOMPARE(table.numRows(), size_t(130));
+
+    QCOMPARE(table.column(0).type(), Value::BOOL);
+    QCOMPARE(table.column(1).type(), Value::INT);
+    QCOMPARE(table.column(2).type(), Value::DOUBLE);
+    QCOMPARE(table.column(3).type(), Value::CHAR);
+    QCOMPARE(table.column(4).type(), Value::STRING);
+
+    // bools are bit-packed
+    QCOMPARE(table.column(0).bools().size(), size_t(3));
+    // strings are interned (including the default empty string)
+    QCOMPARE(table.column(4).strings().size(), size_t(3));
+
+    for (size_t row = 0; row < 130; ++row) {
+        QCOMPARE(table.column(0).boolAt(row), row % 3 == 0);
+        QCOMPARE(table.column(1).intAt(row), static_cast<int>(row % 5));
+        QCOMPARE(table.column(2).doubleAt(row), row * 0.5);
+        QCOMPARE(table.column(3).charAt(row), 'a');
+        QCOMPARE(table.value(row, 4), Value(row % 2 ? "odd" : "even"));
+    }
+
+    table.setValue(64, 0, Value(true));
+    QCOMPARE(table.value(64, 0), Value(true));
+    table.setValue(64, 0, Value(false));
+    QCOMPARE(table.value(64, 0), Value(false));
+    QCOMPARE(table.value(63, 0), Value(true));
+
+    QVERIFY_EXCEPTION_THROWN(table.value(0, 5), std::out_of_range);
+    QVERIFY_EXCEPTION_THROWN(table.column(-1), std::out_of_range);
+}
+
+void TestAttributesTable::tst_typedSetters()
+{
+    AttributesTable table = _createTable(130);
+
+    // they write the typed storage in place
+    table.column(0).setBoolAt(64, true);
+    table.column(0).setBoolAt(63, false);
+    table.column(1).setIntAt(5, 42);
+    table.column(2).setDoubleAt(5, -1.5);
+    table.column(3).setCharAt(5, 'z');
+    QCOMPARE(table.value(64, 0), Value(true));
+    QCOMPARE(table.value(63, 0), Value(false));
+    QCOMPARE(table.value(65, 0), Value(false));
+    QCOMPARE(table.value(66, 0), Value(true));
+    QCOMPARE(table.value(5, 1), Value(42));
+    QCOMPARE(table.value(5, 2), Value(-1.5));
+    QCOMPARE(table.value(5, 3), Value('z'));
+
+    // the types are kept
+    QCOMPARE(table.column(0).type(), Value::BOOL);
+    QCOMPARE(table.column(1).type(), Value::INT);
+    QCOMPARE(table.column(2).type(), Value::DOUBLE);
+    QCOMPARE(table.column(3).type(), Value::CHAR);
+}
+
+void TestAttributesTable::tst_genericFallback()
+{
+    AttributesTable table = _createTable(10);
+
+    // writing a value of a different type keeps all the values
+    table.setValue(3, 1, Value("abc"));
+    QVERIFY(table.column(1).isGeneric());
+    QCOMPARE(table.value(3, 1), Value("abc"));
+    for (size_t row = 0; row < 10; ++row) {
+        if (row != 3) {
+            QCOMPARE(table.value(row, 1), Value(static_cast<int>(row % 5)));
+        }
+    }
+
+    // the other columns are not affected
+    QCOMPARE(table.column(0).type(), Value::BOOL);
+
+    // a column of invalid values is generic from the start
+    Attributes attrs(1);
+    attrs.replace(0, "a", Value());
+    AttributesTable t2(attrs);
+    QVERIFY(t2.column(0).isGeneric());
+}
+
+void TestAttributesTable::tst_copyOnWrite()
+{
+    const AttributesTable table = _createTable(10);
+
+    // the copy shares the columns until it writes to them
+    AttributesTable copy(table);
+    const AttributesTable& cCopy = copy;
+    QVERIFY(&cCopy.column(1) == &table.column(1));
+    copy.setValue(3, 1, Value(42));
+    QVERIFY(&cCopy.column(1) != &table.column(1));
+    QVERIFY(&cCopy.column(2) == &table.column(2));
+    QCOMPARE(copy.value(3, 1), Value(42));
+    QCOMPARE(table.value(3, 1), Value(3));
+
+    // a column handed out for writing is never shared again
+    AttributeColumn& col = copy.column(2);
+    AttributesTable copy2(copy);
+    col.setDoubleAt(0, 9.0);
+    QCOMPARE(copy.value(0, 2), Value(9.0));
+    QCOMPARE(copy2.value(0, 2), Value(0.0));
+    QCOMPARE(table.value(0, 2), Value(0.0));
+
+    // detachAll() copies all shared columns up front
+    AttributesTable copy3(table);
+    const AttributesTable& cCopy3 = copy3;
+    copy3.detachAll();
+    for (int col = 0; col < table.numColumns(); ++col) {
+        QVERIFY(&cCopy3.column(col) != &table.column(col));
+    }
+    const AttributeColumn* col1 = &cCopy3.column(1);
+    copy3.setValue(4, 1, Value(7));
+    QVERIFY(&cCopy3.column(1) == col1);
+    QCOMPARE(table.value(4, 1), Value(4));
+}
+
+void TestAttributesTable::tst_backBuffers()
+{
+    AttributesTable table = _createTable(10);
+    QVERIFY(!table.hasBackColumn(1));
+
+    // the back buffer starts as a copy of the column
+    AttributeColumn& back = table.backColumn(1);
+    QVERIFY(table.hasBackColumn(1));
+    QVERIFY(!table.hasBackColumn(2));
+    QCOMPARE(back.intAt(3), 3);
+
+    // writing to it does not change the current values until the swap
+    const AttributeColumn& front = table.column(1);
+    back.setIntAt(3, 42);
+    QCOMPARE(table.value(3, 1), Value(3));
+    table.swapBuffers();
+    QCOMPARE(table.value(3, 1), Value(42));
+    QCOMPARE(table.value(4, 1), Value(4));
+    QCOMPARE(back.intAt(3), 3);
+    // the references remain valid
+    QVERIFY(&front == &table.column(1));
+    QVERIFY(&back == &table.backColumn(1));
+
+    // new rows are added to both buffers
+    table.insertRow(12, m_sample);
+    QCOMPARE(back.size(), table.column(1).size());
+    QCOMPARE(back.intAt(12), 1);
+
+    // the copies do not take the back buffers
+    AttributesTable copy(table);
+    QVERIFY(!copy.hasBackColumn(1));
+    QCOMPARE(copy.value(3, 1), Value(42));
+}
+
+void TestAttributesTable::tst_dataStream()
+{
+    AttributesTable table = _createTable(130);
+    table.removeRow(7);
+    table.setValue(3, 2, Value("abc")); // a generic column
+    table.backColumn(1).setIntAt(5, 42);
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << table;
+
+    AttributesTable read;
+    QDataStream in(data);
+    in >> read;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QCOMPARE(read.names(), table.names());
+    QCOMPARE(read.numRows(), table.numRows());
+    QCOMPARE(read.size(), table.size());
+    QVERIFY(!read.isValidRow(7));
+    for (int col = 0; col < table.numColumns(); ++col) {
+        QCOMPARE(read.column(col).type(), table.column(col).type());
+        for (size_t row = 0; row < table.numRows(); ++row) {
+            QCOMPARE(read.value(row, col), table.value(row, col));
+        }
+    }
+    QVERIFY(read.matches(m_sample));
+
+    // the back buffers are kept
+    QVERIFY(read.hasBackColumn(1));
+    QVERIFY(!read.hasBackColumn(2));
+    read.swapBuffers();
+    QCOMPARE(read.value(5, 1), Value(42));
+
+    // a truncated stream leaves the table untouched
+    AttributesTable other = _createTable(2);
+    QDataStream in2(data.left(data.size() / 2));
+    in2 >> other;
+    QVERIFY(in2.status() != QDataStream::Ok);
+    QCOMPARE(other.numRows(), size_t(2));
+}
+
+void TestAttributesTable::tst_rows()
+{
+    AttributesTable table = _createTable(4);
+
+    Attributes attrs = table.row(2);
+    QCOMPARE(attrs.names(), m_sample.names());
+    QCOMPARE(attrs.value(0), Value(false));
+    QCOMPARE(attrs.value(1), Value(2));
+    QCOMPARE(attrs.value(4), Value("even"));
+
+    table.removeRow(1);
+    QCOMPARE(table.size(), size_t(3));
+    QCOMPARE(table.numRows(), size_t(4));
+    QVERIFY(!table.isValidRow(1));
+    QVERIFY(table.isValidRow(2));
+    table.removeRow(1);
+    QCOMPARE(table.size(), size_t(3));
+
+    // growing the table leaves a gap of invalid rows
+    table.insertRow(7, m_sample);
+    QCOMPARE(table.size(), size_t(4));
+    QCOMPARE(table.numRows(), size_t(8));
+    QVERIFY(!table.isValidRow(5));
+    QCOMPARE(table.value(7, 4), Value("abc"));
+
+    // squeezing drops the invalid rows at the end only
+    table.removeRow(7);
+    table.squeeze();
+    QCOMPARE(table.numRows(), size_t(4));
+    QVERIFY(!table.isValidRow(1));
+    QCOMPARE(table.value(3, 0), Value(true));
+    table.removeRow(3);
+    table.squeeze();
+    QCOMPARE(table.numRows(), size_t(3));
+    QCOMPARE(table.size(), size_t(2));
+    // the rows added again are default-initialized
+    Attributes attrs5 = m_sample;
+    attrs5.setValue(0, false);
+    table.insertRow(5, attrs5);
+    QVERIFY(!table.isValidRow(3));
+    QCOMPARE(table.column(0).boolAt(3), false);
+    QCOMPARE(table.value(5, 0), Value(false));
+
+    // it must have the same attributes
+    Attributes other;
+    other.push_back("bool", Value(true));
+    QVERIFY(!table.matches(other));
+    QVERIFY_EXCEPTION_THROWN(table.insertRow(8, other), std::invalid_argument);
+}
+
+void TestAttributesTable::tst_count()
+{
+    AttributesTable table = _createTable(100);
+
+    Values header = { Value(false), Value(true) };
+    Values ret = Stats::count(table, 0, header);
+    QCOMPARE(ret.at(0), Value(66));
+    QCOMPARE(ret.at(1), Value(34));
+
+    header = { Value(0), Value(4), Value(7) };
+    ret = Stats::count(table, 1, header);
+    QCOMPARE(ret.at(0), Value(20));
+    QCOMPARE(ret.at(1), Value(20));
+    QCOMPARE(ret.at(2), Value(0));
+
+    header = { Value("odd"), Value("even") };
+    ret = Stats::count(table, 4, header);
+    QCOMPARE(ret.at(0), Value(50));
+    QCOMPARE(ret.at(1), Value(50));
+
+    // invalid rows are not counted
+    table.removeRow(0);
+    table.removeRow(1);
+    header = { Value(false), Value(true) };
+    ret = Stats::count(table, 0, header);
+    QCOMPARE(ret.at(0), Value(65));
+    QCOMPARE(ret.at(1), Value(33));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestAttributesTable)
+#include "tst_attributestable.moc"
@@ -0,0 +1,144 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QTextStream>
+#include <QtTest>
+
+#include "batchutils.h"
+
+namespace evoplex {
+class TestBatchRunner: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    // nothing is run if the command line is not valid
+    void tst_invalidArgs();
+    // the exit code tells if some experiments have failed
+    void tst_exitCodes();
+
+private:
+    MainApp* m_mainApp;
+    QTemporaryDir m_dir;
+    // rows: a valid experiment (id 0), an invalid one (id 1) and a sweep of two points
+    QString m_project;
+};
+
+void TestBatchRunner::initTestCase()
+{
+    m_mainApp = new MainApp();
+    TestUtils::loadPlugins(m_mainApp);
+    QVERIFY(m_dir.isValid());
+
+    QList<QMap<QString, QString>> rows;
+    for (int id = 0; id < 3; ++id) {
+        auto attrs = TestUtils::generalAttrs(id, "populationGrowth", "zeroEdges");
+        attrs.insert(GENERAL_ATTR_FORKAT, "0");
+        attrs.insert("populationGrowth_prob", "0.1");
+        rows.append(TestUtils::withVersions(m_mainApp, attrs));
+    }
+    rows[1].insert(GENERAL_ATTR_FORKAT, rows[1].value(GENERAL_ATTR_STOPAT));
+    rows[2].insert("populationGrowth_prob", "double{0.1;0.2}");
+
+    m_project = m_dir.filePath("project.csv");
+    QFile file(m_project);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Text));
+    QTextStream out(&file);
+    out << QStringList(rows.first().keys()).join(",") << "\n";
+    for (const auto& row : rows) {
+        out << QStringList(row.values()).join(",") << "\n";
+    }
+}
+
+void TestBatchRunner::cleanupTestCase()
+{
+    delete m_mainApp;
+}
+
+void TestBatchRunner::tst_invalidArgs()
+{
+    const int invalidArgs = BatchRunner::InvalidArgs;
+    QString output;
+
+    // no project
+    QCOMPARE(TestUtils::runCli({}, output), invalidArgs);
+    QVERIFY(output.contains("Usage:"));
+    QCOMPARE(TestUtils::runCli({ m_dir.filePath("missing.csv") }, output), invalidArgs);
+    QVERIFY(output.contains("missing.csv"));
+
+    QCOMPARE(TestUtils::runCli({ "-threads", "two", m_project }, output), invalidArgs);
+    QVERIFY(output.contains("the number of threads must be an integer."));
+
+    QCOMPARE(TestUtils::runCli({ "-experiments", "0,7", m_project }, output), invalidArgs);
+    QVERIFY(output.contains("the experiment '7' does not exist."));
+    QCOMPARE(TestUtils::runCli({ "-experiments", "zero", m_project }, output), invalidArgs);
+    QVERIFY(output.contains("the experiment 'zero' does not exist."));
+
+    QCOMPARE(TestUtils::runCli({ "-workers", "0", m_project }, output), invalidArgs);
+    QVERIFY(output.contains("the number of workers must be greater than 0."));
+}
+
+void TestBatchRunner::tst_exitCodes()
+{
+    const int success = BatchRunner::Success;
+    const int failedExps = BatchRunner::FailedExps;
+    QString output;
+
+    // the chosen experiments leave the sweep out, but not silently
+    QCOMPARE(TestUtils::runCli({ "-experiments", "0", m_project }, output), success);
+    QVERIFY(output.contains("[E0] 100%"));
+    QVERIFY(output.contains("[S3] not chosen by -experiments; it will be skipped"));
+    QVERIFY(output.contains("1 of 1 experiments finished"));
+
+    QCOMPARE(TestUtils::runCli({ "-experiments", "0,1", m_project }, output), failedExps);
+    QVERIFY(output.contains("[E1] invalid; it will be skipped"));
+    QVERIFY(output.contains("1 of 2 experiments finished"));
+
+    // all of them, i.e., with the points of the sweep
+    QCOMPARE(TestUtils::runCli({ m_project }, output), failedExps);
+    QVERIFY(output.contains("[S3] 2 points"));
+    QVERIFY(output.contains("3 of 4 experiments finished"));
+
+    // likewise, through the workers
+    QCOMPARE(TestUtils::runCli({ "-workers", "2", "-experiments", "0", m_project }, output), success);
+    QVERIFY(output.contains("1 of 1 experiments finished"));
+    QCOMPARE(TestUtils::runCli({ "-workers", "2", m_project }, output), failedExps);
+    QVERIFY(output.contains("3 of 4 experiments finished"));
+}
+
+} // evoplex
+
+// the tests run this test binary as 'evoplex -no-gui'
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (!qstrcmp(argv[i], "-no-gui")) {
+            return evoplex::TestUtils::runBatch(argc, argv);
+        }
+    }
+    QCoreApplication app(argc, argv);
+    evoplex::TestBatchRunner tc;
+    QTEST_SET_MAIN_SOURCE_PATH
+    return QTest::qExec(&tc, argc, argv);
+}
+#include "tst_batchrunner.moc"
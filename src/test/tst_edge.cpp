@@ -36,6 +36,7 @@ private slots:
     void tst_edge1();
     void tst_edge2();
     void tst_edge3();
+    void tst_reverseEdge();
 
 private:
     Node m_nodeA;
@@ -94,13 +95,23 @@ void TestEdge::tst_edge1()
     QCOMPARE(edge.id(), 0);
     QCOMPARE(edge.origin().id(), m_nodeA.id());
     QCOMPARE(edge.neighbour().id(), m_nodeB.id());
+    QVERIFY(edge.origin() == m_nodeA);
+    QVERIFY(edge.neighbour() == m_nodeB);
+
+    // Tests that the edge does not own its nodes
+    BaseNode::constructor_key nodeKey;
+    NodePtr node = std::make_shared<UNode>(nodeKey, 7, Attributes());
+    BaseEdge loop(key, 1, Node(node), Node(node));
+    QCOMPARE(node.use_count(), 1L);
+    QCOMPARE(loop.origin().id(), 7);
+    QCOMPARE(node.use_count(), 1L);
 }
 
 void TestEdge::tst_edge2()
 {
     // Tests method 2: adding attributes in constructor
-    Attributes* attrs = new Attributes();
-    attrs->push_back("test0", Value(123));
+    Attributes attrs;
+    attrs.push_back("test0", Value(123));
     BaseEdge::constructor_key key;
     BaseEdge edge(key, 1, m_nodeA, m_nodeB, attrs);
 
@@ -139,11 +150,13 @@ void TestEdge::tst_edge2()
 
 void TestEdge::tst_edge3()
 {
-    // Tests method 3: adding attributes in constructor, with ownsAttrs = true
-    Attributes* attrs = new Attributes();
-    attrs->push_back("test0", Value(123));
-    BaseEdge::constructor_key key;
-    BaseEdge edge(key, 1, m_nodeA, m_nodeB, attrs, true);
+    // Tests method 3: creating the edge in a pool
+    Attributes attrs;
+    attrs.push_back("test0", Value(123));
+    EdgeArena arena;
+    BaseEdge& edge = *arena.create(1, m_nodeA, m_nodeB, attrs);
+    QCOMPARE(arena.size(), size_t(1));
+    QCOMPARE(arena.capacity(), EdgeArena::kBlockSize);
 
     QVERIFY(!edge.attrs()->isEmpty());
     QVERIFY(edge.attrs()->size() == 1);
@@ -176,6 +189,53 @@ void TestEdge::tst_edge3()
     QCOMPARE(edge.id(), 1);
     QCOMPARE(edge.origin().id(), m_nodeA.id());
     QCOMPARE(edge.neighbour().id(), m_nodeB.id());
+
+    // the destroyed records are reused
+    BaseEdge* ptr = &edge;
+    arena.destroy(ptr);
+    QCOMPARE(arena.size(), size_t(0));
+    std::vector<BaseEdge*> records;
+    records.emplace_back(arena.create(2, m_nodeB, m_nodeA, Attributes()));
+    QCOMPARE(records.front(), ptr);
+    for (int id = 3; id < static_cast<int>(EdgeArena::kBlockSize) + 3; ++id) {
+        records.emplace_back(arena.create(id, m_nodeA, m_nodeB, Attributes()));
+    }
+    QCOMPARE(arena.capacity(), 2 * EdgeArena::kBlockSize);
+    QCOMPARE(ptr->id(), 2); // records never move
+    QCOMPARE(ptr->origin().id(), m_nodeB.id());
+
+    // records must be destroyed before the pool
+    for (BaseEdge* e : records) {
+        arena.destroy(e);
+    }
+    arena.release();
+    QCOMPARE(arena.capacity(), size_t(0));
+}
+
+void TestEdge::tst_reverseEdge()
+{
+    // both directions of an edge share the same record
+    BaseEdge::constructor_key key;
+    BaseEdge record(key, 2, m_nodeA, m_nodeB);
+    Edge edge(&record);
+    Edge reverse(&record, true);
+    QVERIFY(reverse.attrs()->empty());
+
+    QCOMPARE(reverse.id(), 2);
+    QCOMPARE(reverse.origin().id(), m_nodeB.id());
+    QCOMPARE(reverse.neighbour().id(), m_nodeA.id());
+    QCOMPARE(edge.origin().id(), m_nodeA.id());
+    QCOMPARE(edge.neighbour().id(), m_nodeB.id());
+
+    // the attributes added to any direction are shared
+    reverse.addAttr("test0", Value(123));
+    QCOMPARE(edge.attr("test0"), Value(123));
+    edge.setAttr(0, Value(234));
+    QCOMPARE(reverse.attr(0), Value(234));
+    QCOMPARE(reverse.attrs(), edge.attrs());
+
+    QVERIFY(Edge().isNull());
+    QVERIFY(!reverse.isNull());
 }
 
 } // evoplex
@@ -0,0 +1,338 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QtTest>
+#include <core/experimentsmgr.h>
+
+#include "testutils.h"
+
+namespace evoplex {
+class TestExperiment: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    // the progress adds up the steps of all trials and ends at 360
+    void tst_progress();
+    // the trials start from trial 0's state at the fork point, then diverge;
+    // they start from scratch if trial 0 ends before it
+    void tst_fork();
+    // the trials only start while their memory fits in the budget
+    void tst_memory();
+    // the running trials give way to the queued ones which could start
+    void tst_timeSlice();
+    // the trials of a delayed experiment wait out of the workers
+    void tst_delay();
+
+private:
+    static const int kTimeout = 10000; // msec
+
+    MainApp* m_mainApp;
+    ProjectPtr m_project;
+    int m_lastExpId;
+
+    // creates the trials of a new experiment and plays them until 'pauseAt'
+    ExperimentPtr _play(QMap<QString, QString> attrs, int pauseAt);
+    // 'numTrials' trials of 'numNodes' nodes which run until 'stopAt'
+    QMap<QString, QString> _attrs(int numNodes, int stopAt, int numTrials=1) const;
+    // the 'infected' attribute of the nodes of a populationGrowth trial
+    std::vector<bool> _infected(const Trial* trial) const;
+};
+
+void TestExperiment::initTestCase()
+{
+    m_mainApp = new MainApp();
+    TestUtils::loadPlugins(m_mainApp);
+    QString error;
+    m_project = m_mainApp->newProject(error);
+    QVERIFY2(m_project, qPrintable(error));
+    m_lastExpId = -1;
+}
+
+void TestExperiment::cleanupTestCase()
+{
+    m_project.reset();
+    delete m_mainApp;
+}
+
+ExperimentPtr TestExperiment::_play(QMap<QString, QString> attrs, int pauseAt)
+{
+    attrs.insert(GENERAL_ATTR_EXPID, QString::number(++m_lastExpId));
+    ExperimentPtr exp = TestUtils::newExperiment(m_mainApp, m_project, attrs);
+    return TestUtils::play(exp, pauseAt) ? exp : nullptr;
+}
+
+QMap<QString, QString> TestExperiment::_attrs(int numNodes, int stopAt, int numTrials) const
+{
+    auto attrs = TestUtils::generalAttrs(0, "populationGrowth", "zeroEdges");
+    attrs.insert(GENERAL_ATTR_NODES, QString("*%1;min").arg(numNodes));
+    attrs.insert(GENERAL_ATTR_STOPAT, QString::number(stopAt));
+    attrs.insert(GENERAL_ATTR_TRIALS, QString::number(numTrials));
+    attrs.insert("populationGrowth_prob", "0.1");
+    return attrs;
+}
+
+std::vector<bool> TestExperiment::_infected(const Trial* trial) const
+{
+    std::vector<bool> infected;
+    for (auto const& p : trial->graph()->nodes()) {
+        infected.emplace_back(p.second.attr("infected").toBool());
+    }
+    return infected;
+}
+
+void TestExperiment::tst_progress()
+{
+    ExperimentPtr exp = _play(_attrs(100, 50, 4), 25);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 25), kTimeout);
+    QCOMPARE(exp->progress(), quint16(180));
+    exp->play();
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    QCOMPARE(exp->progress(), quint16(360));
+
+    // the trials converge long before the last step; nothing changes
+    // without edges. The remaining steps still count as done
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto attrs = _attrs(100, 1000, 3);
+    attrs.insert(GENERAL_ATTR_STOPWHEN, "unchanged_5");
+    attrs.insert(OUTPUT_DIR, dir.path());
+    attrs.insert(OUTPUT_HEADER, "count_nodes_infected_true");
+    exp = _play(attrs, 1000);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    QCOMPARE(exp->progress(), quint16(360));
+    for (quint16 id = 0; id < exp->numTrials(); ++id) {
+        QVERIFY(exp->trial(id)->step() < 1000);
+    }
+
+    // likewise, when they are stopped
+    exp = _play(_attrs(100, EVOPLEX_MAX_STEPS, 2), EVOPLEX_MAX_STEPS);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(exp->trial(0)->step() > 0, kTimeout);
+    exp->stop();
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    QCOMPARE(exp->progress(), quint16(360));
+}
+
+void TestExperiment::tst_fork()
+{
+    // a grid with half of the nodes infected; the infection spreads slowly
+    auto attrs = _attrs(100, 30, 3);
+    attrs.insert(GENERAL_ATTR_NODES, "*100;rand_0");
+    attrs.insert(GENERAL_ATTR_GRAPHID, "squareGrid");
+    attrs.insert(GENERAL_ATTR_FORKAT, "10");
+    attrs.insert("squareGrid_neighbours", "4");
+    attrs.insert("squareGrid_height", "10");
+    attrs.insert("squareGrid_width", "10");
+    attrs.insert("squareGrid_boundary", "periodic");
+    attrs.insert("populationGrowth_prob", "0.05");
+
+    ExperimentPtr exp = _play(attrs, 10);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 10), kTimeout);
+    const std::vector<bool> forkPoint = _infected(exp->trial(0));
+    QCOMPARE(forkPoint.size(), size_t(100));
+    QCOMPARE(_infected(exp->trial(1)), forkPoint);
+    QCOMPARE(_infected(exp->trial(2)), forkPoint);
+
+    exp->play();
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    std::vector<std::vector<bool>> last;
+    for (quint16 id = 0; id < 3; ++id) {
+        QCOMPARE(exp->trial(id)->step(), 30);
+        last.emplace_back(_infected(exp->trial(id)));
+    }
+    QVERIFY(last[0] != last[1] && last[0] != last[2] && last[1] != last[2]);
+
+    // the seeds of the forked trials are derived from the experiment's
+    exp = _play(attrs, 30);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    for (quint16 id = 0; id < 3; ++id) {
+        QCOMPARE(_infected(exp->trial(id)), last[id]);
+    }
+
+    // trial 0 converges long before the fork point; nothing changes without
+    // edges. The other trials start from scratch instead of waiting for it
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    attrs = _attrs(100, 1000, 3);
+    attrs.insert(GENERAL_ATTR_FORKAT, "500");
+    attrs.insert(GENERAL_ATTR_STOPWHEN, "unchanged_5");
+    attrs.insert(OUTPUT_DIR, dir.path());
+    attrs.insert(OUTPUT_HEADER, "count_nodes_infected_true");
+    exp = _play(attrs, 1000);
+    QVERIFY(exp);
+    QTRY_VERIFY_WITH_TIMEOUT(exp->expStatus() == Status::Finished, kTimeout);
+    for (quint16 id = 0; id < 3; ++id) {
+        QVERIFY(exp->trial(id)->step() < 500);
+    }
+}
+
+void TestExperiment::tst_memory()
+{
+    ExperimentsMgr* expMgr = m_mainApp->expMgr();
+    const int threads = expMgr->maxThreadsCount();
+    const qint64 reserved = expMgr->memoryReserved(); // by the trials of the other tests
+    expMgr->setMaxThreadCount(2, nullptr, false);
+    expMgr->setMemoryBudget(1, false);
+    QSignalSpy waitingSpy(expMgr, &ExperimentsMgr::trialsWaiting);
+
+    // a trial larger than the budget still runs if nothing else does
+    ExperimentPtr big = _play(_attrs(100000, 5), 5);
+    QVERIFY(big);
+    QTRY_VERIFY_WITH_TIMEOUT(big->expStatus() == Status::Finished, kTimeout);
+    QVERIFY(expMgr->memoryReserved() - reserved > (qint64(1) << 20));
+
+    // its memory is released with the trial
+    QString error;
+    QVERIFY2(m_project->removeExperiment(big->id(), error), qPrintable(error));
+    QTRY_COMPARE_WITH_TIMEOUT(expMgr->memoryReserved(), reserved, kTimeout);
+
+    // but two of them run one at a time, even with two threads
+    ExperimentPtr endless = _play(_attrs(100000, EVOPLEX_MAX_STEPS, 2), EVOPLEX_MAX_STEPS);
+    QVERIFY(endless);
+    auto numRunning = [&endless]() {
+        int n = 0;
+        for (quint16 id = 0; id < 2; ++id) {
+            if (endless->trial(id)->status() == Status::Running) ++n;
+        }
+        return n;
+    };
+    QTRY_COMPARE_WITH_TIMEOUT(numRunning(), 1, kTimeout);
+    auto isWaiting = [&waitingSpy, &endless]() {
+        for (int i = 0; i < waitingSpy.count(); ++i) {
+            if (waitingSpy.at(i).at(0).toInt() == endless->id()) return true;
+        }
+        return false;
+    };
+    QTRY_VERIFY_WITH_TIMEOUT(isWaiting(), kTimeout);
+    QElapsedTimer t;
+    t.start();
+    while (t.elapsed() < 100) {
+        QCOMPARE(numRunning(), 1);
+    }
+
+    // a larger budget lets the other one in
+    expMgr->setMemoryBudget(0, false);
+    QTRY_COMPARE_WITH_TIMEOUT(numRunning(), 2, kTimeout);
+
+    endless->pause();
+    QTRY_VERIFY_WITH_TIMEOUT(endless->expStatus() == Status::Paused, kTimeout);
+    // the experiments are taken out of the running ones right after pausing
+    auto restoreThreads = [expMgr, threads]() {
+        expMgr->setMaxThreadCount(threads, nullptr, false);
+        return expMgr->maxThreadsCount() == threads;
+    };
+    QTRY_VERIFY_WITH_TIMEOUT(restoreThreads(), kTimeout);
+}
+
+void TestExperiment::tst_timeSlice()
+{
+    ExperimentsMgr* expMgr = m_mainApp->expMgr();
+    const int threads = expMgr->maxThreadsCount();
+    expMgr->setMaxThreadCount(1, nullptr, false);
+    expMgr->setTimeSlice(1, false);
+
+    // it would take the only worker forever
+    ExperimentPtr endless = _play(_attrs(100, EVOPLEX_MAX_STEPS), EVOPLEX_MAX_STEPS);
+    QVERIFY(endless);
+    QTRY_VERIFY_WITH_TIMEOUT(endless->trial(0)->status() == Status::Running, kTimeout);
+
+    // but it gives way to a queued trial
+    ExperimentPtr shortRun = _play(_attrs(100, 20), 10);
+    QVERIFY(shortRun);
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(shortRun, 10), kTimeout);
+    QVERIFY(endless->expStatus() == Status::Running);
+
+    // not to a trial which is waiting for memory, though
+    expMgr->setMemoryBudget(1, false);
+    QSignalSpy waitingSpy(expMgr, &ExperimentsMgr::trialsWaiting);
+    ExperimentPtr waiting = _play(_attrs(100000, 10), 10);
+    QVERIFY(waiting);
+    QTRY_COMPARE_WITH_TIMEOUT(waitingSpy.count(), 1, kTimeout);
+    QVERIFY(!expMgr->timeSliceExpired(kTimeout));
+    QElapsedTimer t;
+    t.start();
+    while (t.elapsed() < 100) {
+        QVERIFY(endless->trial(0)->status() == Status::Running);
+    }
+    QVERIFY(waiting->trial(0)->status() == Status::Queued);
+
+    // the waiting trial is dropped once its experiment is paused
+    waiting->pause();
+    endless->pause();
+    QTRY_VERIFY_WITH_TIMEOUT(endless->expStatus() == Status::Paused, kTimeout);
+    QTRY_VERIFY_WITH_TIMEOUT(waiting->expStatus() == Status::Paused, kTimeout);
+    QVERIFY(waiting->trial(0)->step() == 0);
+
+    expMgr->setMemoryBudget(0, false);
+    expMgr->setTimeSlice(0, false);
+    // the experiments are taken out of the running ones right after pausing
+    auto restoreThreads = [expMgr, threads]() {
+        expMgr->setMaxThreadCount(threads, nullptr, false);
+        return expMgr->maxThreadsCount() == threads;
+    };
+    QTRY_VERIFY_WITH_TIMEOUT(restoreThreads(), kTimeout);
+}
+
+void TestExperiment::tst_delay()
+{
+    // much longer than the timeouts below
+    const quint16 delay = 60000;
+
+    auto attrs = _attrs(100, 20);
+    attrs.insert(GENERAL_ATTR_EXPID, QString::number(++m_lastExpId));
+    ExperimentPtr exp = TestUtils::newExperiment(m_mainApp, m_project, attrs);
+    QVERIFY(exp);
+    exp->setDelay(delay);
+    QVERIFY(TestUtils::play(exp, 20));
+    const Trial* trial = exp->trial(0);
+    QTRY_VERIFY_WITH_TIMEOUT(trial->step() == 1 && trial->status() == Status::Queued, kTimeout);
+
+    // it does not wait out the delay to pause
+    exp->pause();
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 1), 2000);
+
+    // the trial is resumed after each delay
+    exp->setDelay(1);
+    exp->setPauseAt(5);
+    exp->play();
+    QTRY_VERIFY_WITH_TIMEOUT(TestUtils::isPaused(exp, 5), kTimeout);
+
+    // a removed experiment drops its delayed trial and deletes it
+    exp->setDelay(delay);
+    exp->setPauseAt(20);
+    exp->play();
+    QTRY_VERIFY_WITH_TIMEOUT(trial->step() == 6 && trial->status() == Status::Queued, kTimeout);
+    QString error;
+    QVERIFY2(m_project->removeExperiment(exp->id(), error), qPrintable(error));
+    QTRY_VERIFY_WITH_TIMEOUT(exp->trials().empty(), 2000);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestExperiment)
+#include "tst_experiment.moc"
@@ -0,0 +1,302 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/include/attributerange.h>
+#include <core/include/enum.h>
+#include <core/include/idmap.h>
+#include <core/include/nodes.h>
+#include <core/include/prg.h>
+#include <core/nodes_p.h>
+
+namespace evoplex {
+class TestIdMap: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    void tst_dense();
+    void tst_erase();
+    void tst_sparse();
+    void tst_squeeze();
+    void tst_randElement();
+
+private:
+    Nodes m_nodes; // 100 nodes with ids 0..99
+    // checks that the iteration matches the expected ids
+    void _compareIds(const IdMap<Node>& map, const std::vector<int>& ids);
+};
+
+void TestIdMap::initTestCase()
+{
+    QString error;
+    m_nodes = NodesPrivate::fromCmd("*100;min", AttributesScope(),
+                                    GraphType::Undirected, error);
+    QCOMPARE(m_nodes.size(), size_t(100));
+}
+
+void TestIdMap::_compareIds(const IdMap<Node>& map, const std::vector<int>& ids)
+{
+    QCOMPARE(map.size(), ids.size());
+    size_t i = 0;
+    for (auto const& p : map) {
+        QCOMPARE(p.first, ids.at(i));
+        QCOMPARE(p.second.id(), ids.at(i));
+        QCOMPARE(map.nth(i).first, ids.at(i));
+        ++i;
+    }
+    QCOMPARE(i, ids.size());
+}
+
+void TestIdMap::tst_dense()
+{
+    IdMap<Node> map;
+    QVERIFY(map.empty());
+    QVERIFY(map.isDense());
+    QVERIFY(map.begin() == map.end());
+
+    std::vector<int> ids;
+    for (int id = 0; id < 10; ++id) {
+        QVERIFY(map.insert({id, m_nodes.at(id)}).second);
+        ids.emplace_back(id);
+    }
+    QVERIFY(map.isDense());
+    QCOMPARE(map.numSlots(), size_t(10));
+    _compareIds(map, ids);
+
+    // the slot of each element is its id
+    for (int id = 0; id < 10; ++id) {
+        QCOMPARE(map.slot(static_cast<size_t>(id)).first, id);
+        QCOMPARE(map.at(id), m_nodes.at(id));
+    }
+
+    // duplicated ids are not inserted
+    auto ret = map.insert({5, m_nodes.at(50)});
+    QVERIFY(!ret.second);
+    QCOMPARE(ret.first->second, m_nodes.at(5));
+    QCOMPARE(map.size(), size_t(10));
+
+    QVERIFY_EXCEPTION_THROWN(map.at(-1), std::out_of_range);
+    QVERIFY_EXCEPTION_THROWN(map.at(10), std::out_of_range);
+    QVERIFY(map.find(10) == map.end());
+    QCOMPARE(map.count(9), size_t(1));
+
+    map.clear();
+    QVERIFY(map.empty());
+    QVERIFY(map.isDense());
+}
+
+void TestIdMap::tst_erase()
+{
+    IdMap<Node> map;
+    std::vector<int> ids;
+    for (int id = 0; id < 10; ++id) {
+        map.insert({id, m_nodes.at(id)});
+    }
+
+    // removals leave tombstones, so the container stays dense
+    QCOMPARE(map.erase(3), size_t(1));
+    QCOMPARE(map.erase(3), size_t(0));
+    QVERIFY(map.isDense());
+    QCOMPARE(map.size(), size_t(9));
+    QCOMPARE(map.numSlots(), size_t(10));
+    QVERIFY(map.slot(3).second.isNull());
+    QVERIFY_EXCEPTION_THROWN(map.at(3), std::out_of_range);
+    _compareIds(map, {0, 1, 2, 4, 5, 6, 7, 8, 9});
+
+    // removing while iterating
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->first % 2) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _compareIds(map, {0, 2, 4, 6, 8});
+
+    // the tombstone is reused
+    QVERIFY(map.insert({3, m_nodes.at(3)}).second);
+    QVERIFY(map.isDense());
+    QCOMPARE(map.numSlots(), size_t(10));
+    _compareIds(map, {0, 2, 3, 4, 6, 8});
+
+    // packing a dense container only happens when most slots are empty
+    map.squeeze();
+    QVERIFY(map.isDense());
+    map.erase(0);
+    map.erase(2);
+    map.squeeze();
+    QVERIFY(!map.isDense());
+    QCOMPARE(map.numSlots(), size_t(4));
+    _compareIds(map, {3, 4, 6, 8});
+}
+
+void TestIdMap::tst_sparse()
+{
+    IdMap<Node> map;
+    // the first id is not zero
+    map.insert({5, m_nodes.at(5)});
+    QVERIFY(!map.isDense());
+    map.insert({2, m_nodes.at(2)});
+    map.insert({90, m_nodes.at(90)});
+    _compareIds(map, {5, 2, 90}); // insertion order
+    QCOMPARE(map.at(90), m_nodes.at(90));
+    QVERIFY(!map.insert({2, m_nodes.at(2)}).second);
+
+    // beyond the linear scan
+    std::vector<int> ids = {5, 2, 90};
+    for (int id = 10; id < 50; ++id) {
+        map.insert({id, m_nodes.at(id)});
+        ids.emplace_back(id);
+    }
+    _compareIds(map, ids);
+    for (int id : ids) {
+        QCOMPARE(map.at(id), m_nodes.at(id));
+    }
+
+    // a copy is independent
+    IdMap<Node> copy = map;
+    copy.erase(5);
+    QCOMPARE(map.count(5), size_t(1));
+    QCOMPARE(copy.count(5), size_t(0));
+
+    // too many tombstones; they are dropped on the next insertion
+    for (int id = 10; id < 50; ++id) {
+        map.erase(id);
+    }
+    QCOMPARE(map.size(), size_t(3));
+    map.insert({99, m_nodes.at(99)});
+    QCOMPARE(map.numSlots(), size_t(4));
+    _compareIds(map, {5, 2, 90, 99});
+    QVERIFY_EXCEPTION_THROWN(map.at(20), std::out_of_range);
+
+    // an id re-inserted within the linear scan is still found once the
+    // index is built, i.e., its tombstone is left out of the index
+    IdMap<Node> reinserted;
+    for (int id = 100; id < 110; ++id) {
+        reinserted.insert({id, m_nodes.at(id - 100)});
+    }
+    reinserted.erase(105);
+    reinserted.insert({105, m_nodes.at(5)});
+    for (int id = 110; id < 120; ++id) {
+        reinserted.insert({id, m_nodes.at(id - 100)});
+    }
+    QCOMPARE(reinserted.size(), size_t(20));
+    for (int id = 100; id < 120; ++id) {
+        QCOMPARE(reinserted.at(id), m_nodes.at(id - 100));
+    }
+}
+
+void TestIdMap::tst_squeeze()
+{
+    // a sparse container goes back to the dense mode once the ids fit
+    IdMap<Node> map;
+    map.insert({5, m_nodes.at(5)});
+    std::vector<int> ids = {5};
+    for (int id = 0; id < 40; ++id) {
+        if (id != 5) {
+            map.insert({id, m_nodes.at(id)});
+            ids.emplace_back(id);
+        }
+    }
+    QVERIFY(!map.isDense());
+    _compareIds(map, ids);
+    map.squeeze();
+    QVERIFY(map.isDense());
+    QCOMPARE(map.numSlots(), size_t(40));
+    std::sort(ids.begin(), ids.end());
+    _compareIds(map, ids); // the id order
+    for (int id : ids) {
+        QCOMPARE(map.at(id), m_nodes.at(id));
+        QCOMPARE(map.slot(static_cast<size_t>(id)).first, id);
+    }
+
+    // the tombstones at the end are dropped
+    IdMap<Node> sparse = map;
+    sparse.insert({90, m_nodes.at(90)});
+    QVERIFY(!sparse.isDense());
+    for (int id = 30; id < 40; ++id) {
+        sparse.erase(id);
+    }
+    sparse.erase(90);
+    sparse.squeeze();
+    QVERIFY(sparse.isDense());
+    QCOMPARE(sparse.numSlots(), size_t(30));
+
+    // a fragmented container stays dense if at most half of it is empty
+    for (int id = 0; id < 40; id += 2) {
+        map.erase(id);
+    }
+    map.insert({90, m_nodes.at(90)});
+    map.erase(90);
+    QVERIFY(!map.isDense());
+    map.squeeze();
+    QVERIFY(map.isDense());
+    QCOMPARE(map.size(), size_t(20));
+    QCOMPARE(map.numSlots(), size_t(40));
+    QVERIFY(map.slot(0).second.isNull());
+    QCOMPARE(map.at(39), m_nodes.at(39));
+    QVERIFY(map.insert({40, m_nodes.at(40)}).second);
+    QVERIFY(map.isDense());
+
+    // but not if most of it would be empty
+    map.erase(1);
+    map.erase(3);
+    map.squeeze();
+    QVERIFY(!map.isDense());
+    QCOMPARE(map.numSlots(), size_t(19));
+    QCOMPARE(map.at(40), m_nodes.at(40));
+    QVERIFY_EXCEPTION_THROWN(map.at(1), std::out_of_range);
+}
+
+void TestIdMap::tst_randElement()
+{
+    IdMap<Node> map;
+    for (int id = 0; id < 10; ++id) {
+        map.insert({id, m_nodes.at(id)});
+    }
+    for (int id = 0; id < 10; id += 3) {
+        map.erase(id);
+    }
+
+    // it never returns a tombstone and reaches all elements
+    PRG prg(0);
+    std::vector<int> hits(10, 0);
+    for (int i = 0; i < 1000; ++i) {
+        const auto& p = map.randElement([&prg](size_t n) { return prg.uniform(static_cast<int>(n)); });
+        QVERIFY(!p.second.isNull());
+        QCOMPARE(p.second.id(), p.first);
+        ++hits.at(static_cast<size_t>(p.first));
+    }
+    for (int id = 0; id < 10; ++id) {
+        QCOMPARE(hits.at(static_cast<size_t>(id)) > 0, id % 3 != 0);
+    }
+
+    // the draws skip the tombstones
+    size_t next = 0;
+    QCOMPARE(map.randElement([&next](size_t) { return next++; }).first, 1);
+    QCOMPARE(next, size_t(2));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestIdMap)
+#include "tst_idmap.moc"
@@ -0,0 +1,160 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <algorithm>
+#include <core/include/lattice.h>
+
+namespace evoplex {
+class TestLattice: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_invalid();
+    void tst_fixed();
+    void tst_periodic();
+    void tst_directed();
+    void tst_forEachEdge();
+    void tst_forEachEdgeRows();
+
+private:
+    // gets the sorted ids of the neighbours
+    std::vector<int> _ids(const Neighbours& nbs) const;
+};
+
+std::vector<int> TestLattice::_ids(const Neighbours& nbs) const
+{
+    std::vector<int> ids(nbs.begin(), nbs.end());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void TestLattice::tst_invalid()
+{
+    const std::vector<Lattice::Offset> vonNeumann = {{-1, 0}, {0, -1}};
+    QVERIFY_EXCEPTION_THROWN(Lattice(0, 3, vonNeumann, true, false), std::invalid_argument);
+    QVERIFY_EXCEPTION_THROWN(Lattice(3, -1, vonNeumann, true, false), std::invalid_argument);
+
+    // the neighbours must fit in Neighbours
+    std::vector<Lattice::Offset> large;
+    for (int i = 1; i <= Neighbours::kMaxInline; ++i) {
+        large.push_back({0, i});
+    }
+    QVERIFY_EXCEPTION_THROWN(Lattice(20, 20, large, true, false), std::invalid_argument);
+
+    const Lattice l(3, 3, vonNeumann, true, false);
+    QVERIFY_EXCEPTION_THROWN(l.outNeighbours(-1), std::out_of_range);
+    QVERIFY_EXCEPTION_THROWN(l.inNeighbours(9), std::out_of_range);
+}
+
+void TestLattice::tst_fixed()
+{
+    // 0 1 2
+    // 3 4 5
+    const Lattice l(3, 2, {{-1, 0}, {0, -1}}, false, false);
+    QCOMPARE(l.numNodes(), 6);
+    QCOMPARE(l.numEdges(), 7);
+
+    QCOMPARE(_ids(l.outNeighbours(0)), std::vector<int>({1, 3}));
+    QCOMPARE(_ids(l.outNeighbours(4)), std::vector<int>({1, 3, 5}));
+    QCOMPARE(_ids(l.inNeighbours(4)), std::vector<int>({1, 3, 5}));
+    QCOMPARE(l.outNeighbours(5).size(), 2);
+
+    // there are no edge records
+    QCOMPARE(l.outNeighbours(4).edgeId(0), -1);
+}
+
+void TestLattice::tst_periodic()
+{
+    // 0 1 2
+    // 3 4 5
+    // 6 7 8
+    const Lattice l(3, 3, {{-1, 0}, {0, -1}}, true, false);
+    QCOMPARE(l.numEdges(), 18);
+    QCOMPARE(_ids(l.outNeighbours(0)), std::vector<int>({1, 2, 3, 6}));
+    QCOMPARE(_ids(l.outNeighbours(4)), std::vector<int>({1, 3, 5, 7}));
+    QCOMPARE(_ids(l.outNeighbours(8)), std::vector<int>({2, 5, 6, 7}));
+
+    // moore neighbourhood
+    const Lattice m(3, 3, {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}}, true, false);
+    QCOMPARE(m.numEdges(), 36);
+    QCOMPARE(_ids(m.outNeighbours(4)), std::vector<int>({0, 1, 2, 3, 5, 6, 7, 8}));
+}
+
+void TestLattice::tst_directed()
+{
+    // a directed cycle: 0 -> 1 -> 2 -> 3 -> 0
+    const Lattice l(4, 1, {{0, 1}}, true, true);
+    QVERIFY(l.isDirected());
+    QCOMPARE(l.numEdges(), 4);
+    QCOMPARE(_ids(l.outNeighbours(3)), std::vector<int>({0}));
+    QCOMPARE(_ids(l.inNeighbours(0)), std::vector<int>({3}));
+    QCOMPARE(_ids(l.inNeighbours(2)), std::vector<int>({1}));
+
+    // a directed path: 0 -> 1 -> 2
+    const Lattice p(3, 1, {{0, 1}}, false, true);
+    QCOMPARE(p.numEdges(), 2);
+    QCOMPARE(p.outNeighbours(2).size(), 0);
+    QCOMPARE(p.inNeighbours(0).size(), 0);
+}
+
+void TestLattice::tst_forEachEdge()
+{
+    const Lattice l(2, 2, {{-1, 0}, {0, -1}}, false, false);
+    std::vector<std::pair<int, int>> edges;
+    l.forEachEdge([&edges](int originId, int neighbourId) {
+        edges.push_back({originId, neighbourId});
+    });
+
+    // sorted by origin and then by offset
+    const std::vector<std::pair<int, int>> expected = {{1, 0}, {2, 0}, {3, 1}, {3, 2}};
+    QCOMPARE(edges, expected);
+    QCOMPARE(static_cast<int>(edges.size()), l.numEdges());
+}
+
+void TestLattice::tst_forEachEdgeRows()
+{
+    const Lattice l(3, 4, {{-1, 0}, {0, -1}}, true, false);
+    std::vector<std::pair<int, int>> all;
+    l.forEachEdge([&all](int originId, int neighbourId) {
+        all.push_back({originId, neighbourId});
+    });
+
+    // the chunks of rows add up to the whole lattice, in the same order
+    std::vector<std::pair<int, int>> chunks;
+    for (int firstRow = 0; firstRow < l.height(); firstRow += 3) {
+        l.forEachEdge([&chunks](int originId, int neighbourId) {
+            chunks.push_back({originId, neighbourId});
+        }, firstRow, firstRow + 3);
+    }
+    QCOMPARE(chunks, all);
+
+    // the rows out of the lattice are ignored
+    int count = 0;
+    l.forEachEdge([&count](int, int) { ++count; }, -2, 1);
+    QCOMPARE(count, 6);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestLattice)
+#include "tst_lattice.moc"
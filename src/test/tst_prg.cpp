@@ -32,6 +32,7 @@ private slots:
     void initTestCase() {}
     void cleanupTestCase() {}
     void tst_prg();
+    void tst_state();
     void tst_bernoulli();
     void tst_uniformDouble();
     void tst_uniformInt();
@@ -67,6 +68,26 @@ void TestPRG::tst_prg()
     QCOMPARE(prg4->uniform(10), prg5->uniform(10));
 }
 
+void TestPRG::tst_state()
+{
+    PRG prg1(921);
+    for (int i = 0; i < 1000; ++i) prg1.uniform();
+    const std::string state = prg1.state();
+
+    // it continues the sequence, but keeps its own seed
+    PRG prg2(0);
+    QVERIFY(prg2.setState(state));
+    QCOMPARE(prg2.seed(), 0u);
+    QCOMPARE(prg1.uniform(), prg2.uniform());
+    QCOMPARE(prg1.uniform(123), prg2.uniform(123));
+    QCOMPARE(prg1.bernoulli(), prg2.bernoulli());
+
+    // an invalid state is ignored
+    const double d = PRG(prg2).uniform();
+    QVERIFY(!prg2.setState("abc"));
+    QCOMPARE(prg2.uniform(), d);
+}
+
 void TestPRG::tst_bernoulli()
 {
     auto prg = std::unique_ptr<PRG>(new PRG(0));
@@ -0,0 +1,116 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/stopcondition.h>
+
+namespace evoplex {
+class TestStopCondition: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_parse();
+    void tst_unchanged();
+    void tst_variance();
+};
+
+void TestStopCondition::tst_parse()
+{
+    QString error;
+    StopCondition cond = StopCondition::parse("", error);
+    QCOMPARE(cond.type(), StopCondition::Type::None);
+    QVERIFY(error.isEmpty());
+
+    cond = StopCondition::parse("unchanged_100", error);
+    QCOMPARE(cond.type(), StopCondition::Type::Unchanged);
+    QCOMPARE(cond.window(), 100);
+    QVERIFY(error.isEmpty());
+
+    cond = StopCondition::parse("variance_50_0.01", error);
+    QCOMPARE(cond.type(), StopCondition::Type::Variance);
+    QCOMPARE(cond.window(), 50);
+    QCOMPARE(cond.epsilon(), 0.01);
+    QVERIFY(error.isEmpty());
+
+    const QStringList invalid = { "unchanged", "unchanged_0", "unchanged_a", "unchanged_1_2",
+                                  "variance_10", "variance_10_-1", "variance_10_a", "abc_10" };
+    for (const QString& cmd : invalid) {
+        error.clear();
+        cond = StopCondition::parse(cmd, error);
+        QCOMPARE(cond.type(), StopCondition::Type::None);
+        QVERIFY(!error.isEmpty());
+    }
+}
+
+void TestStopCondition::tst_unchanged()
+{
+    QString error;
+    ConvergenceMonitor monitor(StopCondition::parse("unchanged_3", error));
+
+    QVERIFY(!monitor.update({ Value(1), Value("a") }));
+    QVERIFY(!monitor.update({ Value(1), Value("a") }));
+    QVERIFY(!monitor.update({ Value(1), Value("a") }));
+    // any change starts it over
+    QVERIFY(!monitor.update({ Value(1), Value("b") }));
+    QVERIFY(!monitor.update({ Value(1), Value("b") }));
+    QVERIFY(!monitor.update({ Value(1), Value("b") }));
+    QVERIFY(monitor.update({ Value(1), Value("b") }));
+
+    monitor.reset();
+    QVERIFY(!monitor.update({ Value(1), Value("b") }));
+
+    // nothing converges without values
+    QVERIFY(!monitor.update(Values()));
+}
+
+void TestStopCondition::tst_variance()
+{
+    QString error;
+    ConvergenceMonitor monitor(StopCondition::parse("variance_4_0.25", error));
+
+    // it needs a full window
+    QVERIFY(!monitor.update({ Value(100), Value(0.5) }));
+    QVERIFY(!monitor.update({ Value(101), Value(0.5) }));
+    QVERIFY(!monitor.update({ Value(100), Value(0.5) }));
+    QVERIFY(monitor.update({ Value(101), Value(0.5) })); // var = 0.25
+
+    // the oldest values leave the window
+    QVERIFY(!monitor.update({ Value(110), Value(0.5) }));
+    QVERIFY(!monitor.update({ Value(110), Value(0.5) }));
+    QVERIFY(!monitor.update({ Value(110), Value(0.5) }));
+    QVERIFY(monitor.update({ Value(110), Value(0.5) })); // var = 0
+
+    // all values must meet it
+    QVERIFY(!monitor.update({ Value(110), Value(9.5) }));
+
+    // only numbers have a variance
+    monitor.reset();
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(!monitor.update({ Value("a") }));
+    }
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestStopCondition)
+#include "tst_stopcondition.moc"
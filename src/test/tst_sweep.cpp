@@ -0,0 +1,82 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *  Copyright (C) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <core/sweep.h>
+
+namespace evoplex {
+class TestSweep: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_count();
+    void tst_space();
+};
+
+void TestSweep::tst_count()
+{
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "int[-1,3]")), qint64(5));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "int{5,1,3}")), qint64(3));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "string{a,b}")), qint64(2));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "double{0.1,0.2}")), qint64(2));
+    // the intervals are visited in steps of 1
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "double[0,2.5]")), qint64(4));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "double[0,2]")), qint64(3));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "double[1,1]")), qint64(1));
+
+    // they cannot be swept
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "int{1,2,1}")), qint64(0));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "bool")), qint64(0));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "string")), qint64(0));
+    QCOMPARE(SweepSpace::count(AttributeRange::parse(0, "a", "int[3,1]")), qint64(0));
+    QCOMPARE(SweepSpace::count(nullptr), qint64(0));
+}
+
+void TestSweep::tst_space()
+{
+    SweepSpace space({ AttributeRange::parse(0, "a", "double[0,1.5]"),
+                       AttributeRange::parse(1, "b", "string{x,y}"),
+                       AttributeRange::parse(2, "c", "int{3,1,2}") });
+    QCOMPARE(space.size(), qint64(18));
+
+    // the last range varies fastest; the sets keep their order
+    std::vector<Values> points;
+    do {
+        points.emplace_back(space.point());
+    } while (space.next());
+    QCOMPARE(points.size(), size_t(18));
+    QCOMPARE(points.at(0), Values({ Value(0.0), Value("x"), Value(3) }));
+    QCOMPARE(points.at(1), Values({ Value(0.0), Value("x"), Value(1) }));
+    QCOMPARE(points.at(2), Values({ Value(0.0), Value("x"), Value(2) }));
+    QCOMPARE(points.at(3), Values({ Value(0.0), Value("y"), Value(3) }));
+    QCOMPARE(points.at(6), Values({ Value(1.0), Value("x"), Value(3) }));
+    QCOMPARE(points.at(17), Values({ Value(1.5), Value("y"), Value(2) }));
+
+    // it starts over after the last point
+    QCOMPARE(space.point(), points.at(0));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestSweep)
+#include "tst_sweep.moc"
@@ -0,0 +1,336 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QtTest>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <core/trialscheduler.h>
+
+namespace evoplex {
+
+// runs a function in its own thread
+class FuncThread : public QThread
+{
+public:
+    explicit FuncThread(std::function<void()> func) : m_func(func) {}
+protected:
+    void run() override { m_func(); }
+private:
+    std::function<void()> m_func;
+};
+
+class TestTrialScheduler: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    // a worker runs its trials in the order they were queued
+    void tst_order();
+    // the queued trials can be found and removed
+    void tst_remove();
+    // an idle worker steals the trials of a busy one
+    void tst_steal();
+    // the trials which are not admitted are skipped, but forced in when nothing runs
+    void tst_admit();
+    // a trial which gives way runs again after the other queued ones
+    void tst_requeue();
+    // many workers take (and remove) the trials queued by many threads
+    void tst_stress();
+
+private:
+    static const int kTimeout = 10000; // msec
+    static const int kMaxTrials = 40000;
+
+    // the scheduler never dereferences the trials; their ids are the offsets
+    std::vector<char> m_buffer;
+    Trial* _trial(int id) { return reinterpret_cast<Trial*>(&m_buffer[static_cast<size_t>(id)]); }
+    int _id(Trial* trial) const { return static_cast<int>(reinterpret_cast<char*>(trial) - m_buffer.data()); }
+    std::vector<Trial*> _trials(int first, int count);
+};
+
+void TestTrialScheduler::initTestCase()
+{
+    m_buffer.resize(kMaxTrials);
+}
+
+std::vector<Trial*> TestTrialScheduler::_trials(int first, int count)
+{
+    std::vector<Trial*> trials;
+    for (int id = first; id < first + count; ++id) {
+        trials.emplace_back(_trial(id));
+    }
+    return trials;
+}
+
+void TestTrialScheduler::tst_order()
+{
+    QThreadPool pool;
+    QMutex mutex;
+    std::vector<int> ran;
+    TrialScheduler scheduler(&pool, 1, [this, &mutex, &ran](Trial* trial) {
+        QMutexLocker locker(&mutex);
+        ran.emplace_back(_id(trial));
+    });
+    QCOMPARE(scheduler.numWorkers(), 1);
+
+    scheduler.enqueue(_trials(0, 5));
+    scheduler.enqueue(_trials(5, 5));
+    pool.waitForDone();
+    QCOMPARE(ran, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    QCOMPARE(scheduler.numQueued(), 0);
+}
+
+void TestTrialScheduler::tst_remove()
+{
+    QThreadPool pool;
+    QSemaphore blocked, release;
+    QMutex mutex;
+    std::vector<int> ran;
+    TrialScheduler scheduler(&pool, 1, [&](Trial* trial) {
+        if (_id(trial) == 0) {
+            blocked.release();
+            release.acquire();
+        }
+        QMutexLocker locker(&mutex);
+        ran.emplace_back(_id(trial));
+    });
+
+    // the only worker is stuck with the first trial
+    scheduler.enqueue(_trials(0, 6));
+    QVERIFY(blocked.tryAcquire(1, kTimeout));
+    QCOMPARE(scheduler.numQueued(), 5);
+    QVERIFY(scheduler.anyQueued([this](Trial* t) { return _id(t) == 3; }));
+    QVERIFY(!scheduler.anyQueued([this](Trial* t) { return _id(t) == 0; }));
+
+    QCOMPARE(scheduler.remove([this](Trial* t) { return _id(t) % 2 == 0; }), 2);
+    QCOMPARE(scheduler.numQueued(), 3);
+    QVERIFY(!scheduler.anyQueued([this](Trial* t) { return _id(t) == 4; }));
+    QCOMPARE(scheduler.remove([this](Trial* t) { return _id(t) == 4; }), 0);
+
+    release.release();
+    pool.waitForDone();
+    QCOMPARE(ran, std::vector<int>({ 0, 1, 3, 5 }));
+    QCOMPARE(scheduler.numQueued(), 0);
+}
+
+void TestTrialScheduler::tst_steal()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QSemaphore blocked, release;
+    QMutex mutex;
+    std::vector<int> ran;
+    TrialScheduler scheduler(&pool, 2, [&](Trial* trial) {
+        if (_id(trial) == 0) {
+            blocked.release();
+            release.acquire();
+            return;
+        }
+        QMutexLocker locker(&mutex);
+        ran.emplace_back(_id(trial));
+    });
+
+    // the trials 0 and 2 go to the first worker, 1 and 3 to the second one
+    scheduler.enqueue(_trials(0, 4));
+    QVERIFY(blocked.tryAcquire(1, kTimeout));
+
+    // the second worker runs its own trials, then the first one's
+    QTRY_COMPARE_WITH_TIMEOUT(scheduler.numQueued(), 0, kTimeout);
+    release.release();
+    pool.waitForDone();
+    QCOMPARE(ran, std::vector<int>({ 1, 3, 2 }));
+}
+
+void TestTrialScheduler::tst_admit()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QMutex mutex;
+    std::vector<std::pair<int, bool>> ran; // <id, forced>
+    std::atomic<bool> admitAll(false);
+    auto run = [&](Trial* trial) {
+        QMutexLocker locker(&mutex);
+        ran.emplace_back(_id(trial), false);
+    };
+    // the even trials are only admitted when forced (or after retry)
+    auto admit = [&](Trial* trial, bool force) {
+        if (admitAll || _id(trial) % 2 == 1) {
+            return true;
+        }
+        if (force) {
+            QMutexLocker locker(&mutex);
+            ran.emplace_back(_id(trial), true);
+        }
+        return force;
+    };
+    TrialScheduler scheduler(&pool, 1, run, admit);
+
+    // the odd ones go first; then, with nothing running, the even ones are forced
+    scheduler.enqueue(_trials(0, 4));
+    pool.waitForDone();
+    QCOMPARE(ran, (std::vector<std::pair<int, bool>>({
+        {1, false}, {3, false}, {0, true}, {0, false}, {2, true}, {2, false} })));
+    ran.clear();
+
+    // a trial which is not admitted waits in its place for retry()
+    QSemaphore blocked, release;
+    TrialScheduler blocking(&pool, 2, [&](Trial* trial) {
+        if (_id(trial) == 1) {
+            blocked.release();
+            release.acquire();
+        }
+        run(trial);
+    }, admit);
+    blocking.enqueue(_trials(1, 1));
+    QVERIFY(blocked.tryAcquire(1, kTimeout));
+    blocking.enqueue(_trials(2, 1));
+    QTest::qWait(100);
+    QCOMPARE(blocking.numQueued(), 1); // something is running; it's not forced
+
+    admitAll = true;
+    blocking.retry();
+    QTRY_COMPARE_WITH_TIMEOUT(blocking.numQueued(), 0, kTimeout);
+    release.release();
+    pool.waitForDone();
+    admitAll = false;
+    QCOMPARE(ran, (std::vector<std::pair<int, bool>>({ {2, false}, {1, false} })));
+
+    // with nothing admitted, the idle workers force a single trial in at a time
+    pool.setMaxThreadCount(4);
+    std::atomic<int> numRunning(0), maxRunning(0);
+    TrialScheduler forcing(&pool, 4, [&](Trial*) {
+        const int n = ++numRunning;
+        int max = maxRunning;
+        while (n > max && !maxRunning.compare_exchange_weak(max, n)) {}
+        QThread::usleep(100);
+        --numRunning;
+    }, [](Trial*, bool force) { return force; });
+    forcing.enqueue(_trials(0, 200));
+    pool.waitForDone();
+    QCOMPARE(forcing.numQueued(), 0);
+    QCOMPARE(maxRunning.load(), 1);
+}
+
+void TestTrialScheduler::tst_requeue()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QSemaphore blocked, release;
+    QMutex mutex;
+    std::vector<int> ran;
+    int slices = 0;
+    TrialScheduler scheduler(&pool, 2, [&](Trial* trial) {
+        if (_id(trial) == 1) {
+            blocked.release();
+            release.acquire();
+            return;
+        }
+        QMutexLocker locker(&mutex);
+        ran.emplace_back(_id(trial));
+        if (_id(trial) != 0) {
+            return;
+        }
+        // the long trial gives way twice; the short one is queued meanwhile
+        // on the first worker, which is busy
+        ++slices;
+        if (slices == 1) {
+            scheduler.enqueue({ _trial(2) });
+        }
+        if (slices <= 2) {
+            scheduler.requeue(trial);
+        }
+    });
+
+    // the first worker is stuck with the trial 1; the second one runs the trial 0
+    scheduler.enqueue({ _trial(1) });
+    QVERIFY(blocked.tryAcquire(1, kTimeout));
+    scheduler.enqueue({ _trial(0) });
+
+    // the short trial starts before the long one's next slice
+    auto numRan = [&]() { QMutexLocker locker(&mutex); return ran.size(); };
+    QTRY_COMPARE_WITH_TIMEOUT(numRan(), size_t(4), kTimeout);
+    release.release();
+    pool.waitForDone();
+    QCOMPARE(ran, std::vector<int>({ 0, 2, 0, 0 }));
+}
+
+void TestTrialScheduler::tst_stress()
+{
+    const int numThreads = 8;
+    const int trialsPerThread = kMaxTrials / numThreads;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    std::vector<std::atomic<int>> ran(kMaxTrials);
+    std::vector<std::atomic<int>> removed(kMaxTrials);
+    for (int id = 0; id < kMaxTrials; ++id) {
+        ran[id] = 0;
+        removed[id] = 0;
+    }
+    TrialScheduler scheduler(&pool, 4, [this, &ran](Trial* trial) { ++ran[_id(trial)]; });
+
+    std::vector<std::unique_ptr<FuncThread>> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back(new FuncThread([this, &scheduler, t, trialsPerThread]() {
+            // in small batches, as the experiments do
+            for (int i = 0; i < trialsPerThread; i += 10) {
+                scheduler.enqueue(_trials(t * trialsPerThread + i, 10));
+            }
+        }));
+    }
+    // the trials with a multiple of 7 as id are removed while they are queued
+    threads.emplace_back(new FuncThread([this, &scheduler, &removed]() {
+        for (int i = 0; i < 100; ++i) {
+            scheduler.remove([this, &removed](Trial* t) {
+                const int id = _id(t);
+                if (id % 7 == 0) {
+                    ++removed[id];
+                    return true;
+                }
+                return false;
+            });
+        }
+    }));
+    for (auto& t : threads) {
+        t->start();
+    }
+    for (auto& t : threads) {
+        t->wait();
+    }
+    pool.waitForDone();
+
+    // each trial is either run or removed, and only once
+    QCOMPARE(scheduler.numQueued(), 0);
+    for (int id = 0; id < kMaxTrials; ++id) {
+        QCOMPARE(ran[id] + removed[id], 1);
+        QVERIFY(id % 7 == 0 || removed[id] == 0);
+    }
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestTrialScheduler)
+#include "tst_trialscheduler.moc"
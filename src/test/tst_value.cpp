@@ -38,6 +38,7 @@ private slots:
     void tst_valueInt();
     void tst_valueChar();
     void tst_valueString();
+    void tst_dataStream();
 };
 
 void TestValue::tst_valueInvalid()
@@ -339,5 +340,36 @@ void TestValue::tst_valueString()
     QCOMPARE(vCopy2, Value(""));
 }
 
+void TestValue::tst_dataStream()
+{
+    const Values values = { Value(), Value(true), Value('a'), Value(1.5),
+                            Value(-7), Value("abc"), Value("") };
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    for (const Value& v : values) {
+        out << v;
+    }
+
+    QDataStream in(data);
+    for (const Value& v : values) {
+        Value read(123);
+        in >> read;
+        QCOMPARE(read.type(), v.type());
+        if (v.isValid()) {
+            QCOMPARE(read, v);
+        }
+    }
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QVERIFY(in.atEnd());
+
+    // an unknown type
+    QByteArray corrupt(1, char(42));
+    QDataStream in2(corrupt);
+    Value read(123);
+    in2 >> read;
+    QVERIFY(!read.isValid());
+    QCOMPARE(in2.status(), QDataStream::ReadCorruptData);
+}
+
 QTEST_MAIN(TestValue)
 #include "tst_value.moc"
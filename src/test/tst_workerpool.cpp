@@ -0,0 +1,191 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtTest>
+#include <core/workerpool.h>
+
+#include "batchutils.h"
+
+namespace evoplex {
+class TestWorkerPool: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    // a worker runs as many experiments at a time as its threads
+    void tst_inFlight();
+    // a worker which dies before saying hello is restarted
+    void tst_respawn();
+    // but not forever; the jobs fail once no worker is left
+    void tst_failedStarts();
+
+private:
+    static const int kTimeout = 30000; // msec
+
+    MainApp* m_mainApp;
+
+    // 'numJobs' rows of 'numTrials' trials; the row 'broken' is invalid
+    std::vector<WorkerPool::Job> _jobs(int numJobs, int numTrials, int broken=-1) const;
+    // runs the jobs in a new pool and waits for it to finish; 'numDone' gets
+    // the number of jobs which were done when each job was taken
+    bool _run(int numWorkers, int threads, const std::vector<WorkerPool::Job>& jobs,
+              std::vector<std::pair<int, bool>>& done, std::vector<int>* numDone=nullptr) const;
+};
+
+void TestWorkerPool::initTestCase()
+{
+    m_mainApp = new MainApp();
+    TestUtils::loadPlugins(m_mainApp);
+}
+
+void TestWorkerPool::cleanupTestCase()
+{
+    delete m_mainApp;
+}
+
+void TestWorkerPool::cleanup()
+{
+    qunsetenv("TST_WORKERPOOL_CRASH");
+}
+
+std::vector<WorkerPool::Job> TestWorkerPool::_jobs(int numJobs, int numTrials, int broken) const
+{
+    std::vector<WorkerPool::Job> jobs;
+    for (int id = 0; id < numJobs; ++id) {
+        auto attrs = TestUtils::generalAttrs(id, "populationGrowth", "zeroEdges");
+        attrs.insert(GENERAL_ATTR_STOPAT, "100");
+        attrs.insert(GENERAL_ATTR_TRIALS, QString::number(numTrials));
+        attrs.insert("populationGrowth_prob", "0.1");
+        attrs = TestUtils::withVersions(m_mainApp, attrs);
+        if (id == broken) {
+            attrs.insert(GENERAL_ATTR_MODELID, "unknownModel");
+        }
+        WorkerPool::Job job;
+        job.expId = id;
+        job.header = attrs.keys();
+        job.values = attrs.values();
+        jobs.emplace_back(job);
+    }
+    return jobs;
+}
+
+bool TestWorkerPool::_run(int numWorkers, int threads, const std::vector<WorkerPool::Job>& jobs,
+                          std::vector<std::pair<int, bool>>& done, std::vector<int>* numDone) const
+{
+    size_t next = 0;
+    WorkerPool pool(numWorkers, { "-threads", QString::number(threads) },
+                    [&](WorkerPool::Job& job) {
+        if (next == jobs.size()) {
+            return false;
+        }
+        if (numDone) {
+            numDone->emplace_back(static_cast<int>(done.size()));
+        }
+        job = jobs.at(next++);
+        return true;
+    });
+    connect(&pool, &WorkerPool::jobDone, [&done](int expId, bool ok) {
+        done.emplace_back(expId, ok);
+    });
+    QSignalSpy finishedSpy(&pool, &WorkerPool::finished);
+
+    QString error;
+    if (!pool.start(error)) {
+        qWarning() << error;
+        return false;
+    }
+    return finishedSpy.wait(kTimeout);
+}
+
+void TestWorkerPool::tst_inFlight()
+{
+    std::vector<std::pair<int, bool>> done;
+    std::vector<int> numDone;
+    QVERIFY(_run(1, 2, _jobs(5, 2, 1), done, &numDone));
+
+    // the worker takes two jobs at once, then one for each job done
+    QCOMPARE(numDone, std::vector<int>({ 0, 0, 1, 2, 3 }));
+
+    // the broken row fails alone, with its own id
+    QCOMPARE(done.size(), size_t(5));
+    std::sort(done.begin(), done.end());
+    for (int id = 0; id < 5; ++id) {
+        QCOMPARE(done.at(id), std::make_pair(id, id != 1));
+    }
+}
+
+void TestWorkerPool::tst_respawn()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString crashed = dir.filePath("crashed");
+    qputenv("TST_WORKERPOOL_CRASH", crashed.toUtf8());
+
+    std::vector<std::pair<int, bool>> done;
+    QVERIFY(_run(1, 1, _jobs(2, 1), done));
+
+    // the first worker died; the one which took its place ran the jobs
+    QVERIFY(QFileInfo::exists(crashed));
+    QCOMPARE(done, (std::vector<std::pair<int, bool>>({ {0, true}, {1, true} })));
+}
+
+void TestWorkerPool::tst_failedStarts()
+{
+    qputenv("TST_WORKERPOOL_CRASH", "always");
+
+    std::vector<std::pair<int, bool>> done;
+    QVERIFY(_run(2, 1, _jobs(3, 1), done));
+
+    // no job was sent; all of them fail at the end
+    QCOMPARE(done, (std::vector<std::pair<int, bool>>({ {0, false}, {1, false}, {2, false} })));
+}
+
+} // evoplex
+
+// The pool runs this test as its workers, i.e., with '-no-gui -worker <server>'.
+// With TST_WORKERPOOL_CRASH, the worker dies before saying hello: always
+// if it's 'always', or only once if it's a file name (the file is created).
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "-no-gui")) {
+            continue;
+        }
+        const QString crash = QString::fromUtf8(qgetenv("TST_WORKERPOOL_CRASH"));
+        if (crash == "always") {
+            return 1;
+        } else if (!crash.isEmpty() && !QFileInfo::exists(crash)) {
+            QFile(crash).open(QFile::WriteOnly);
+            return 1;
+        }
+        return evoplex::TestUtils::runBatch(argc, argv);
+    }
+
+    QCoreApplication app(argc, argv);
+    evoplex::TestWorkerPool tc;
+    QTEST_SET_MAIN_SOURCE_PATH
+    return QTest::qExec(&tc, argc, argv);
+}
+#include "tst_workerpool.moc"